@@ -19,19 +19,34 @@
 
 #include "Component.h"
 #include "Globals.h"
+#include "Scheduling.h"
+#include "StagePipeline.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <exception>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
+#include <unistd.h>
 
 #include <boost/interprocess/exceptions.hpp>
 
+#include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ZMQHelpers.h"
 
 namespace oat {
 
+// Time allowed to deliver a goodbye to oat-control on exit
+static constexpr int BYE_LINGER_MS {100};
+
+// Longest the control thread sleeps before checking whether to stop
+static constexpr long CONTROL_IDLE_POLL_MS {250};
+
 // Global via extern in Globals.h
 volatile sig_atomic_t quit = 0;
 
@@ -47,23 +62,121 @@ Component::Component()
     std::signal(SIGINT, sigHandler);
 }
 
+void Component::identity(char *id, const size_t n) const
+{
+    std::stringstream ping_msg;
+    ping_msg << std::hex << std::uppercase;
+    ping_msg << "OAT"; // Must not start with binary 0, ZMQ rule
+    ping_msg << "/";
+    ping_msg << getpid();
+    ping_msg << "/";
+    ping_msg << std::this_thread::get_id();
+    std::strncpy(id, ping_msg.str().data(), n);
+}
+
 void Component::run()
 {
+    // The control thread sleeps until a command arrives, so it is told to
+    // stop over an inproc pipe rather than by polling quit. Both ends are
+    // connected before it starts so that the stop message is queued however
+    // early the processing loop ends.
+    zmq::context_t ctx(1);
+    std::stringstream stop_endpoint;
+    stop_endpoint << "inproc://oat-control-stop-" << this;
+    zmq::socket_t stop(ctx, ZMQ_PAIR);
+    stop.setsockopt(ZMQ_LINGER, 0);
+    stop.bind(stop_endpoint.str().c_str());
+    zmq::socket_t stopped(ctx, ZMQ_PAIR);
+    stopped.setsockopt(ZMQ_LINGER, 0);
+    stopped.connect(stop_endpoint.str().c_str());
+
+    // TODO: Get endpoint from program options
+    processing_ended_ = false;
+    auto control_thread = oat::startHelper(
+        [this, &ctx, &stopped] { runController(ctx, stopped); });
+
     // Loop until quit
-    runComponent();
+    std::exception_ptr ex;
+    try {
+        runComponent();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+
+    // The flag covers a stop message that could not be queued, which the
+    // control thread then sees at its next poll timeout
+    processing_ended_ = true;
+    zmq::message_t stop_msg(0);
+    stop.send(stop_msg, ZMQ_DONTWAIT);
+    control_thread.join();
+    stopped.close();
+    stop.close();
+
+    if (ex)
+        std::rethrow_exception(ex);
+
+    // If an exception occured in control thread, rethrow it on the main
+    // thread
+    if (ctrl_ex_)
+        std::rethrow_exception(ctrl_ex_);
 }
 
 void Component::runComponent()
 {
     try {
 
+        // Before connecting so that node memory is locked and threads
+        // started from here inherit the processing thread's settings
+        applyProcessingScheduling(runDefaults(), name());
+
         // TODO: throw "could not connect to node?"
         if (!connectToNode())
             return;
 
+        stats_.start_ns.store(steadyNanoseconds(), std::memory_order_relaxed);
+
+        // Each stage records the statistics of the work it does
+        const size_t depth = runDefaults().pipeline_depth;
+        if (depth > 0 && preparePipeline(depth)) {
+            StagePipeline pipeline(depth);
+            pipeline.run(
+                [this](size_t slot) {
+                    const NodeActivity before = nodeActivity();
+                    const int rc = readStage(slot);
+                    recordNodeActivity(before);
+                    return rc;
+                },
+                [this](size_t slot) {
+                    const uint64_t start_ns = steadyNanoseconds();
+                    computeStage(slot);
+                    recordProcess(steadyNanoseconds() - start_ns);
+                },
+                [this](size_t slot) {
+                    const NodeActivity before = nodeActivity();
+                    writeStage(slot);
+                    recordNodeActivity(before);
+                    bump(stats_.samples);
+                });
+            return;
+        }
+
+        if (depth > 0)
+            std::cerr << oat::Warn(name() + " cannot be pipelined. Its "
+                                   "stages will run on one thread.\n");
+
         bool end_of_stream = false;
         while (!end_of_stream && !quit) {
+
+            const NodeActivity before = nodeActivity();
+            const uint64_t start_ns = steadyNanoseconds();
             end_of_stream = process();
+            const uint64_t elapsed = steadyNanoseconds() - start_ns;
+            const uint64_t waited = recordNodeActivity(before);
+
+            if (!end_of_stream) {
+                recordProcess(elapsed > waited ? elapsed - waited : 0);
+                bump(stats_.samples);
+            }
         }
 
     } catch (const boost::interprocess::interprocess_exception &ex) {
@@ -75,4 +188,308 @@ void Component::runComponent()
     }
 }
 
+void Component::runController(zmq::context_t &ctx,
+                              zmq::socket_t &stop,
+                              const char *endpoint)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto heartbeat_interval
+        = std::chrono::milliseconds(HEARTBEAT_INTERVAL_MS);
+
+    try {
+
+        zmq::socket_t ctrl_socket(ctx, ZMQ_DEALER);
+        char id[32];
+        identity(id, 32);
+        ctrl_socket.setsockopt(ZMQ_IDENTITY, id, std::strlen(id));
+        ctrl_socket.setsockopt(ZMQ_LINGER, BYE_LINGER_MS);
+
+        // Connection events tell us when oat-control (re)binds its endpoint,
+        // which is when it needs to hear from us
+        std::stringstream monitor_endpoint;
+        monitor_endpoint << "inproc://oat-control-monitor-" << this;
+        if (zmq_socket_monitor(static_cast<void *>(ctrl_socket),
+                               monitor_endpoint.str().c_str(),
+                               ZMQ_EVENT_CONNECTED | ZMQ_EVENT_DISCONNECTED))
+            throw zmq::error_t();
+        zmq::socket_t monitor(ctx, ZMQ_PAIR);
+        monitor.setsockopt(ZMQ_LINGER, 0);
+        monitor.connect(monitor_endpoint.str().c_str());
+
+        ctrl_socket.connect(endpoint);
+
+        bool connected = false;
+        auto next_heartbeat = Clock::now();
+        const bool counts_samples = !commands().empty();
+        auto say = [&ctrl_socket](const std::string &what,
+                                  const std::string &data) {
+            oat::sendStringMore(&ctrl_socket, ""); // Delimeter
+            if (data.empty()) {
+                oat::sendString(&ctrl_socket, what);
+            } else {
+                oat::sendStringMore(&ctrl_socket, what);
+                oat::sendString(&ctrl_socket, data);
+            }
+        };
+
+        // Execute control loop
+        bool stopped = false;
+        while (!quit && !stopped && !processing_ended_) {
+
+            // Only wake for heartbeats while someone is listening to them.
+            // Otherwise wake now and then to check quit, which a signal sets
+            // without otherwise waking us.
+            long timeout = CONTROL_IDLE_POLL_MS;
+            if (connected) {
+                timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              next_heartbeat - Clock::now()).count();
+                timeout = std::max(0L, std::min(timeout, CONTROL_IDLE_POLL_MS));
+            }
+
+            zmq::pollitem_t p[] = {{ctrl_socket, 0, ZMQ_POLLIN, 0},
+                                   {monitor, 0, ZMQ_POLLIN, 0},
+                                   {stop, 0, ZMQ_POLLIN, 0}};
+            try {
+                zmq::poll(&p[0], 3, timeout);
+            } catch (const zmq::error_t &ex) {
+                if (ex.num() == EINTR)
+                    continue;
+                throw;
+            }
+
+            if (p[2].revents & ZMQ_POLLIN)
+                stopped = true;
+
+            if (p[1].revents & ZMQ_POLLIN) {
+
+                // First frame starts with the 16 bit event ID
+                auto event = oat::recvMultipart(&monitor);
+                uint16_t event_id = 0;
+                std::memcpy(&event_id, event[0].data(),
+                            std::min(event[0].size(), sizeof(event_id)));
+
+                if (event_id == ZMQ_EVENT_CONNECTED) {
+                    say(CTRL_HELLO, whoAmI());
+                    connected = true;
+                    next_heartbeat = Clock::now() + heartbeat_interval;
+                } else if (event_id == ZMQ_EVENT_DISCONNECTED) {
+                    connected = false;
+                }
+            }
+
+            if (p[0].revents & ZMQ_POLLIN && !quit) {
+
+                // Found a command, with an optional target sample. Requests
+                // for stats and for the current sample count are answered
+                // here so that they never wait on processing.
+                auto msg = oat::recvMultipart(&ctrl_socket);
+                if (msg.size() == 2 && msg[1] == CTRL_STATS)
+                    say(CTRL_STATS, statsJSON());
+                else if (msg.size() == 2 && msg[1] == CTRL_SAMPLE)
+                    say(CTRL_SAMPLE, std::to_string(sample_count_.load(
+                                         std::memory_order_relaxed)));
+                else if (msg.size() == 2 || msg.size() == 3)
+                    quit = control(msg[1], msg.size() == 3 ? msg[2] : "");
+            }
+
+            if (connected && Clock::now() >= next_heartbeat) {
+                say(CTRL_HEARTBEAT,
+                    counts_samples ? std::to_string(sample_count_.load(
+                                         std::memory_order_relaxed))
+                                   : "");
+                next_heartbeat = Clock::now() + heartbeat_interval;
+            }
+        }
+
+        // Lets oat-control drop us now rather than after missed heartbeats
+        if (connected)
+            say(CTRL_BYE, "");
+
+    } catch (zmq::error_t &ex) {
+
+        // ETERM occurs during interrupt from ctrl-c, otherwise pass exception
+        // to processing thread
+        if (ex.num() != ETERM)
+            ctrl_ex_ = std::current_exception();
+    }
+}
+
+int Component::control(const std::string &command,
+                        const std::string &sample)
+{
+    if (command == "quit" || command == "Quit")
+        return 1;
+
+    // Check that command is in hash
+    if (!commands().count(command))
+        return 0;
+
+    PendingCommand pending {command, sample.empty(), 0};
+    if (!sample.empty()) {
+        try {
+            pending.sample = std::stoull(sample);
+        } catch (const std::logic_error &) {
+            std::cerr << oat::Warn(name() + ": ignored '" + command
+                                   + "' for invalid sample '" + sample
+                                   + "'.\n");
+            return 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_.push_back(pending);
+    commands_pending_.store(true, std::memory_order_release);
+
+    return 0;
+}
+
+void Component::applyCommands(const uint64_t sample_count)
+{
+    sample_count_.store(sample_count, std::memory_order_relaxed);
+
+    if (!commands_pending_.load(std::memory_order_acquire))
+        return;
+
+    auto is_due = [sample_count](const PendingCommand &c) {
+        return c.next || c.sample <= sample_count;
+    };
+
+    std::vector<PendingCommand> due;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        auto later
+            = std::stable_partition(pending_.begin(), pending_.end(), is_due);
+        due.assign(pending_.begin(), later);
+        pending_.erase(pending_.begin(), later);
+        commands_pending_.store(!pending_.empty(), std::memory_order_release);
+    }
+
+    for (const auto &c : due) {
+
+        if (!c.next && c.sample < sample_count)
+            std::cerr << oat::Warn(name() + ": '" + c.command + "' for sample "
+                                   + std::to_string(c.sample)
+                                   + " arrived late and was applied at sample "
+                                   + std::to_string(sample_count) + ".\n");
+
+        applyCommand(c.command);
+    }
+}
+
+std::string Component::whoAmI()
+{
+    // JSON string with name, type, and command/description map
+    std::stringstream whoami;
+    whoami << "{";
+    whoami << "\"name\":\"" << name() << "\",";
+    whoami << "\"type\":" << std::to_string(static_cast<uint16_t>(type())) << ",";
+
+    // Only components with commands of their own call applyCommands(), so
+    // only they know their sample count
+    auto cmds = commands();
+    if (!cmds.empty()) {
+
+        whoami << "\"sample\":" << sample_count_.load() << ",";
+        whoami << "\"commands\":{";
+        for (const auto &c : cmds)
+            whoami << "\"" << c.first << "\":\"" << c.second << "\",";
+        whoami.seekp(-1, whoami.cur); // Delete trailing comma
+        whoami << "}";
+    } else {
+        whoami.seekp(-1, whoami.cur); // Delete trailing comma
+    }
+
+    whoami << "}";
+
+    return whoami.str();
+}
+
+uint64_t Component::recordNodeActivity(const NodeActivity &before)
+{
+    // Only counters that changed are written, so that pipeline stages, which
+    // each use one side of the nodes, never write the same ones
+    const NodeActivity &now = nodeActivity();
+    auto add = [](std::atomic<uint64_t> &counter, const uint64_t n) {
+        if (n > 0)
+            bump(counter, n);
+    };
+    add(stats_.source_wait_ns, now.source_wait_ns - before.source_wait_ns);
+    add(stats_.sink_wait_ns, now.sink_wait_ns - before.sink_wait_ns);
+    add(stats_.overruns, now.overruns - before.overruns);
+    add(stats_.dropped, now.dropped - before.dropped);
+
+    return (now.source_wait_ns - before.source_wait_ns)
+           + (now.sink_wait_ns - before.sink_wait_ns);
+}
+
+void Component::recordProcess(const uint64_t ns)
+{
+    stats_.process.record(ns);
+    raiseMax(stats_.process_max_ns, ns);
+}
+
+// Resident set size of the process, which components hosted by oat-run share
+static uint64_t residentBytes(void)
+{
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident))
+        return 0;
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::string Component::statsJSON()
+{
+    const uint64_t now = steadyNanoseconds();
+    const uint64_t start = stats_.start_ns.load(std::memory_order_relaxed);
+    const uint64_t samples = stats_.samples.load(std::memory_order_relaxed);
+
+    // Latencies of the samples processed since the last snapshot
+    const auto process = stats_.process.counts();
+    LatencyHistogram::Counts recent;
+    for (size_t i = 0; i < recent.size(); i++)
+        recent[i] = process[i] - last_stats_process_[i];
+
+    auto rate = [](const uint64_t n, const uint64_t ns) {
+        return ns == 0 ? 0.0 : n * 1e9 / ns;
+    };
+    const uint64_t since = std::max(start, last_stats_ns_);
+    const double rate_hz
+        = start ? rate(samples - last_stats_samples_, now - since) : 0.0;
+    const double mean_rate_hz = start ? rate(samples, now - start) : 0.0;
+
+    last_stats_ns_ = now;
+    last_stats_samples_ = samples;
+    last_stats_process_ = process;
+
+    auto load = [](const std::atomic<uint64_t> &counter) {
+        return counter.load(std::memory_order_relaxed);
+    };
+
+    std::stringstream stats;
+    stats << std::fixed << std::setprecision(1);
+    stats << "{";
+    stats << "\"name\":\"" << name() << "\",";
+    stats << "\"type\":" << static_cast<uint16_t>(type()) << ",";
+    stats << "\"samples\":" << samples << ",";
+    stats << "\"rate_hz\":" << rate_hz << ",";
+    stats << "\"mean_rate_hz\":" << mean_rate_hz << ",";
+    stats << "\"process_ns\":{";
+    stats << "\"p50\":" << LatencyHistogram::quantile(recent, 0.5) << ",";
+    stats << "\"p90\":" << LatencyHistogram::quantile(recent, 0.9) << ",";
+    stats << "\"p99\":" << LatencyHistogram::quantile(recent, 0.99) << ",";
+    stats << "\"max\":"
+          << stats_.process_max_ns.exchange(0, std::memory_order_relaxed)
+          << "},";
+    stats << "\"source_wait_ns\":" << load(stats_.source_wait_ns) << ",";
+    stats << "\"sink_wait_ns\":" << load(stats_.sink_wait_ns) << ",";
+    stats << "\"overruns\":" << load(stats_.overruns) << ",";
+    stats << "\"dropped\":" << load(stats_.dropped) << ",";
+    stats << "\"rss_bytes\":" << residentBytes();
+    appendStats(stats);
+    stats << "}";
+
+    return stats.str();
+}
+
 } /* namespace oat */
@@ -20,19 +20,41 @@
 #ifndef OAT_COMPONENT_H
 #define OAT_COMPONENT_H
 
+#include <atomic>
 #include <csignal>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <ostream>
 #include <string>
 #include <cstring>
 #include <map>
+#include <vector>
 
 #include <boost/program_options.hpp>
 #include <zmq.hpp>
 
 #include "Globals.h"
+#include "../shmemdf/Telemetry.h"
+
+// Period of the heartbeats that a component sends while connected to a
+// controller, and number of them a controller can miss before it drops the
+// component
+#define HEARTBEAT_INTERVAL_MS 2000
+#define HEARTBEAT_LIVENESS 3
+
+// Control message types, sent by components after an empty delimiter frame
+#define CTRL_HELLO "hello"
+#define CTRL_HEARTBEAT "heartbeat"
+#define CTRL_BYE "bye"
+#define CTRL_STATS "stats"
+#define CTRL_SAMPLE "sample"
 
 namespace oat {
 
+typedef std::map<std::string, std::string> CommandDescription;
+
 enum ComponentType : uint16_t {
     mock = 0,
     buffer,
@@ -48,9 +70,49 @@ enum ComponentType : uint16_t {
     recorder,
     viewer,
     decorator,
+    bridge,
     COMP_N // Number of components
 };
 
+/**
+ * @brief Defaults for how components run their processing loop. Like
+ * NodeDefaults, these are set from common program options and are per-thread
+ * so that components hosted by oat-run can each have their own.
+ */
+struct RunDefaults {
+
+    static constexpr size_t MAX_PIPELINE_DEPTH {16};
+    static constexpr size_t MAX_THREADS {64};
+
+    // Samples in flight when running as a pipeline of read, compute and
+    // write stages. Zero calls process() serially.
+    size_t pipeline_depth {0};
+
+    // Threads that may work on each sample, for components that can split
+    // it up
+    size_t threads {1};
+
+    // CPUs the processing thread may run on. Empty leaves its affinity alone.
+    std::vector<int> cpus;
+
+    // SCHED_FIFO priority of the processing thread. Zero keeps the default
+    // scheduler.
+    int rt_priority {0};
+
+    // Lock the process's memory in RAM before processing starts
+    bool mlock {false};
+
+    // CPUs that helper threads, e.g. control, writer and display threads,
+    // may run on. Empty keeps them off the processing thread's CPUs.
+    std::vector<int> helper_cpus;
+};
+
+inline RunDefaults &runDefaults()
+{
+    static thread_local RunDefaults defaults;
+    return defaults;
+}
+
 class Component {
 
 public:
@@ -59,7 +121,7 @@ public:
     virtual ~Component() { };
 
     /**
-     * @brief Run the component's processing loop.
+     * @brief Run the component's processing and control loops.
      */
     virtual void run();
 
@@ -95,6 +157,171 @@ protected:
      * @return Return code. 0 = More. 1 = End of stream.
      */
     virtual int process(void) = 0;
+
+    /**
+     * @brief Prepare to run the processing loop as a pipeline of read,
+     * compute and write stages on separate threads instead of calling
+     * process(). Called after connectToNode(). Override, along with the
+     * stages, in components that support this.
+     * @param depth Number of samples that can be in flight. Each needs a slot
+     * that holds it from the read stage to the write stage.
+     * @return False if the component can only run process().
+     */
+    virtual bool preparePipeline(const size_t depth) { (void)depth; return false; }
+
+    /**
+     * @brief Read the next sample into a slot. Called on the component's
+     * thread.
+     * @param slot Slot index, less than the pipeline depth.
+     * @return Return code. 0 = More. 1 = End of stream.
+     */
+    virtual int readStage(const size_t slot) { (void)slot; return 1; }
+
+    /**
+     * @brief Process the sample in a slot. Called in sample order on a
+     * thread of its own.
+     * @param slot Slot index.
+     */
+    virtual void computeStage(const size_t slot) { (void)slot; }
+
+    /**
+     * @brief Publish the sample in a slot. Called in sample order on a thread
+     * of its own.
+     * @param slot Slot index.
+     */
+    virtual void writeStage(const size_t slot) { (void)slot; }
+
+    /**
+     * @brief Add component specific members to the stats snapshot sent to
+     * oat-control, e.g. the throughput of a helper thread. Called on the
+     * control thread.
+     * @param stats Stream to write ',"key":value' JSON members to.
+     */
+    virtual void appendStats(std::ostream &stats) { (void)stats; }
+
+    /**
+     * @brief Get unique, controllable ID for this component
+     * @param id Buffer for the ID
+     * @param n Number of characters to copy to id
+     * @note ASCII string ID consisting of 'OAT/' followed by the hexadecimal
+     * process ID, a '/' delimeter, and the handle of the component control
+     * thread.
+     */
+    void identity(char *id, const size_t n) const;
+
+    /**
+     * @brief Apply the commands that are due at the sample about to be
+     * processed, in the order they arrived. Call from the processing loop
+     * once the sample's count is known and before acting on it, always from
+     * the same thread. Commands sent for sample N are applied by the call for
+     * sample N, so components that read the same stream apply them at the
+     * same sample. Commands sent without a sample are applied by the next
+     * call. Costs an atomic load when no commands are waiting.
+     * @param sample_count Count of the sample about to be processed.
+     */
+    void applyCommands(const uint64_t sample_count);
+
+    /**
+     * @brief Handle a command from oat-control. quit is acted on at once.
+     * Others are queued for applyCommands(). Called on the control thread.
+     * @param command Command name.
+     * @param sample Count of the sample to apply the command at. Empty for
+     * the next sample.
+     * @return Return code. 0 = More. 1 = Quit received.
+     */
+    int control(const std::string &command, const std::string &sample);
+
+    /**
+     * @brief Mutate component according to the requested user input.
+     * @note Only commands supplied as keys via the overridden commands()
+     * function will be passed to this function. 
+     * @note Called by applyCommands(), on the processing thread.
+     * @param command Control message
+     */
+    virtual void applyCommand(const std::string &command) { (void)command; }
+
+    /** 
+     * @brief Return map comtaining a runtime commands and description of
+     * action on the component as implmented with the applyCommand function.
+     * Components without runtime commands still answer quit and stats.
+     * @return commands/description map.
+     */
+    virtual oat::CommandDescription commands() { return {}; }
+
+private:
+    /**
+     * @brief Run the component controller. Called on a separate thread. The
+     * controller keeps a single connection to oat-control for the life of the
+     * component. It says hello each time the connection is (re)established,
+     * sends heartbeats while it is up, and otherwise sleeps until a command
+     * arrives, stop is signalled or quit is set.
+     * @param ctx Context shared with run().
+     * @param stop Connected end of an inproc PAIR socket that run() signals
+     * when the processing loop has ended. Owned by run(), used only here.
+     * @param endpoint Endpoint over which communicaiton with an oat-control
+     * instance will occur.
+     */
+    void runController(zmq::context_t &ctx,
+                       zmq::socket_t &stop,
+                       const char *endpoint = "ipc:///tmp/oatcomms.pipe");
+
+    std::string whoAmI();
+
+    // Exception thrown on the control thread, rethrown by run()
+    std::exception_ptr ctrl_ex_;
+
+    // Set by run() once the processing loop has ended
+    std::atomic<bool> processing_ended_ {false};
+
+    // Command waiting for its sample
+    struct PendingCommand {
+        std::string command;
+        bool next; //!< Apply at the next sample rather than at sample
+        uint64_t sample;
+    };
+
+    // Queued by the control thread, applied by the processing thread
+    std::mutex pending_mutex_;
+    std::vector<PendingCommand> pending_;
+    std::atomic<bool> commands_pending_ {false};
+
+    // Count of the last sample passed to applyCommands(), reported in
+    // heartbeats by components that have commands()
+    std::atomic<uint64_t> sample_count_ {0};
+
+    /**
+     * @brief JSON snapshot of the processing loop's statistics, answered to
+     * oat-control's stats request on the control thread. Rates and process()
+     * latencies cover the time since the previous snapshot; counts and wait
+     * times are totals.
+     */
+    std::string statsJSON();
+
+    // Add the calling thread's node activity since before to the loop
+    // statistics. Returns the time it spent waiting on nodes.
+    uint64_t recordNodeActivity(const NodeActivity &before);
+
+    // Add the time a sample took to process to the loop statistics
+    void recordProcess(const uint64_t ns);
+
+    // Processing loop statistics. Each counter is written by the one thread
+    // that does the corresponding work, e.g. the read stage of a pipeline
+    // for SOURCE waits, and read by the control thread.
+    struct LoopStats {
+        std::atomic<uint64_t> start_ns {0}; //!< When the loop started
+        std::atomic<uint64_t> samples {0};
+        std::atomic<uint64_t> source_wait_ns {0};
+        std::atomic<uint64_t> sink_wait_ns {0};
+        std::atomic<uint64_t> overruns {0};
+        std::atomic<uint64_t> dropped {0};
+        LatencyHistogram process; //!< Per-sample time, less node waits
+        std::atomic<uint64_t> process_max_ns {0}; //!< Since last snapshot
+    } stats_;
+
+    // State of the previous snapshot. Only used by the control thread.
+    uint64_t last_stats_ns_ {0};
+    uint64_t last_stats_samples_ {0};
+    LatencyHistogram::Counts last_stats_process_ {};
 };
 }      /* namespace oat */
 #endif /* OAT_COMPONENT_H */
@@ -28,6 +28,10 @@
 #include <boost/program_options.hpp>
 #include <zmq.hpp>
 
+#include "Component.h"
+#include "Scheduling.h"
+#include "../shmemdf/Node.h"
+#include "../shmemdf/NodeDefaults.h"
 #include "../utility/TOMLSanitize.h"
 
 namespace oat {
@@ -49,8 +53,79 @@ public:
             ("config,c", po::value<std::vector<std::string>>()->multitoken(),
             "Configuration file/key pair.\n"
             "e.g. 'config.toml mykey'")
+            ("sink-depth", po::value<size_t>(),
+            "Number of samples that each of this component's SINKs can write "
+            "ahead of their slowest SOURCE before blocking. Larger values "
+            "prevent a briefly stalled downstream component from stalling "
+            "this one at the cost of memory. Defaults to 1.")
+            ("pin-memory",
+            "Back the shared memory used by this component's SINKs and "
+            "SOURCEs with huge pages, where the kernel allows it, and "
+            "prefault and lock it in RAM when nodes are bound or connected. "
+            "This makes the time to the first sample and the cost of "
+            "each copy predictable. Requires a sufficient RLIMIT_MEMLOCK.")
+            ("source-timeout", po::value<double>(),
+            "Seconds that a SOURCE may hold a sample that one of this "
+            "component's SINKs needs to write before the SINK evicts it, "
+            "e.g. because the SOURCE's component has hung. SOURCEs whose "
+            "process has died are always evicted. Defaults to 0, which "
+            "never evicts live SOURCEs.")
+            ("source-policy", po::value<std::string>(),
+            "Which samples this component's SOURCEs read. Values:\n"
+            "  block: every sample. The SINK waits for us if we fall behind. "
+            "The default.\n"
+            "  drop: the newest sample once we are done with the last, "
+            "skipping those published in the meantime. The SINK only waits "
+            "for us if a single read outlasts its sink-depth.\n"
+            "  every-N: every Nth sample. The SINK only waits for us on "
+            "those.\n"
+            "Components that combine several SOURCEs should use block so "
+            "that their samples stay aligned.")
+            ("pipeline-depth", po::value<size_t>(),
+            "Number of samples this component works on at once by reading, "
+            "processing and writing them on separate threads, so that "
+            "processing one sample overlaps copying the next and the last. "
+            "3 keeps every stage busy. Each sample in flight costs a copy of "
+            "it in memory. Components that cannot split "
+            "their work ignore this. Defaults to 0, which runs the stages "
+            "one after the other on one thread.")
+            ("threads", po::value<size_t>(),
+            "Number of threads that work on each sample, for components that "
+            "can split a sample into independent parts, e.g. frame filters "
+            "that work on bands of rows. Components that cannot ignore this. "
+            "Defaults to 1.")
+            ("cpu", po::value<std::string>(),
+            "CPUs that this component's processing thread may run on, e.g. "
+            "'2' or '0-3,6'. Threads it starts to split up its work run on "
+            "them too. Pinning keeps the scheduler from migrating the thread "
+            "and, combined with isolcpus, keeps other work off its CPUs.")
+            ("rt-priority", po::value<int>(),
+            "Run the processing thread under the SCHED_FIFO real-time "
+            "scheduler with this priority, from 1 to 99, so that it preempts "
+            "ordinary threads as soon as a sample arrives. Requires "
+            "CAP_SYS_NICE or a sufficient RLIMIT_RTPRIO. Defaults to 0, "
+            "which uses the default scheduler.")
+            ("mlock",
+            "Lock this component's memory in RAM before it starts processing "
+            "so that page faults cannot stall it. Implies --pin-memory. Memory "
+            "allocated later is only locked if RLIMIT_MEMLOCK is unlimited.")
+            ("helper-cpu", po::value<std::string>(),
+            "CPUs that this component's helper threads, e.g. its control, "
+            "writer and display threads, may run on. Helpers never run with "
+            "real-time priority. Defaults to every CPU not given to --cpu.")
             ;
 
+        config_keys_.push_back("sink-depth");
+        config_keys_.push_back("pin-memory");
+        config_keys_.push_back("source-timeout");
+        config_keys_.push_back("source-policy");
+        config_keys_.push_back("pipeline-depth");
+        config_keys_.push_back("threads");
+        config_keys_.push_back("cpu");
+        config_keys_.push_back("rt-priority");
+        config_keys_.push_back("mlock");
+        config_keys_.push_back("helper-cpu");
+
         if (CONTROLLABLE) {
             opts.add_options()
                 ("control-endpoint",  po::value<std::string>(),
@@ -83,6 +158,45 @@ public:
         auto config_table = oat::config::getConfigTable(vm);
         oat::config::checkKeys(config_keys_, config_table);
 
+        // Common node options must be applied before any SINK binds
+        size_t depth;
+        if (oat::config::getNumericValue<size_t>(
+                vm, config_table, "sink-depth", depth, 1, Node::MAX_DEPTH))
+            oat::nodeDefaults().depth = depth;
+        oat::config::getValue<bool>(
+            vm, config_table, "pin-memory", oat::nodeDefaults().pin_memory);
+        double timeout;
+        if (oat::config::getNumericValue<double>(
+                vm, config_table, "source-timeout", timeout, 0.0))
+            oat::nodeDefaults().source_timeout = std::chrono::milliseconds(
+                static_cast<int64_t>(timeout * 1000.0));
+        std::string policy;
+        if (oat::config::getValue<std::string>(
+                vm, config_table, "source-policy", policy))
+            oat::nodeDefaults().source_policy = oat::sourcePolicy(policy);
+
+        // Run options are read by Component::run() on this thread
+        oat::config::getNumericValue<size_t>(
+            vm, config_table, "pipeline-depth",
+            oat::runDefaults().pipeline_depth, 0,
+            RunDefaults::MAX_PIPELINE_DEPTH);
+        oat::config::getNumericValue<size_t>(
+            vm, config_table, "threads", oat::runDefaults().threads, 1,
+            RunDefaults::MAX_THREADS);
+        std::string cpus;
+        if (oat::config::getValue<std::string>(vm, config_table, "cpu", cpus))
+            oat::runDefaults().cpus = oat::parseCpuList(cpus);
+        oat::config::getNumericValue<int>(
+            vm, config_table, "rt-priority", oat::runDefaults().rt_priority,
+            0, 99);
+        if (oat::config::getValue<bool>(
+                vm, config_table, "mlock", oat::runDefaults().mlock)
+            && oat::runDefaults().mlock)
+            oat::nodeDefaults().pin_memory = true;
+        if (oat::config::getValue<std::string>(
+                vm, config_table, "helper-cpu", cpus))
+            oat::runDefaults().helper_cpus = oat::parseCpuList(cpus);
+
         // Concrete component uses configuration map to configure itself
         applyConfiguration(vm, config_table);
     }
@@ -20,78 +20,40 @@
 #ifndef OAT_CONTROLLABLECOMPONENT_H
 #define OAT_CONTROLLABLECOMPONENT_H
 
-#include <csignal>
-#include <cstdlib>
 #include <string>
-#include <cstring>
-#include <map>
-
-#include <boost/program_options.hpp>
-#include <zmq.hpp>
 
 #include "Component.h"
-#include "Globals.h"
-
-#define REQUEST_RETRIES 1e6
-#define REQUEST_TIMEOUT_MS 500
 
 namespace oat {
 
-typedef std::map<std::string, std::string> CommandDescription;
-
+/**
+ * @brief Component with runtime commands of its own. Every component is
+ * reachable from oat-control, which can ask it to quit or for its
+ * statistics. Controllable components must also say which commands they
+ * accept and apply them from their processing loop with applyCommands().
+ */
 class ControllableComponent : public Component {
 
 public:
     using Component::Component;
     virtual ~ControllableComponent() { };
 
-    /**
-     * @brief Run the component's processing and control loops.
-     */
-    void run() override;
-
 protected:
     /**
-     * @brief Get unique, controllable ID for this component
-     * @param n Number of characters to copy to id
-     * @param ASCII string ID consisting of the character 'C' followed by a
-     * serilized ComponentType component enumerator, then a '.' delimeter, and
-     * then seralized string representing the handle of the component control
-     * thread.
-     */
-    void identity(char *id, const size_t n) const;
-
-    /**
-     * @brief Mutate component according to the requested user input. Message
-     * header provides location of control struct. 
+     * @brief Mutate component according to the requested user input.
      * @note Only commands supplied as keys via the overridden commands()
      * function will be passed to this function. 
-     * @note This function must be thread-safe with processing thread.
-     * @param message_header Control message
-     * @return Return code. 0 = More. 1 = Quit received.
+     * @note Called by applyCommands(), on the processing thread.
+     * @param command Control message
      */
-    virtual void applyCommand(const std::string &command) = 0;
+    void applyCommand(const std::string &command) override = 0;
 
     /** 
      * @brief Return map comtaining a runtime commands and description of
      * action on the component as implmented with the applyCommand function.
      * @return commands/description map.
      */
-    virtual oat::CommandDescription commands() = 0;
-
-private:
-    /**
-     * @brief Start component controller on a separate thread.
-     * @param endpoint Endpoint over which communicaiton with an oat-control
-     * instance will occur.
-     */
-    void runController(const char *endpoint = "ipc:///tmp/oatcomms.pipe");
-
-    std::string whoAmI();
-
-    int control(const std::string &command);
-
-    zmq::socket_t *getCtrlSocket(zmq::context_t &context, const char *endpoint);
+    oat::CommandDescription commands() override = 0;
 };
 }      /* namespace oat */
 #endif /* OAT_CONTROLLABLECOMPONENT_H */
@@ -0,0 +1,210 @@
+//******************************************************************************
+//* File:   Scheduling.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include "Scheduling.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+// Stack that is faulted in ahead of time when memory is locked
+static constexpr size_t STACK_PREFAULT {256 * 1024};
+
+#ifdef __linux__
+
+// CPUs the process may run on, captured before any thread is pinned
+static const cpu_set_t process_cpus = [] {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+        for (int i = 0; i < CPU_SETSIZE; i++)
+            CPU_SET(i, &set);
+    return set;
+}();
+
+static int pinThread(const cpu_set_t &set)
+{
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static cpu_set_t cpuSet(const std::vector<int> &cpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto c : cpus)
+        CPU_SET(c, &set);
+    return set;
+}
+
+static __attribute__((noinline)) void prefaultStack()
+{
+    volatile char stack[STACK_PREFAULT];
+    for (size_t i = 0; i < STACK_PREFAULT; i += 4096)
+        stack[i] = 0;
+    (void)stack[0];
+}
+
+#endif
+
+std::vector<int> parseCpuList(const std::string &list)
+{
+    auto bad = [&list] {
+        return std::runtime_error("'" + list + "' is not a list of CPUs, "
+                                  "e.g. '2' or '0-3,6'.");
+    };
+
+#ifdef __linux__
+    const long num_cpus = std::min<long>(sysconf(_SC_NPROCESSORS_CONF),
+                                         CPU_SETSIZE);
+#else
+    const long num_cpus = std::thread::hardware_concurrency();
+#endif
+
+    std::vector<int> cpus;
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+
+        std::istringstream is(item);
+        int first, last;
+        if (!(is >> first) || first < 0)
+            throw bad();
+        last = first;
+        if (is.peek() == '-') {
+            is.get();
+            if (!(is >> last) || last < first)
+                throw bad();
+        }
+        if (!(is >> std::ws).eof())
+            throw bad();
+
+        if (last >= num_cpus)
+            throw std::runtime_error("CPU " + std::to_string(last)
+                                     + " does not exist.");
+
+        for (int c = first; c <= last; c++)
+            cpus.push_back(c);
+    }
+
+    if (cpus.empty())
+        throw bad();
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+void applyProcessingScheduling(const RunDefaults &defaults,
+                               const std::string &who)
+{
+#ifdef __linux__
+    if (defaults.mlock) {
+
+        // Locking future mappings makes any that exceed RLIMIT_MEMLOCK fail,
+        // so only do so if there is no limit
+        int flags = MCL_CURRENT;
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0
+            && limit.rlim_cur == RLIM_INFINITY)
+            flags |= MCL_FUTURE;
+
+        if (mlockall(flags) != 0)
+            std::cerr << oat::Warn(who + ": memory could not be locked in "
+                                   "RAM. Check RLIMIT_MEMLOCK (ulimit -l).\n");
+        else if (!(flags & MCL_FUTURE))
+            std::cerr << oat::Warn(who + ": only memory allocated so far is "
+                                   "locked in RAM. Set RLIMIT_MEMLOCK to "
+                                   "unlimited (ulimit -l) to lock the "
+                                   "rest.\n");
+
+        prefaultStack();
+    }
+
+    if (!defaults.cpus.empty()) {
+        const int rc = pinThread(cpuSet(defaults.cpus));
+        if (rc != 0)
+            std::cerr << oat::Warn(who + ": could not be pinned to the "
+                                   "requested CPUs: " + std::strerror(rc)
+                                   + ".\n");
+    }
+
+    if (defaults.rt_priority > 0) {
+        struct sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = defaults.rt_priority;
+        const int rc
+            = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0)
+            std::cerr << oat::Warn(who + ": could not run with real-time "
+                                   "priority: " + std::strerror(rc) + ". "
+                                   "Check RLIMIT_RTPRIO (ulimit -r) or "
+                                   "CAP_SYS_NICE.\n");
+    }
+#else
+    if (defaults.mlock || !defaults.cpus.empty() || defaults.rt_priority > 0)
+        std::cerr << oat::Warn(who + ": --mlock, --cpu and --rt-priority are "
+                               "not supported on this platform.\n");
+#endif
+}
+
+void applyHelperScheduling(const RunDefaults &defaults)
+{
+#ifdef __linux__
+    if (!defaults.helper_cpus.empty()) {
+        const int rc = pinThread(cpuSet(defaults.helper_cpus));
+        if (rc != 0)
+            std::cerr << oat::Warn("Helper thread could not be pinned to the "
+                                   "requested CPUs: " + std::string(
+                                   std::strerror(rc)) + ".\n");
+    } else {
+
+        // Keep off the processing thread's CPUs if any others remain
+        cpu_set_t set = process_cpus;
+        for (const auto c : defaults.cpus)
+            CPU_CLR(c, &set);
+        pinThread(CPU_COUNT(&set) > 0 ? set : process_cpus);
+    }
+
+    // Helpers started by the processing thread inherit its policy
+    if (defaults.rt_priority > 0) {
+        struct sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    }
+#else
+    (void)defaults;
+#endif
+}
+
+} /* namespace oat */
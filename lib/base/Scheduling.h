@@ -0,0 +1,83 @@
+//******************************************************************************
+//* File:   Scheduling.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef OAT_SCHEDULING_H
+#define OAT_SCHEDULING_H
+
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Component.h"
+
+namespace oat {
+
+/**
+ * @brief Parse a list of CPUs, e.g. '2' or '0-3,6'.
+ * @param list Comma separated CPU numbers and inclusive ranges.
+ * @return Sorted CPU numbers, without repeats.
+ */
+std::vector<int> parseCpuList(const std::string &list);
+
+/**
+ * @brief Apply the --mlock, --cpu and --rt-priority settings to the calling
+ * thread, which should be a component's processing thread. Threads it starts
+ * afterwards, e.g. pipeline stages and thread pool workers, inherit its
+ * affinity and priority. Settings that the system refuses, e.g. for lack of
+ * privileges, are reported as warnings.
+ * @param defaults Run settings.
+ * @param who Name of the component, for warnings.
+ */
+void applyProcessingScheduling(const RunDefaults &defaults,
+                               const std::string &who);
+
+/**
+ * @brief Apply the --helper-cpu setting to the calling thread, which should
+ * be a helper thread, e.g. a control, writer or display thread. Without
+ * --helper-cpu, helpers keep off the processing thread's CPUs as long as
+ * others are available. Helpers never run with real-time priority, so that
+ * they cannot preempt the processing thread.
+ * @param defaults Run settings.
+ */
+void applyHelperScheduling(const RunDefaults &defaults);
+
+/**
+ * @brief Start a helper thread that applies applyHelperScheduling() before
+ * calling f. Call on the component's thread after it has been configured so
+ * that the thread gets the component's settings.
+ * @param f Function to run on the helper thread.
+ * @return Helper thread.
+ */
+template <typename F>
+std::thread startHelper(F &&f)
+{
+    const RunDefaults defaults = runDefaults();
+    return std::thread(
+        [defaults](typename std::decay<F>::type task) {
+            applyHelperScheduling(defaults);
+            task();
+        },
+        std::forward<F>(f));
+}
+
+}      /* namespace oat */
+#endif /* OAT_SCHEDULING_H */
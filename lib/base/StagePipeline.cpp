@@ -0,0 +1,165 @@
+//******************************************************************************
+//* File:   StagePipeline.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "StagePipeline.h"
+#include "Globals.h"
+
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../shmemdf/Futex.h"
+#include "../shmemdf/Trace.h"
+
+namespace oat {
+
+// Longest a stage blocks before re-checking its queue, like node waits
+static constexpr std::chrono::milliseconds STAGE_WAIT {10};
+
+void StagePipeline::SlotQueue::push(const size_t slot)
+{
+    // Never full, because there are only as many slots as its capacity
+    queue_.push(slot);
+    wake();
+}
+
+bool StagePipeline::SlotQueue::pop(size_t &slot)
+{
+    for (;;) {
+
+        if (aborted_.load(std::memory_order_acquire))
+            return false;
+
+        const uint32_t seen = signal_.load(std::memory_order_acquire);
+        if (queue_.pop(slot))
+            return true;
+
+        // Slots pushed before the queue was closed are still delivered
+        if (closed_.load(std::memory_order_acquire))
+            return queue_.pop(slot);
+
+        // A push after seen was read returns immediately from the wait, so
+        // waiting_ only needs to be raised before it
+        ++waiting_;
+        futexWait(signal_, seen, STAGE_WAIT);
+        --waiting_;
+    }
+}
+
+void StagePipeline::SlotQueue::close()
+{
+    closed_.store(true, std::memory_order_release);
+    wake();
+}
+
+void StagePipeline::SlotQueue::wake()
+{
+    // The syscall is skipped if nobody is waiting
+    ++signal_;
+    if (waiting_ > 0)
+        futexWake(signal_);
+}
+
+void StagePipeline::SlotQueue::abort()
+{
+    aborted_.store(true, std::memory_order_release);
+    close();
+}
+
+StagePipeline::StagePipeline(const size_t depth)
+: depth_(depth)
+{
+    if (depth_ == 0)
+        throw std::runtime_error("A stage pipeline needs at least one slot.");
+}
+
+void StagePipeline::run(const ReadStage &read,
+                        const Stage &compute,
+                        const Stage &write)
+{
+    SlotQueue free(depth_), read_done(depth_), compute_done(depth_);
+    for (size_t i = 0; i < depth_; i++)
+        free.push(i);
+
+    // Latency traces of the samples in each slot, which are read and written
+    // by different threads
+    std::vector<oat::Tracer> traces(depth_);
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto fail = [&] {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+            error = std::current_exception();
+        free.abort();
+        read_done.abort();
+        compute_done.abort();
+    };
+
+    std::thread compute_thread([&] {
+        try {
+            size_t slot;
+            while (read_done.pop(slot)) {
+                compute(slot);
+                compute_done.push(slot);
+            }
+            compute_done.close();
+        } catch (...) {
+            fail();
+        }
+    });
+
+    std::thread write_thread([&] {
+        try {
+            size_t slot;
+            while (compute_done.pop(slot)) {
+                oat::tracer().resume(traces[slot]);
+                write(slot);
+                free.push(slot);
+            }
+        } catch (...) {
+            fail();
+        }
+    });
+
+    // Read on the calling thread, which connected to the nodes
+    try {
+        size_t slot;
+        while (!quit && free.pop(slot)) {
+            if (read(slot) != 0)
+                break;
+            traces[slot] = oat::tracer().suspend();
+            read_done.push(slot);
+        }
+        read_done.close();
+    } catch (...) {
+        fail();
+    }
+
+    compute_thread.join();
+    write_thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} /* namespace oat */
@@ -0,0 +1,98 @@
+//******************************************************************************
+//* File:   StagePipeline.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_STAGEPIPELINE_H
+#define OAT_STAGEPIPELINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+namespace oat {
+
+/**
+ * @brief Runs a component's read, compute and write stages on separate
+ * threads so that computing on one sample overlaps reading the next and
+ * writing the last. Samples live in a fixed number of slots that the
+ * component allocates up front. Slot indices are passed from stage to stage,
+ * in sample order, through bounded single-producer single-consumer queues,
+ * and back to the read stage once written. So no more than depth samples are
+ * ever in flight and nothing is allocated per sample.
+ */
+class StagePipeline {
+public:
+
+    using ReadStage = std::function<int(size_t)>;
+    using Stage = std::function<void(size_t)>;
+
+    /**
+     * @param depth Number of slots.
+     */
+    explicit StagePipeline(const size_t depth);
+
+    /**
+     * @brief Run the stages until the read stage reaches the end of the
+     * stream or oat::quit is set. Samples that were read are still computed
+     * and written. The read stage runs on the calling thread. If any stage
+     * throws, the others stop and the first exception is rethrown here.
+     * @param read Read the next sample into a slot. Returns 0 for more and 1
+     * at the end of the stream.
+     * @param compute Process the sample in a slot.
+     * @param write Publish the sample in a slot.
+     */
+    void run(const ReadStage &read, const Stage &compute, const Stage &write);
+
+private:
+
+    // Blocking queue of slot indices between two stages
+    class SlotQueue {
+    public:
+        explicit SlotQueue(const size_t capacity) : queue_(capacity) { }
+
+        void push(const size_t slot);
+
+        // Blocks until a slot is available. False once the queue has been
+        // closed and drained, or aborted.
+        bool pop(size_t &slot);
+
+        // No more slots will be pushed
+        void close(void);
+
+        // Stop popping, even if slots remain
+        void abort(void);
+
+    private:
+        // Bump signal_ and wake the popping thread if it is waiting
+        void wake(void);
+
+        boost::lockfree::spsc_queue<size_t> queue_;
+        std::atomic<uint32_t> signal_ {0}; //!< Futex word bumped on push
+        std::atomic<uint32_t> waiting_ {0}; //!< Threads waiting on signal_
+        std::atomic<bool> closed_ {false};
+        std::atomic<bool> aborted_ {false};
+    };
+
+    const size_t depth_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_STAGEPIPELINE_H */
@@ -0,0 +1,115 @@
+//******************************************************************************
+//* File:   ThreadPool.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "ThreadPool.h"
+
+#include <stdexcept>
+
+namespace oat {
+
+ThreadPool::ThreadPool(const size_t threads)
+{
+    if (threads == 0)
+        throw std::runtime_error("A thread pool needs at least one thread.");
+
+    for (size_t i = 1; i < threads; i++)
+        workers_.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+
+    for (auto &w : workers_)
+        w.join();
+}
+
+void ThreadPool::parallelFor(const size_t n, const Task &task)
+{
+    // Not worth waking anyone
+    if (workers_.empty() || n < 2) {
+        for (size_t i = 0; i < n; i++)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = n;
+        next_.store(0, std::memory_order_relaxed);
+        pending_ = workers_.size();
+        error_ = nullptr;
+        generation_++;
+    }
+    start_.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void ThreadPool::work()
+{
+    size_t i;
+    while ((i = next_.fetch_add(1, std::memory_order_relaxed)) < count_) {
+        try {
+            (*task_)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+                error_ = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    uint64_t seen = 0;
+
+    for (;;) {
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+            seen = generation_;
+        }
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0)
+                done_.notify_one();
+        }
+    }
+}
+
+} /* namespace oat */
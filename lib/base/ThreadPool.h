@@ -0,0 +1,116 @@
+//******************************************************************************
+//* File:   ThreadPool.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_THREADPOOL_H
+#define OAT_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace oat {
+
+/**
+ * @brief Fixed set of worker threads that split a per-sample task between
+ * them. The thread that submits the task works on it too, so a pool of N
+ * threads starts N - 1 workers. Workers sleep between tasks.
+ */
+class ThreadPool {
+public:
+
+    using Task = std::function<void(size_t)>;
+
+    /**
+     * @param threads Number of threads that work on each task, including the
+     * caller's.
+     */
+    explicit ThreadPool(const size_t threads);
+    ~ThreadPool();
+
+    // Pools are not copyable
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Number of threads that work on each task.
+     */
+    size_t size(void) const { return workers_.size() + 1; }
+
+    /**
+     * @brief Call task(i) for each i in [0, n), spread across the pool, and
+     * wait for all calls to return. Not reentrant. If any call throws, the
+     * first exception is rethrown here once the rest have finished.
+     * @param n Number of calls.
+     * @param task Function to call.
+     */
+    void parallelFor(const size_t n, const Task &task);
+
+private:
+
+    // Claim and run calls of the current task until there are none left
+    void work(void);
+    void workerLoop(void);
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    uint64_t generation_ {0}; //!< Incremented for each task
+    size_t pending_ {0}; //!< Workers yet to finish the current task
+    bool stop_ {false};
+
+    const Task *task_ {nullptr};
+    size_t count_ {0};
+    std::atomic<size_t> next_ {0};
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Split [0, n) into nearly equal, contiguous bands. Every band except
+ * the last starts and ends on a multiple of align, e.g. so that bands of a
+ * Bayer mosaic keep its pattern.
+ * @param n Number of items, e.g. frame rows.
+ * @param bands Number of bands.
+ * @param i Band index, less than bands.
+ * @param align Granularity of band boundaries.
+ * @return [begin, end) of band i. Empty if there are more bands than aligned
+ * units.
+ */
+inline std::pair<size_t, size_t> band(const size_t n,
+                                      const size_t bands,
+                                      const size_t i,
+                                      const size_t align = 1)
+{
+    const size_t units = (n + align - 1) / align;
+    const size_t begin = std::min(n, units * i / bands * align);
+    const size_t end = std::min(n, units * (i + 1) / bands * align);
+    return {begin, end};
+}
+
+}      /* namespace oat */
+#endif /* OAT_THREADPOOL_H */
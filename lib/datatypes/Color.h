@@ -20,6 +20,8 @@
 #ifndef OAT_COLOR_H
 #define	OAT_COLOR_H
 
+#include <algorithm>
+
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -30,24 +32,55 @@ enum PixelColor {
     PIX_BINARY = 0,
     PIX_GREY,
     PIX_BGR, // Default
-    PIX_HSV
+    PIX_HSV,
+    PIX_BAYER_RGGB, // Raw sensor mosaics, named by their top-left 2x2 tile
+    PIX_BAYER_BGGR,
+    PIX_BAYER_GRBG,
+    PIX_BAYER_GBRG,
+    PIX_GREY16,
+    PIX_YUV422 // Packed 4:2:2, U0 Y0 V0 Y1 (UYVY)
 };
 
+static constexpr int PIX_COUNT {10};
+
 // Used conversion structures
-static const int color_2_cvtype[4]{CV_8UC1, CV_8UC1, CV_8UC3, CV_8UC3};
-static const int color_2_bytes[4]{1, 1, 3, 3};
+static const int color_2_cvtype[PIX_COUNT]{CV_8UC1, CV_8UC1, CV_8UC3, CV_8UC3,
+    CV_8UC1, CV_8UC1, CV_8UC1, CV_8UC1, CV_16UC1, CV_8UC2};
+static const int color_2_bytes[PIX_COUNT]{1, 1, 3, 3, 1, 1, 1, 1, 2, 2};
+
+static const int color_2_imread_code[PIX_COUNT]{
+    -2, cv::IMREAD_GRAYSCALE, cv::IMREAD_COLOR, -2, -2, -2, -2, -2, -2, -2};
 
-static const int color_2_imread_code[4]{
-    -2, cv::IMREAD_GRAYSCALE, cv::IMREAD_COLOR, -2};
+// Conversions that are not a single cv::cvtColor() code
+static constexpr int COLOR_CONV_NONE {-1};
+static constexpr int COLOR_CONV_IMPOSSIBLE {-2};
+static constexpr int COLOR_CONV_VIA_BGR {-3};
+static constexpr int COLOR_CONV_VIA_GREY {-4}; // Changes depth
 
 // Arguments are from/to PixelColors
 // -1 = No conversion needed
 // -2 = Conversion not possible
-static const int color_conv_table[4][4]{
-    {-1, -1, cv::COLOR_GRAY2BGR, -2}, // From BINARY
-    {-1, -1, cv::COLOR_GRAY2BGR, -2}, // From GREY
-    {cv::COLOR_BGR2GRAY, cv::COLOR_BGR2GRAY, -1, cv::COLOR_BGR2HSV}, // From BGR
-    {-2, -2, cv::COLOR_HSV2BGR, -1}, // From HSV
+// -3 = Convert to BGR first
+// -4 = Convert to or from 8-bit GREY first
+// NOTE: OpenCV names Bayer patterns by the 2x2 tile starting at the second
+// row and column, so e.g. an RGGB sensor is BayerBG.
+static const int color_conv_table[PIX_COUNT][PIX_COUNT]{
+    {-1, -1, cv::COLOR_GRAY2BGR, -2, -2, -2, -2, -2, -4, -2}, // From BINARY
+    {-1, -1, cv::COLOR_GRAY2BGR, -2, -2, -2, -2, -2, -4, -2}, // From GREY
+    {cv::COLOR_BGR2GRAY, cv::COLOR_BGR2GRAY, -1, cv::COLOR_BGR2HSV,
+        -2, -2, -2, -2, -4, -2}, // From BGR
+    {-2, -2, cv::COLOR_HSV2BGR, -1, -2, -2, -2, -2, -2, -2}, // From HSV
+    {cv::COLOR_BayerBG2GRAY, cv::COLOR_BayerBG2GRAY, cv::COLOR_BayerBG2BGR,
+        -3, -1, -2, -2, -2, -4, -2}, // From BAYER_RGGB
+    {cv::COLOR_BayerRG2GRAY, cv::COLOR_BayerRG2GRAY, cv::COLOR_BayerRG2BGR,
+        -3, -2, -1, -2, -2, -4, -2}, // From BAYER_BGGR
+    {cv::COLOR_BayerGB2GRAY, cv::COLOR_BayerGB2GRAY, cv::COLOR_BayerGB2BGR,
+        -3, -2, -2, -1, -2, -4, -2}, // From BAYER_GRBG
+    {cv::COLOR_BayerGR2GRAY, cv::COLOR_BayerGR2GRAY, cv::COLOR_BayerGR2BGR,
+        -3, -2, -2, -2, -1, -4, -2}, // From BAYER_GBRG
+    {-4, -4, -4, -2, -2, -2, -2, -2, -1, -2}, // From GREY16
+    {cv::COLOR_YUV2GRAY_UYVY, cv::COLOR_YUV2GRAY_UYVY, cv::COLOR_YUV2BGR_UYVY,
+        -3, -2, -2, -2, -2, -4, -1}, // From YUV422
 };
 
 inline std::string color_str(const oat::PixelColor col)
@@ -57,6 +90,12 @@ inline std::string color_str(const oat::PixelColor col)
         case PIX_GREY : return "GREY";
         case PIX_BGR : return "BGR";
         case PIX_HSV : return "HSV";
+        case PIX_BAYER_RGGB : return "BAYER_RGGB";
+        case PIX_BAYER_BGGR : return "BAYER_BGGR";
+        case PIX_BAYER_GRBG : return "BAYER_GRBG";
+        case PIX_BAYER_GBRG : return "BAYER_GBRG";
+        case PIX_GREY16 : return "GREY16";
+        case PIX_YUV422 : return "YUV422";
         default : throw std::runtime_error("Invalid color.");
     }
 }
@@ -71,6 +110,18 @@ inline oat::PixelColor str_color(const std::string &s)
         return PIX_BGR;
     else if (s == "HSV")
         return PIX_HSV;
+    else if (s == "BAYER_RGGB")
+        return PIX_BAYER_RGGB;
+    else if (s == "BAYER_BGGR")
+        return PIX_BAYER_BGGR;
+    else if (s == "BAYER_GRBG")
+        return PIX_BAYER_GRBG;
+    else if (s == "BAYER_GBRG")
+        return PIX_BAYER_GBRG;
+    else if (s == "GREY16")
+        return PIX_GREY16;
+    else if (s == "YUV422")
+        return PIX_YUV422;
     else
         throw std::runtime_error("Invalid color.");
 }
@@ -88,12 +139,106 @@ inline int color_bytes(oat::PixelColor col)
 inline int color_conv_code(oat::PixelColor from, oat::PixelColor to)
 {
     auto code =  color_conv_table[from][to];
-    if (code == -2)
+    if (code == COLOR_CONV_IMPOSSIBLE)
         throw std::runtime_error("Requested color conversion is not possible.");
 
     return code;
 }
 
+/**
+ * @brief Whether pixels are in a raw sensor format that most components
+ * cannot use directly. These are published as-is by frame servers and only
+ * expanded by the components that need to, e.g. using oat-framefilt col.
+ */
+inline bool is_raw(oat::PixelColor col)
+{
+    return col >= PIX_BAYER_RGGB;
+}
+
+/**
+ * @brief Whether pixels are a Bayer mosaic, in which each pixel depends on
+ * its neighbours when demosaiced.
+ */
+inline bool is_bayer(oat::PixelColor col)
+{
+    return col >= PIX_BAYER_RGGB && col <= PIX_BAYER_GBRG;
+}
+
+/**
+ * @brief Convert a frame's pixels between colors. Uses OpenCV's vectorized
+ * color and depth conversions. Conversions without a direct kernel go through
+ * BGR or GREY. 16-bit GREY keeps its most significant byte when narrowed.
+ * @param from Frame to convert.
+ * @param to Converted frame. Can be from, in which case it may be reallocated.
+ * @param from_col Color of from.
+ * @param to_col Color to convert to.
+ */
+inline void convertColor(const cv::Mat &from,
+                         cv::Mat &to,
+                         const oat::PixelColor from_col,
+                         const oat::PixelColor to_col)
+{
+    const int code = color_conv_code(from_col, to_col);
+
+    switch (code) {
+        case COLOR_CONV_NONE:
+            to = from;
+            break;
+        case COLOR_CONV_VIA_BGR: {
+            cv::Mat bgr;
+            convertColor(from, bgr, from_col, PIX_BGR);
+            convertColor(bgr, to, PIX_BGR, to_col);
+            break;
+        }
+        case COLOR_CONV_VIA_GREY: {
+            cv::Mat grey;
+            if (from_col == PIX_GREY16) {
+                from.convertTo(grey, CV_8U, 1.0 / 256);
+                convertColor(grey, to, PIX_GREY, to_col);
+            } else {
+                convertColor(from, grey, from_col, PIX_GREY);
+                grey.convertTo(to, CV_16U, 256);
+            }
+            break;
+        }
+        default:
+            cv::cvtColor(from, to, code);
+    }
+}
+
+// Rows either side of a band that demosaicing reads. Even, so that a band
+// that starts on an even row keeps its Bayer pattern.
+static constexpr int BAYER_BAND_MARGIN {2};
+
+/**
+ * @brief Convert a band of a frame's rows between colors. Bayer mosaics are
+ * demosaiced with a margin of rows around the band, so the result matches
+ * the same rows of the whole converted frame.
+ * @param from Whole frame to convert.
+ * @param to Converted band. If it already has the band's size and type, it
+ * is written in place.
+ * @param from_col Color of from.
+ * @param to_col Color to convert to.
+ * @param rows Rows of from to convert. Must start on an even row.
+ */
+inline void convertColorBand(const cv::Mat &from,
+                             cv::Mat &to,
+                             const oat::PixelColor from_col,
+                             const oat::PixelColor to_col,
+                             const cv::Range &rows)
+{
+    if (!is_bayer(from_col)) {
+        convertColor(from.rowRange(rows), to, from_col, to_col);
+        return;
+    }
+
+    const cv::Range src(std::max(0, rows.start - BAYER_BAND_MARGIN),
+                        std::min(from.rows, rows.end + BAYER_BAND_MARGIN));
+    cv::Mat converted;
+    convertColor(from.rowRange(src), converted, from_col, to_col);
+    converted.rowRange(rows.start - src.start, rows.end - src.start).copyTo(to);
+}
+
 inline int imread_code(oat::PixelColor col)
 {
     auto code = color_2_imread_code[col];
@@ -94,8 +94,9 @@ public:
           const int t,
           const oat::PixelColor col,
           void *data,
-          void *samp_ptr)
-    : cv::Mat(r, c, t, data)
+          void *samp_ptr,
+          const size_t step = cv::Mat::AUTO_STEP)
+    : cv::Mat(r, c, t, data, step)
     , sample_ptr_(static_cast<Sample *>(samp_ptr))
     , color_(col)
     {
@@ -121,6 +122,7 @@ public:
     Frame operator()(const cv::Rect &roi) const { return Frame(*this, roi); }
 
     // Set sample rate
+    void set_sample(const Sample &val) { *sample_ptr_ = val; }
     void set_rate_hz(const double rate_hz) { sample_ptr_->set_rate_hz(rate_hz); }
     double sample_period_sec() const { return sample_ptr_->period_sec().count(); }
     uint64_t sample_count(void) const { return sample_ptr_->count(); }
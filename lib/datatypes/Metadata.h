@@ -0,0 +1,36 @@
+//******************************************************************************
+//* File:   Metadata.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_METADATA_H
+#define	OAT_METADATA_H
+
+namespace oat {
+
+/**
+ * @brief Information about the tokens published to a node that is the same
+ * for every sample, e.g. the coordinate system of positions. It is kept once
+ * per node, next to the node's ring of tokens, instead of being copied with
+ * each token. Empty unless specialized for T. Specializations must be
+ * trivially copyable.
+ */
+template <typename T>
+struct Metadata { };
+
+}      /* namespace oat */
+#endif /* OAT_METADATA_H */
@@ -19,80 +19,36 @@
 
 #include "Position2D.h"
 
+#include <cstddef>
+
 namespace oat {
 
+// Describes Position2D's members, in place, so records can be written as they
+// are. The sample period and rate are not recorded.
 const char Position2D::NPY_DTYPE[]{"[('tick', '<u8'),"
                                     "('usec', '<u8'),"
+                                    "('', '|V24'),"
+                                    "('pos_xy', 'f8', (2)),"
+                                    "('vel_xy', 'f8', (2)),"
+                                    "('head_xy', 'f8', (2)),"
                                     "('unit', '<i4'),"
                                     "('pos_ok', '<i1'),"
-                                    "('pos_xy', 'f8', (2)),"
                                     "('vel_ok', '<i1'),"
-                                    "('vel_xy', 'f8', (2)),"
                                     "('head_ok', '<i1'),"
-                                    "('head_xy', 'f8', (2)),"
                                     "('reg_ok', '<i1'),"
-                                    "('reg', 'a10')]"};
-
-// TODO: This feels horrible...
-std::vector<char> packPosition(const Position2D &p)
-{
-    std::vector<char> pack;
-    pack.reserve(oat::Position2D::NPY_DTYPE_BYTES);
-
-    auto sc = p.sample_.count();
-    auto val = reinterpret_cast<char*>(&sc);
-    pack.insert(pack.end(), val, val + sizeof (sc));
-
-    auto su = p.sample_usec();
-    val = reinterpret_cast<char*>(&su);
-    pack.insert(pack.end(), val, val + sizeof (su));
-
-    auto u = static_cast<int>(p.unit_of_length_);
-    val = reinterpret_cast<char*>(&u);
-    pack.insert(pack.end(), val, val + sizeof (u));
-
-    // Position
-    char pok = p.position_valid ? 1 : 0;
-    pack.insert(pack.end(), &pok, &pok + 1);
-
-    auto px = p.position.x;
-    val = reinterpret_cast<char*>(&px);
-    pack.insert(pack.end(), val, val + sizeof (px));
-
-    auto py = p.position.y;
-    val = reinterpret_cast<char*>(&py);
-    pack.insert(pack.end(), val, val + sizeof (px));
-
-    // Velocity
-    char vok = p.velocity_valid ? 1 : 0;
-    pack.insert(pack.end(), &vok, &vok + 1);
-
-    auto vx = p.velocity.x;
-    val = reinterpret_cast<char*>(&vx);
-    pack.insert(pack.end(), val, val + sizeof (vx));
-
-    auto vy = p.velocity.y;
-    val = reinterpret_cast<char*>(&vy);
-    pack.insert(pack.end(), val, val + sizeof (vx));
-
-    // Heading
-    char hok = p.heading_valid ? 1 : 0;
-    pack.insert(pack.end(), &hok, &hok + 1);
-
-    auto hx = p.heading.x;
-    val = reinterpret_cast<char*>(&hx);
-    pack.insert(pack.end(), val, val + sizeof (hx));
-
-    auto hy = p.heading.y;
-    val = reinterpret_cast<char*>(&hy);
-    pack.insert(pack.end(), val, val + sizeof (hx));
-
-    // Region
-    char rok = p.region_valid ? 1 : 0;
-    pack.insert(pack.end(), &rok, &rok + 1);
-    pack.insert(pack.end(), p.region, p.region + oat::Position2D::REGION_LEN);
-
-    return pack;
-}
+                                    "('reg', 'a10'),"
+                                    "('', '|V6')]"};
+
+// Sample starts with its count and microseconds
+static_assert(sizeof(Sample) == 40, "Position2D::NPY_DTYPE must be updated.");
+static_assert(offsetof(Position2D, position) == 40
+              && offsetof(Position2D, velocity) == 56
+              && offsetof(Position2D, heading) == 72
+              && offsetof(Position2D, unit) == 88
+              && offsetof(Position2D, position_valid) == 92
+              && offsetof(Position2D, region_valid) == 95
+              && offsetof(Position2D, region) == 96
+              && sizeof(bool) == 1,
+              "Position2D::NPY_DTYPE must be updated.");
 
 } /* namespace oat */
@@ -20,19 +20,58 @@
 #ifndef OAT_POSITION_H
 #define	OAT_POSITION_H
 
+#include <algorithm>
+#include <cstring>
 #include <string>
-#include <vector>
+#include <type_traits>
 
 #include <opencv2/core/mat.hpp>
 #include <rapidjson/prettywriter.h>
 
+#include "Metadata.h"
 #include "Sample.h"
 
 namespace oat {
 
-using Point2D = cv::Point2d;
-using Velocity2D = cv::Point2d;
-using UnitVector2D = cv::Point2d;
+/**
+ * @brief 2D vector of doubles. Unlike cv::Point2d, it is trivially copyable,
+ * so positions holding it can be copied and written as raw bytes. Converts
+ * to and from OpenCV points.
+ */
+struct Vector2D {
+
+    Vector2D() = default;
+    Vector2D(const double x_, const double y_) : x(x_), y(y_) { }
+    Vector2D(const cv::Point2d &p) : x(p.x), y(p.y) { }
+
+    template <typename T>
+    operator cv::Point_<T>() const
+    {
+        return cv::Point_<T>(cv::saturate_cast<T>(x), cv::saturate_cast<T>(y));
+    }
+
+    Vector2D &operator+=(const Vector2D &v) { x += v.x; y += v.y; return *this; }
+    Vector2D &operator-=(const Vector2D &v) { x -= v.x; y -= v.y; return *this; }
+
+    double x {0.0};
+    double y {0.0};
+};
+
+inline Vector2D operator+(Vector2D a, const Vector2D &b) { return a += b; }
+inline Vector2D operator-(Vector2D a, const Vector2D &b) { return a -= b; }
+inline Vector2D operator*(const double s, const Vector2D &v)
+{
+    return Vector2D(s * v.x, s * v.y);
+}
+inline Vector2D operator*(const Vector2D &v, const double s) { return s * v; }
+inline Vector2D operator/(const Vector2D &v, const double s)
+{
+    return Vector2D(v.x / s, v.y / s);
+}
+
+using Point2D = Vector2D;
+using Velocity2D = Vector2D;
+using UnitVector2D = Vector2D;
 
 // Forward decl.
 class Position2D;
@@ -46,113 +85,104 @@ class Position2D;
 template <typename Writer>
 void serializePosition(const Position2D &p, Writer &w, bool verbose = false);
 
-/** 
- * @brief Pack a position object into a byte array.
- * @param Position2D Position to pack into a byte array.
- * @return Byte arrayByte array.
- */
-std::vector<char> packPosition(const Position2D &p);
-
 /**
  * Unit of length used to specify position.
  */
-enum class DistanceUnit
+enum class DistanceUnit : int32_t
 {
     PIXELS = 0,   //!< Position measured in pixels. Origin is upper left.
     WORLD = 1     //!< Position measured in units specified via homography
 };
 
+/**
+ * @brief Position of a single target in a single sample.
+ *
+ * Positions are copied through shared memory on every hop between
+ * components and written to numpy files as they are, so this is a standard
+ * layout, trivially copyable record whose members are laid out as NPY_DTYPE
+ * describes. Information that is the same for every sample, the label and
+ * the homography to world units, is kept once per node in
+ * Metadata<Position2D>.
+ */
 class Position2D {
 
-    template <typename Writer>
-    friend void
-    serializePosition(const Position2D &, Writer &, bool verbose);
-    friend std::vector<char> packPosition(const Position2D &);
-
     using USec = Sample::Microseconds;
 
 public:
 
-    explicit Position2D(const std::string &label)
-    {
-        strncpy(label_, label.c_str(), sizeof(label_));
-        label_[sizeof(label_) - 1] = '\0';
-    }
+    // Set sample rate
+    void set_sample(const Sample &val) { sample = val; }
+    void set_rate_hz(const double rate_hz) { sample.set_rate_hz(rate_hz); }
+    double sample_period_sec() const { return sample.period_sec().count(); }
+    uint64_t sample_count(void) const { return sample.count(); }
+    uint64_t sample_usec(void) const { return sample.microseconds().count(); }
+    void incrementSampleCount() { sample.incrementCount(); }
+    void incrementSampleCount(USec us) { sample.incrementCount(us); }
 
-    // Copy all but label, which is specific to the component
-    // TODO: get rid of the label all together...
-    Position2D &operator=(const Position2D &p)
-    {
+    static constexpr size_t REGION_LEN {10};
 
-        // Check for self assignment
-        if (this == &p)
-            return *this;
-
-        // Copy all except label_
-        unit_of_length_ = p.unit_of_length_;
-        sample_ = p.sample_;
-        position_valid = p.position_valid;
-        velocity_valid = p.velocity_valid;
-        heading_valid = p.heading_valid;
-        position = p.position;
-        velocity = p.velocity;
-        heading = p.heading;
-        region_valid = p.region_valid;
-        strncpy(region, p.region, sizeof(region));
-        region[sizeof(region) - 1] = '\0';
-
-        return *this;
-    }
+    oat::Sample sample;
 
-    // Accessors
-    char *label() { return label_; }
-    DistanceUnit unit_of_length(void) const { return unit_of_length_; }
+    // Position data
+    Point2D position;
+    Velocity2D velocity;
+    UnitVector2D heading;
 
-    // Categorical position
-    static constexpr size_t REGION_LEN {10};
-    bool region_valid {false};
-    char region[REGION_LEN] {0}; //!< Categorical position label (e.g. "North West")
+    // Coordinate system. The homography for WORLD units is in the node's
+    // Metadata<Position2D>.
+    DistanceUnit unit {DistanceUnit::PIXELS};
 
     // Validity booleans
     bool position_valid {false};
     bool velocity_valid {false};
     bool heading_valid {false};
+    bool region_valid {false};
 
-    // Position data
-    Point2D position;
-    Velocity2D velocity;
-    UnitVector2D heading;
+    // Categorical position
+    char region[REGION_LEN] {0}; //!< Categorical position label (e.g. "North West")
+
+    static constexpr size_t NPY_DTYPE_BYTES {112};
+    static const char NPY_DTYPE[];
+};
 
-    // Homography
-    cv::Matx33d homography() const { return homography_; }
+static_assert(std::is_standard_layout<Position2D>::value
+              && std::is_trivially_copyable<Position2D>::value,
+              "Position2D must be a plain record.");
+static_assert(sizeof(Position2D) == Position2D::NPY_DTYPE_BYTES,
+              "Position2D::NPY_DTYPE must describe Position2D's layout.");
 
-    // Set sample rate
-    void set_sample(const Sample &val) { sample_ = val; }
-    void set_rate_hz(const double rate_hz) { sample_.set_rate_hz(rate_hz); }
-    double sample_period_sec() const { return sample_.period_sec().count(); }
-    uint64_t sample_count(void) const { return sample_.count(); }
-    uint64_t sample_usec(void) const { return sample_.microseconds().count(); }
-    void incrementSampleCount() { sample_.incrementCount(); }
-    void incrementSampleCount(USec us) { sample_.incrementCount(us); }
-
-    void setCoordSystem(const DistanceUnit value, const cv::Matx33d homography)
+/**
+ * @brief Label and coordinate system of the positions published to a node.
+ */
+template <>
+struct Metadata<Position2D> {
+
+    static constexpr size_t LABEL_LEN {100};
+
+    Metadata() = default;
+
+    explicit Metadata(const std::string &label) { set_label(label); }
+
+    const char *label(void) const { return label_; }
+    void set_label(const std::string &label)
     {
-        unit_of_length_ = value;
-        homography_ = homography;
+        strncpy(label_, label.c_str(), sizeof(label_));
+        label_[sizeof(label_) - 1] = '\0';
     }
 
-    static constexpr size_t NPY_DTYPE_BYTES {82};
-    static const char NPY_DTYPE[];
+    // Maps pixels to the units of positions that are in WORLD units
+    cv::Matx33d homography(void) const { return cv::Matx33d(homography_); }
+    void set_homography(const cv::Matx33d &homography)
+    {
+        std::copy(homography.val, homography.val + 9, homography_);
+    }
 
 private:
 
-    char label_[100] {0}; //!< Position label (e.g. "anterior")
-    DistanceUnit unit_of_length_ {DistanceUnit::PIXELS};
-
-    oat::Sample sample_;
+    char label_[LABEL_LEN] {0}; //!< Position label (e.g. "anterior")
 
     // TODO: Generalize to 3D position. Replace homography_ with tvec and rvec
-    cv::Matx33d homography_ {1.0, 0, 0, 0, 1.0, 0, 0, 0, 1.0};
+    double homography_[9] {1.0, 0, 0, 0, 1.0, 0, 0, 0, 1.0}; //!< Row major
 };
 
 /**
@@ -182,7 +212,7 @@ void serializePosition(const Position2D &p, Writer &writer, bool verbose)
 
     // Coordinate system
     writer.String("unit");
-    writer.Int(static_cast<int>(p.unit_of_length_));
+    writer.Int(static_cast<int>(p.unit));
 
     // Position
     writer.String("pos_ok");
@@ -0,0 +1,51 @@
+//******************************************************************************
+//* File:   PositionList.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "PositionList.h"
+
+namespace oat {
+
+// One record per sample. Unused ID and position entries are zero and
+// default respectively. The sub-array lengths must match MAX_POSITIONS. The
+// sample period and rate are not recorded.
+const char PositionList::NPY_DTYPE[]{"[('tick', '<u8'),"
+                                      "('usec', '<u8'),"
+                                      "('', '|V24'),"
+                                      "('count', '<u4'),"
+                                      "('ids', '<u4', (16)),"
+                                      "('', '|V4'),"
+                                      "('positions', "
+                                          "[('tick', '<u8'),"
+                                          "('usec', '<u8'),"
+                                          "('', '|V24'),"
+                                          "('pos_xy', 'f8', (2)),"
+                                          "('vel_xy', 'f8', (2)),"
+                                          "('head_xy', 'f8', (2)),"
+                                          "('unit', '<i4'),"
+                                          "('pos_ok', '<i1'),"
+                                          "('vel_ok', '<i1'),"
+                                          "('head_ok', '<i1'),"
+                                          "('reg_ok', '<i1'),"
+                                          "('reg', 'a10'),"
+                                          "('', '|V6')], (16))]"};
+
+static_assert(PositionList::MAX_POSITIONS == 16,
+              "PositionList::NPY_DTYPE sub-array lengths must be updated.");
+
+} /* namespace oat */
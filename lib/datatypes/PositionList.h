@@ -0,0 +1,216 @@
+//******************************************************************************
+//* File:   PositionList.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONLIST_H
+#define	OAT_POSITIONLIST_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "Position2D.h"
+#include "Sample.h"
+
+namespace oat {
+
+// Forward decl.
+class PositionList;
+
+/**
+ * @brief Serialize a list of positions.
+ * @param l List to serialize.
+ * @param w Writer to serialize with.
+ * @param verbose Allow verbose serialization.
+ */
+template <typename Writer>
+void serializePosition(const PositionList &l, Writer &w, bool verbose = false);
+
+/**
+ * @brief Positions of up to MAX_POSITIONS targets from a single sample, each
+ * with an ID that identifies the target from sample to sample. Positions are
+ * packed at the front of a fixed-size array, so the list can be exchanged
+ * through shared memory like any other token and only its valid entries are
+ * copied. Unused entries are kept at their defaults, so the list is laid out
+ * as NPY_DTYPE describes and can be written as it is.
+ */
+class PositionList {
+
+    template <typename Writer>
+    friend void
+    serializePosition(const PositionList &, Writer &, bool verbose);
+
+    using USec = Sample::Microseconds;
+
+public:
+
+    static constexpr size_t MAX_POSITIONS {16};
+
+    PositionList() = default;
+
+    PositionList(const PositionList &l)
+    {
+        *this = l;
+    }
+
+    // Only valid positions are copied
+    PositionList &operator=(const PositionList &l)
+    {
+        // Check for self assignment
+        if (this == &l)
+            return *this;
+
+        // Guard against a torn count when the list is read without holding
+        // it, e.g. by a latest-sample SOURCE that will retry anyway
+        const uint32_t n = std::min(l.count_, static_cast<uint32_t>(MAX_POSITIONS));
+        reset(n, count_);
+        count_ = n;
+        sample_ = l.sample_;
+        std::copy(l.ids_.begin(), l.ids_.begin() + count_, ids_.begin());
+        std::copy(l.positions_.begin(),
+                  l.positions_.begin() + count_,
+                  positions_.begin());
+
+        return *this;
+    }
+
+    // Accessors
+    size_t size(void) const { return count_; }
+    bool empty(void) const { return count_ == 0; }
+    static size_t capacity(void) { return MAX_POSITIONS; }
+
+    Position2D &operator[](const size_t i) { return positions_[i]; }
+    const Position2D &operator[](const size_t i) const { return positions_[i]; }
+    uint32_t id(const size_t i) const { return ids_[i]; }
+
+    Position2D *begin() { return positions_.data(); }
+    Position2D *end() { return positions_.data() + count_; }
+    const Position2D *begin() const { return positions_.data(); }
+    const Position2D *end() const { return positions_.data() + count_; }
+
+    /**
+     * @brief Append a target's position to the list.
+     * @param p Position of the target.
+     * @param id ID of the target.
+     */
+    void push_back(const Position2D &p, const uint32_t id)
+    {
+        if (count_ == MAX_POSITIONS)
+            throw std::runtime_error("Position lists hold at most "
+                                     + std::to_string(MAX_POSITIONS)
+                                     + " positions.");
+
+        ids_[count_] = id;
+        positions_[count_] = p;
+        count_++;
+    }
+
+    void clear(void)
+    {
+        reset(0, count_);
+        count_ = 0;
+    }
+
+    // Set sample rate
+    void set_sample(const Sample &val) { sample_ = val; }
+    void set_rate_hz(const double rate_hz) { sample_.set_rate_hz(rate_hz); }
+    double sample_period_sec() const { return sample_.period_sec().count(); }
+    uint64_t sample_count(void) const { return sample_.count(); }
+    uint64_t sample_usec(void) const { return sample_.microseconds().count(); }
+    void incrementSampleCount() { sample_.incrementCount(); }
+    void incrementSampleCount(USec us) { sample_.incrementCount(us); }
+
+    // Sample, count, IDs, padding to align the positions, and positions
+    static constexpr size_t NPY_DTYPE_BYTES
+        {40 + 4 + MAX_POSITIONS * 4 + 4
+         + MAX_POSITIONS * Position2D::NPY_DTYPE_BYTES};
+    static const char NPY_DTYPE[];
+
+private:
+
+    // Return entries [from, to) to their defaults
+    void reset(const size_t from, const size_t to)
+    {
+        for (size_t i = from; i < std::min(to, static_cast<size_t>(MAX_POSITIONS)); i++) {
+            ids_[i] = 0;
+            positions_[i] = Position2D();
+        }
+    }
+
+    oat::Sample sample_;
+
+    uint32_t count_ {0}; //!< Number of valid positions
+    std::array<uint32_t, MAX_POSITIONS> ids_ {{0}};
+    std::array<Position2D, MAX_POSITIONS> positions_;
+};
+
+static_assert(std::is_standard_layout<PositionList>::value,
+              "PositionList must be laid out as a plain record.");
+static_assert(sizeof(PositionList) == PositionList::NPY_DTYPE_BYTES,
+              "PositionList::NPY_DTYPE must describe PositionList's layout.");
+
+/**
+ * @brief Label and coordinate system of the lists published to a node. All
+ * positions in a list share them.
+ */
+template <>
+struct Metadata<PositionList> : Metadata<Position2D> {
+    using Metadata<Position2D>::Metadata;
+    Metadata() = default;
+};
+
+/**
+ * @brief JSON Serializer
+ *
+ * @param writer Writer to use for serialization
+ * @param verbose Passed to the serializer of each position.
+ */
+template <typename Writer>
+void serializePosition(const PositionList &l, Writer &writer, bool verbose)
+{
+    writer.StartObject();
+
+    // Sample number
+    writer.String("tick");
+    writer.Uint64(l.sample_count());
+
+    writer.String("usec");
+    writer.Uint64(l.sample_usec());
+
+    // Target IDs
+    writer.String("ids");
+    writer.StartArray();
+    for (size_t i = 0; i < l.size(); i++)
+        writer.Uint(l.id(i));
+    writer.EndArray(l.size());
+
+    // Positions, in the same order as their IDs
+    writer.String("positions");
+    writer.StartArray();
+    for (const auto &p : l)
+        serializePosition(p, writer, verbose);
+    writer.EndArray(l.size());
+
+    writer.EndObject();
+}
+
+}      /* namespace oat */
+#endif /* OAT_POSITIONLIST_H */
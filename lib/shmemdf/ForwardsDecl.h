@@ -23,11 +23,13 @@
 #include <boost/interprocess/interprocess_fwd.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
+#include "Segment.h"
+
 namespace oat {
 
 namespace bip = boost::interprocess;
 
-using shmem_t = bip::managed_shared_memory;
+using shmem_t = oat::Segment;
 using handle_t = bip::managed_shared_memory::handle_t;
 using msec_t = boost::posix_time::milliseconds;
 
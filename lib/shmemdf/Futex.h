@@ -0,0 +1,90 @@
+//******************************************************************************
+//* File:   Futex.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FUTEX_H
+#define	OAT_FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace oat {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Futex words must be plain 32-bit integers.");
+
+/**
+ * @brief Block until the value of word differs from expected, futexWake() is
+ * called on word, or timeout elapses. Spurious returns are possible so the
+ * caller must re-check whatever condition it is waiting on. Because the
+ * non-private futex operations are used, word may live in shared memory and
+ * be waited on and woken from different processes.
+ *
+ * On platforms without futexes, this falls back to a short sleep.
+ *
+ * @param word Futex word.
+ * @param expected Value of word that was observed before the caller checked
+ * its wait condition.
+ * @param timeout Maximum time to block.
+ */
+inline void futexWait(std::atomic<uint32_t> &word,
+                      const uint32_t expected,
+                      const std::chrono::milliseconds timeout)
+{
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeout.count() / 1000;
+    ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT,
+            expected, &ts, nullptr, 0);
+#else
+    if (word.load() == expected)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    (void)timeout;
+#endif
+}
+
+/**
+ * @brief Wake threads, in any process, that are blocked in futexWait() on
+ * word.
+ * @param word Futex word.
+ * @param count Maximum number of waiters to wake.
+ */
+inline void futexWake(std::atomic<uint32_t> &word, const int count = INT_MAX)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE,
+            count, nullptr, nullptr, 0);
+#else
+    (void)word;
+    (void)count;
+#endif
+}
+
+}       /* namespace oat */
+#endif	/* OAT_FUTEX_H */
@@ -20,14 +20,27 @@
 #ifndef OAT_NODE_H
 #define	OAT_NODE_H
 
-#include <iostream>
 #include <array>
 #include <atomic>
 #include <bitset>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <limits>
+#include <stdexcept>
 #include <string>
-#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <thread>
+#include <typeinfo>
+
+#include <signal.h>
+#include <unistd.h>
 
 #include "ForwardsDecl.h"
+#include "Futex.h"
+#include "Segment.h"
+#include "SourcePolicy.h"
+#include "Telemetry.h"
+#include "Trace.h"
 
 namespace oat {
 
@@ -38,150 +51,892 @@ enum class NodeState {
     ERROR = 2
 };
 
+/**
+ * @brief Synchronization and bookkeeping for a single SINK and up to
+ * NUM_SLOTS SOURCEs that share a ring of depth() objects.
+ *
+ * None of the per-sample operations take a lock. Which SOURCEs must read each
+ * buffer is held in an atomic bitmask. The SINK may write the next buffer once
+ * its mask is empty. A SOURCE may read once the SINK's write count has passed
+ * its own read cursor. Blocking is done by futex waits on two sequence words,
+ * one bumped when the SINK publishes and one bumped when a buffer is
+ * released, so hand-off does not depend on polling. SOURCE slot changes, which
+ * are rare, are serialized by a seqlock that the SINK checks when it
+ * publishes.
+ *
+ * Per-SOURCE state is held in a contiguous table of NUM_SLOTS entries, each
+ * aligned to a cache line so that SOURCEs reading in parallel do not contend.
+ * For this to hold, the Node must be found or constructed with
+ * findOrConstructNode(), which allocates it at cache line alignment.
+ * Publishing a sample costs the same regardless of how many SOURCEs are
+ * connected.
+ *
+ * SOURCEs that hold a slot may choose not to read every sample (see
+ * SourcePolicy). When the SINK publishes, it only marks such a SOURCE as
+ * required to read the buffer if its policy takes that sample, so that slow
+ * consumers, like a viewer, do not hold up the SINK for samples they skip.
+ *
+ * SOURCEs that only want the newest sample do not take a slot. Instead, each
+ * buffer has a sequence number that is odd while the SINK writes it. These
+ * SOURCEs copy the newest buffer and retry if the number changed.
+ *
+ * The node also keeps telemetry for tools such as oat-top: how long the SINK
+ * waits for a free buffer, how long each SOURCE holds the buffers it reads,
+ * and when each last wrote or read. Each counter has a single writer and
+ * can be read by anyone at any time, so observing a node never blocks it.
+ *
+ * Each slot records the process that owns it and a heartbeat that its SOURCE
+ * updates while it waits and when it reads. A SINK that is held up checks
+ * these and evicts SOURCEs whose process has died, or that have held a
+ * buffer for longer than the node's source timeout, so a crashed or hung
+ * consumer cannot stall the SINK. Likewise, SOURCEs waiting on a SINK whose
+ * process has died see the END of the stream.
+ */
 class Node {
 public:
 
-    using semaphore = bip::interprocess_semaphore;
+    // Assumed cache line size, to which the Node and the entries of its
+    // per-SOURCE and per-buffer tables are aligned
+    static constexpr size_t CACHE_LINE {64};
 
     Node()
     {
-        source_slots_.reset();
-        source_read_required_.reset();
+        for (auto &e : entries_) {
+            e.read_required = 0;
+            e.write_seq = 0;
+        }
+        for (auto &s : slots_) {
+            s.read_number = NOT_JOINED;
+            s.read_start_ns = 0;
+            s.last_read_ns = 0;
+            s.owner_pid = 0;
+            s.heartbeat_ns = 0;
+            s.lease = 0;
+            s.reads = 0;
+            s.stride = 1;
+            s.phase = 0;
+        }
+        for (auto &t : traces_)
+            t.stages = 0;
     }
 
-    // Nodes are movable
-    Node(Node&&) = default;
-    Node & operator=(Node&&) = default;
-
     // Nodes are not copyable
     Node(const Node &) = delete;
     Node & operator=(const Node &) = delete;
 
-    // SINK state
-    void set_sink_state(NodeState value) { sink_state_ = value; }
+    // SINK state. The process that binds the SINK is recorded so that
+    // SOURCEs can tell if it dies.
+    void set_sink_state(NodeState value)
+    {
+        if (value == NodeState::SINK_BOUND)
+            sink_pid_ = static_cast<uint64_t>(getpid());
+
+        sink_state_ = value;
+
+        // Wake everyone so they can react to the change
+        wake(write_seq_, sources_waiting_);
+        wake(release_seq_, sink_waiting_);
+    }
     NodeState sink_state(void) const { return sink_state_; }
 
     // SINK writes (~sample number)
-    // TODO: write_number_ being atomic is redundant because only one sink can
-    //       be bound to a node, right?
     uint64_t write_number() const { return write_number_; }
 
-    void notifySinkWriteComplete()
+    // Number of samples held by the node
+    static constexpr size_t MAX_DEPTH {32};
+
+    /**
+     * @brief Set the number of samples the SINK can write ahead of the
+     * slowest SOURCE. Must be called by the SINK before it is bound.
+     * @param depth Number of shared objects in the node's ring buffer.
+     */
+    void set_depth(const size_t depth)
     {
-        mutex_.wait();
+        if (depth == 0 || depth > MAX_DEPTH)
+            throw std::runtime_error("Node depth must be between 1 and "
+                                     + std::to_string(MAX_DEPTH) + ".");
 
-        // Require one read from all connected sources
-        source_read_required_ = source_slots_;
+        depth_ = depth;
+    }
+    size_t depth(void) const { return depth_; }
+
+    /**
+     * @brief Set how long a SOURCE may hold a buffer that the SINK is waiting
+     * for before it is evicted. SOURCEs whose process has died are evicted
+     * regardless.
+     * @param timeout Timeout. Zero disables eviction of live SOURCEs.
+     */
+    void set_source_timeout(const std::chrono::milliseconds timeout)
+    {
+        source_timeout_ns_ = std::chrono::duration_cast<
+            std::chrono::nanoseconds>(timeout).count();
+    }
 
-        // Tell each source connected to the node that it may read
-        for (size_t i = 0; i < source_slots_.size(); i++)
-            if (source_slots_[i])
-                read_barrier(i).post();
+    // Index of the buffer that the SINK will write next
+    size_t write_index(void) const { return write_number_ % depth_; }
+
+    // True if all SOURCEs have finished reading the buffer at write_index()
+    bool writeBufferFree(void) const
+    {
+        return entries_[write_index()].read_required == 0;
+    }
+
+    /**
+     * @brief Publish the buffer that the SINK just wrote to all connected
+     * SOURCEs.
+     * @return True if at least one SOURCE is required to read the buffer.
+     */
+    bool notifySinkWriteComplete()
+    {
+        const uint64_t n = write_number_;
+        auto &entry = entries_[n % depth_];
+        auto &required = entry.read_required;
+        uint64_t slots;
+
+        // SOURCEs that touched since the last write start with this one. This
+        // is rare, so take the lock rather than loop over the table on every
+        // write.
+        if (joining_slots_ != 0) {
+            lockSlots();
+            const uint64_t joining = joining_slots_;
+            for (size_t i = 0; i < NUM_SLOTS; i++) {
+                if (joining & bit(i))
+                    join(i, n);
+            }
+            joining_slots_ = 0;
+            unlockSlots();
+        }
+
+        // Retry if a SOURCE joined or left while we were reading the slots.
+        // Dropping SOURCEs that were handed this sample keep it across
+        // retries, as long as they are still bound.
+        uint64_t handed = 0;
+        uint32_t seq;
+        do {
+            while ((seq = slot_seq_) & 1)
+                std::this_thread::yield();
+
+            // SOURCEs that touched in the meantime start with the next write
+            const uint64_t joined = source_slots_ & ~joining_slots_;
+            const uint64_t selective = selective_slots_;
+            slots = joined & ~selective;
+
+            // SOURCEs that skip samples must be asked if they take this one
+            if (selective != 0) {
+                handed |= handOut(n);
+                slots |= (handed | strided(selective, n)) & joined;
+            }
+
+            required = slots;
+
+        } while (slot_seq_ != seq);
+
+        sink_stats_.last_write_ns.store(steadyNanoseconds(),
+                                        std::memory_order_relaxed);
+
+        // End the write for latest-sample SOURCEs
+        if (entry.write_seq & 1)
+            ++entry.write_seq;
 
         ++write_number_;
 
-        mutex_.post();
+        // Tell each source connected to the node that it may read
+        wake(write_seq_, sources_waiting_);
+
+        return slots != 0;
+    }
+
+    /**
+     * @brief Block the SINK until writeBufferFree() or quit is set.
+     * @param quit Quit flag to observe.
+     * @param waited_ns If not null, set to the time spent blocked.
+     * @return True if the SINK may write.
+     */
+    bool waitWriteBufferFree(const volatile sig_atomic_t &quit,
+                             uint64_t *waited_ns = nullptr)
+    {
+        ++sink_waiting_;
+
+        bool rc = false;
+        uint64_t start_ns = 0, checked_ns = 0;
+        while (!quit) {
+            uint32_t seq = release_seq_;
+            if (writeBufferFree()) {
+                rc = true;
+                break;
+            }
+
+            // The ring is full and a SOURCE is holding up the SINK
+            const uint64_t now = steadyNanoseconds();
+            if (start_ns == 0) {
+                start_ns = checked_ns = now;
+                bump(sink_stats_.overruns);
+            }
+
+            // Make sure that whoever is holding us up is still there
+            if (now - checked_ns >= LIVENESS_CHECK_NS) {
+                checked_ns = now;
+                if (evictStaleSources() > 0)
+                    continue;
+            }
+
+            futexWait(release_seq_, seq, wake_timeout());
+        }
+
+        --sink_waiting_;
+
+        const uint64_t waited = start_ns ? steadyNanoseconds() - start_ns : 0;
+        if (rc)
+            sink_stats_.wait.record(waited);
+        if (waited_ns)
+            *waited_ns = waited;
+
+        // Begin the write for latest-sample SOURCEs, which do not hold the
+        // buffer and might be reading it
+        auto &entry = entries_[write_index()];
+        if (rc && !(entry.write_seq & 1))
+            ++entry.write_seq;
+
+        return rc;
     }
 
-    // SOURCE read counting
-    bool notifySourceReadComplete(size_t index)
+    // True if the SINK has published the buffer at read_index(index)
+    bool readBufferReady(size_t index) const
     {
-        mutex_.wait();
+        uint64_t n = read_number(index);
+        return n != NOT_JOINED && write_number_ > n;
+    }
 
-        source_read_required_[index] = false;
-        bool reads_finished = source_read_required_.none();
+    /**
+     * @brief Block a SOURCE until readBufferReady(), the SINK leaves, the
+     * SOURCE is evicted, or quit is set.
+     * @param index SOURCE slot index.
+     * @param lease Lease under which the SOURCE holds the slot.
+     * @param quit Quit flag to observe.
+     * @return True if the SOURCE may read.
+     */
+    bool waitReadBufferReady(size_t index, uint64_t lease,
+                             const volatile sig_atomic_t &quit)
+    {
+        ++sources_waiting_;
+
+        auto &slot = slots_[index];
+        bool rc = false;
+        uint64_t checked_ns = steadyNanoseconds();
+        while (!quit) {
+            uint32_t seq = write_seq_;
+            if (!enterSlot(index, lease))
+                break;
+            const uint64_t now = steadyNanoseconds();
+            slot.heartbeat_ns.store(now, std::memory_order_relaxed);
+            const bool ready = readBufferReady(index);
+            if (ready)
+                slot.read_start_ns.store(now, std::memory_order_relaxed);
+            exitSlot(index, lease);
+            if (ready) {
+                rc = true;
+                break;
+            }
+            if (sink_state_ == NodeState::END)
+                break;
+            if (now - checked_ns >= LIVENESS_CHECK_NS) {
+                checked_ns = now;
+                if (sinkDied())
+                    break;
+            }
+            futexWait(write_seq_, seq, wake_timeout());
+        }
 
-        mutex_.post();
+        --sources_waiting_;
+        return rc;
+    }
 
-        return reads_finished;
+    /**
+     * @brief Block a latest-sample SOURCE, which does not hold a slot, until
+     * the SINK has published more than n samples, the SINK leaves, or quit
+     * is set.
+     * @param n Number of samples published when the SOURCE last read.
+     * @param quit Quit flag to observe.
+     * @return True if there is a sample the SOURCE has not seen.
+     */
+    bool waitWriteNumber(const uint64_t n, const volatile sig_atomic_t &quit)
+    {
+        ++sources_waiting_;
+
+        bool rc = false;
+        uint64_t checked_ns = steadyNanoseconds();
+        while (!quit) {
+            uint32_t seq = write_seq_;
+            if (write_number_ > n) {
+                rc = true;
+                break;
+            }
+            if (sink_state_ == NodeState::END)
+                break;
+            const uint64_t now = steadyNanoseconds();
+            if (now - checked_ns >= LIVENESS_CHECK_NS) {
+                checked_ns = now;
+                if (sinkDied())
+                    break;
+            }
+            futexWait(write_seq_, seq, wake_timeout());
+        }
+
+        --sources_waiting_;
+        return rc;
     }
 
-    // SOURCE slots
-    static constexpr size_t NUM_SLOTS {10};
+    /**
+     * @brief Start reading a buffer without holding it. The read must be
+     * checked using endLatestRead() and retried if the SINK wrote the buffer
+     * in the meantime.
+     * @param entry Ring buffer entry.
+     * @return Sequence number to pass to endLatestRead().
+     */
+    uint32_t beginLatestRead(const size_t entry) const
+    {
+        uint32_t seq;
+        while ((seq = entries_[entry].write_seq) & 1)
+            std::this_thread::yield();
+        return seq;
+    }
 
-    int acquireSlot(size_t &index)
+    // True if the read started by beginLatestRead() was not torn
+    bool endLatestRead(const size_t entry, const uint32_t seq) const
     {
-        mutex_.wait();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return entries_[entry].write_seq == seq;
+    }
 
-        if (source_slots_.all()) {
-            mutex_.post();
+    /**
+     * @brief Finish a SOURCE's read of the buffer at read_index(index) and
+     * advance it to the next sample it reads.
+     * @param index SOURCE slot index.
+     * @param lease Lease under which the SOURCE holds the slot.
+     * @return 1 if the SOURCE was the last one required to read the buffer,
+     * 0 if it was not, or -1 if the slot is no longer held under lease.
+     */
+    int notifySourceReadComplete(size_t index, uint64_t lease)
+    {
+        // Checking the lease and then reading would let an eviction slip in
+        // between and the read be counted against the slot's next owner
+        if (!enterSlot(index, lease))
+            return -1;
+
+        const uint64_t b = bit(index);
+        auto &required = entries_[read_index(index)].read_required;
+        uint64_t prev = required.fetch_and(~b);
+        bool reads_finished = (prev & b) && (prev & ~b) == 0;
+
+        auto &slot = slots_[index];
+        const uint64_t now = steadyNanoseconds();
+        const uint64_t start = slot.read_start_ns.load(std::memory_order_relaxed);
+        if (start != 0) {
+            slot.hold.record(now - start);
+            slot.read_start_ns.store(0, std::memory_order_relaxed);
+        }
+        slot.last_read_ns.store(now, std::memory_order_relaxed);
+        slot.heartbeat_ns.store(now, std::memory_order_relaxed);
+        bump(slot.reads);
+
+        // Dropping SOURCEs wait for the SINK to hand them another sample
+        const uint32_t stride = slot.stride;
+        if (stride == DROP_STRIDE) {
+            slot.read_number = BETWEEN_READS;
+            due_slots_ |= b;
+        } else {
+            slot.read_number += stride;
+        }
+
+        exitSlot(index, lease);
+
+        // Tell the sink it can write to this buffer
+        if (reads_finished)
+            wake(release_seq_, sink_waiting_);
+
+        return reads_finished ? 1 : 0;
+    }
+
+    // Samples read by a SOURCE and index of the buffer it will read next
+    uint64_t read_number(size_t index) const
+    {
+        if (index >= NUM_SLOTS || !(source_slots_ & bit(index)))
+            throw std::runtime_error("Requested index refers to a SOURCE "
+                                     "that is not bound to this node.");
+
+        return slots_[index].read_number;
+    }
+    size_t read_index(size_t index) const { return read_number(index) % depth_; }
+
+    // Samples read by a SOURCE, whatever its policy
+    uint64_t read_count(size_t index) const { return slots_.at(index).reads; }
+
+    // SOURCE slots. Limited by the width of the slot masks.
+    static constexpr size_t NUM_SLOTS {64};
+
+    /**
+     * @brief Acquire a SOURCE slot. The SOURCE starts reading at the next
+     * write.
+     * @param index Acquired slot index.
+     * @param policy Which samples the SOURCE reads.
+     * @return 0 on success, -1 if all slots are taken.
+     */
+    int acquireSlot(size_t &index, const SourcePolicy &policy = SourcePolicy())
+    {
+        lockSlots();
+
+        uint64_t slots = source_slots_;
+        if (slots == ALL_SLOTS) {
+            unlockSlots();
             return -1;
         }
 
         index = 0;
-        while (source_slots_[index])
+        while (slots & bit(index))
             ++index;
 
-        source_slots_[index] = true;
-        source_ref_count_ = source_slots_.count();
-
-        mutex_.post();
+        // New SOURCEs start reading at the next write
+        auto &slot = slots_[index];
+        slot.read_number = NOT_JOINED;
+        slot.read_start_ns = 0;
+        slot.last_read_ns = 0;
+        slot.owner_pid = static_cast<uint64_t>(getpid());
+        slot.heartbeat_ns = steadyNanoseconds();
+        ++slot.lease;
+        slot.reads = 0;
+        slot.stride = policy.kind == SourcePolicy::DROP ? DROP_STRIDE : policy.n;
+        slot.phase = 0;
+        slot.hold.clear();
+        if (slot.stride != 1)
+            selective_slots_ |= bit(index);
+        joining_slots_ |= bit(index);
+        source_slots_ |= bit(index);
+
+        unlockSlots();
 
         return 0;
     }
 
+    /**
+     * @brief Release a SOURCE slot.
+     * @param index Slot index to release.
+     * @return Number of buffers that were freed because the released SOURCE
+     * was the last one required to read them, or -1 if index is invalid.
+     */
     int releaseSlot(size_t index)
     {
-        if (index >= source_slots_.size())
+        if (index >= NUM_SLOTS)
             return -1;
 
-        mutex_.wait();
-        source_slots_[index] = false;
-        source_ref_count_ = source_slots_.count();
-        mutex_.post();
+        lockSlots();
+        int freed = freeSlot(index);
+        unlockSlots();
 
-        return 0;
+        // The SINK might have been waiting on us or might need to see that
+        // the room is empty
+        wake(release_seq_, sink_waiting_);
+
+        return freed;
+    }
+
+    /**
+     * @brief Release a SOURCE slot, but only if it is still held under the
+     * given lease, i.e. it has not been evicted and taken by another SOURCE
+     * since.
+     * @param index Slot index to release.
+     * @param lease Lease returned by lease() when the slot was acquired.
+     * @return Number of buffers that were freed, or -1 if index is invalid
+     * or the slot is no longer held under lease.
+     */
+    int releaseSlot(size_t index, uint64_t lease)
+    {
+        if (index >= NUM_SLOTS)
+            return -1;
+
+        // Moving the lease on stops the old owner from entering the slot
+        // again. A slot its SOURCE is busy updating is not released.
+        lockSlots();
+        uint64_t expected = lease;
+        int freed = (source_slots_ & bit(index)) && !(lease & LEASE_BUSY)
+                    && slots_[index].lease.compare_exchange_strong(expected,
+                                                                   lease + 1)
+                    ? freeSlot(index) : -1;
+        unlockSlots();
+
+        if (freed >= 0)
+            wake(release_seq_, sink_waiting_);
+
+        return freed;
     }
 
-    size_t source_ref_count(void) const { return source_ref_count_; }
+    // Lease under which a SOURCE holds its slot. Changes each time the slot
+    // is acquired.
+    uint64_t lease(size_t index) const { return slots_.at(index).lease; }
 
-    // Synchronization constructs
-    // write _always_ occurs before read. By starting at 1, the writer is not
-    // blocked by an initial wait. Readers to do not post to the write_barrier
-    // until a write occurs.
-    semaphore write_barrier {1};
+    // True if the slot is still held under lease
+    bool ownsSlot(size_t index, uint64_t lease) const
+    {
+        return (source_slots_ & bit(index)) && slots_[index].lease == lease;
+    }
 
-    // This method is required because an std::array of semaphores requires
-    // each semaphore to be copy-constructed to initialized the array.
-    // Because of their nature, semaphores are NOT copy constructable, so
-    // this approach does not work.
-    semaphore &read_barrier(size_t index)
+    /**
+     * @brief Evict SOURCEs whose process has died, and, if a source timeout
+     * is set, SOURCEs that have held the buffer the SINK needs next for
+     * longer than it. The buffers they held are returned to the SINK.
+     * @return Number of SOURCEs evicted.
+     */
+    int evictStaleSources(void)
     {
-        if (!source_slots_[index])
-            throw std::runtime_error("Requested index refers to a SOURCE "
-                                     "that is not bound to this node.");
+        const uint64_t slots = source_slots_;
+        const uint64_t holders = entries_[write_index()].read_required;
+        const uint64_t timeout = source_timeout_ns_;
+        const uint64_t now = steadyNanoseconds();
+
+        int evicted = 0;
+        for (size_t i = 0; i < NUM_SLOTS; i++) {
+
+            if (!(slots & bit(i)))
+                continue;
+
+            auto &slot = slots_[i];
+            const uint64_t lease = slot.lease;
+            const uint64_t beat = slot.heartbeat_ns;
+            const bool hung = timeout > 0 && (holders & bit(i))
+                              && now > beat && now - beat > timeout;
+
+            if ((hung || !processAlive(slot.owner_pid))
+                && releaseSlot(i, lease) >= 0) {
+                bump(sink_stats_.evictions);
+                evicted++;
+            }
+        }
 
-        switch (index) {
-            case 0: return rb0_; break;
-            case 1: return rb1_; break;
-            case 2: return rb2_; break;
-            case 3: return rb3_; break;
-            case 4: return rb4_; break;
-            case 6: return rb6_; break;
-            case 7: return rb7_; break;
-            case 8: return rb8_; break;
-            case 9: return rb9_; break;
+        return evicted;
+    }
+
+    /**
+     * @brief Check if the node was left behind by components that crashed:
+     * either its SINK died while bound, or its SINK has left and every SOURCE
+     * that still held a slot has died. Dead SOURCEs are evicted.
+     * @return True if nobody is using the node and it can be removed.
+     */
+    bool abandoned(void)
+    {
+        switch (sink_state_.load()) {
+            case NodeState::SINK_BOUND:
+                return !processAlive(sink_pid_);
+            case NodeState::END:
+                evictStaleSources();
+                return source_slots_ == 0;
             default:
-                throw std::runtime_error("Source index out of range.");
-                break;
+                return false;
         }
     }
 
+    size_t source_ref_count(void) const
+    {
+        return std::bitset<NUM_SLOTS>(source_slots_).count();
+    }
+
+    // Mask of SOURCE slots in use
+    uint64_t source_slot_mask(void) const { return source_slots_; }
+
+    // Telemetry. Safe to read from any process while the node is in use.
+    const LatencyHistogram &sink_wait(void) const { return sink_stats_.wait; }
+    uint64_t overruns(void) const { return sink_stats_.overruns; }
+    uint64_t evictions(void) const { return sink_stats_.evictions; }
+    uint64_t last_write_ns(void) const { return sink_stats_.last_write_ns; }
+    const LatencyHistogram &read_hold(size_t index) const
+    {
+        return slots_.at(index).hold;
+    }
+    uint64_t last_read_ns(size_t index) const
+    {
+        return slots_.at(index).last_read_ns;
+    }
+
+    // Latency trace of the sample in a ring buffer entry. Written by the SINK
+    // while it writes the entry, so it is read like the sample itself.
+    Trace &trace(size_t entry) { return traces_[entry]; }
+    const Trace &trace(size_t entry) const { return traces_[entry]; }
+
 private:
 
+    // Longest time any wait blocks before re-checking the quit flag, which
+    // is set from a signal handler and cannot wake anyone itself
+    static std::chrono::milliseconds wake_timeout(void)
+    {
+        return std::chrono::milliseconds(100);
+    }
+
+    // How often a blocked SINK or SOURCE checks that its counterparts are
+    // still alive
+    static constexpr uint64_t LIVENESS_CHECK_NS {100000000};
+
+    // True unless the process is known to have exited. Zero means unknown.
+    static bool processAlive(const uint64_t pid)
+    {
+        return pid == 0 || kill(static_cast<pid_t>(pid), 0) == 0
+               || errno != ESRCH;
+    }
+
+    // If the SINK's process has died while bound, end the stream on its
+    // behalf
+    bool sinkDied(void)
+    {
+        if (sink_state_ != NodeState::SINK_BOUND || processAlive(sink_pid_))
+            return false;
+
+        set_sink_state(NodeState::END);
+        return true;
+    }
+
+    // Set while a SOURCE updates its slot outside the slot lock
+    static constexpr uint64_t LEASE_BUSY {uint64_t(1) << 63};
+
+    // Mark a slot busy for the duration of an update by its SOURCE, so that
+    // it cannot be released under it. False if the slot is no longer held
+    // under lease.
+    bool enterSlot(size_t index, uint64_t lease)
+    {
+        uint64_t expected = lease;
+        return slots_[index].lease.compare_exchange_strong(expected,
+                                                           lease | LEASE_BUSY);
+    }
+    void exitSlot(size_t index, uint64_t lease) { slots_[index].lease = lease; }
+
+    // Release a slot. The slot lock must be held.
+    int freeSlot(size_t index)
+    {
+        const uint64_t b = bit(index);
+
+        int freed = 0;
+        for (auto &e : entries_) {
+            uint64_t prev = e.read_required.fetch_and(~b);
+            if ((prev & b) && (prev & ~b) == 0)
+                freed++;
+        }
+
+        joining_slots_ &= ~b;
+        selective_slots_ &= ~b;
+        due_slots_ &= ~b;
+        source_slots_ &= ~b;
+        slots_[index].read_number = NOT_JOINED;
+
+        return freed;
+    }
+
+    static constexpr uint64_t NOT_JOINED {std::numeric_limits<uint64_t>::max()};
+    static constexpr uint64_t BETWEEN_READS {NOT_JOINED - 1};
+    static constexpr uint32_t DROP_STRIDE {0};
+    static_assert(NUM_SLOTS <= 64, "Slot masks are 64 bits wide.");
+    static constexpr uint64_t ALL_SLOTS {NUM_SLOTS == 64
+                                         ? ~uint64_t(0)
+                                         : (uint64_t(1) << NUM_SLOTS) - 1};
+
+    // Ring buffer entry. Modified by the SINK and every SOURCE.
+    struct alignas(CACHE_LINE) Entry {
+        std::atomic<uint64_t> read_required; //!< SOURCEs yet to read
+        std::atomic<uint32_t> write_seq; //!< Odd while the SINK writes
+    };
+    static_assert(sizeof(Entry) == CACHE_LINE,
+                  "Ring buffer entries must fill exactly one cache line.");
+
+    // SOURCE slot. Only modified by its SOURCE, except when it joins or is
+    // handed a sample.
+    struct alignas(CACHE_LINE) Slot {
+        std::atomic<uint64_t> read_number; //!< Read cursor
+        std::atomic<uint64_t> read_start_ns; //!< When the current read began
+        std::atomic<uint64_t> last_read_ns; //!< When the last read finished
+        std::atomic<uint64_t> owner_pid; //!< Process holding the slot
+        std::atomic<uint64_t> heartbeat_ns; //!< When the SOURCE last waited or read
+        std::atomic<uint64_t> lease; //!< Bumped each time the slot is acquired
+        std::atomic<uint64_t> reads; //!< Samples read
+        std::atomic<uint32_t> stride; //!< Samples per read, DROP_STRIDE to drop
+        std::atomic<uint32_t> phase; //!< Sample number modulo stride to read
+        LatencyHistogram hold; //!< Time from buffer ready to read complete
+    };
+    static_assert(sizeof(Slot) == CACHE_LINE + sizeof(LatencyHistogram),
+                  "SOURCE slot state must fill exactly one cache line.");
+
+    // Start a joining SOURCE's cursor at sample n. A dropping SOURCE is
+    // handed sample n like any other it becomes due for. The slot lock must
+    // be held.
+    void join(size_t index, const uint64_t n)
+    {
+        auto &slot = slots_[index];
+        const uint32_t stride = slot.stride;
+        if (stride == DROP_STRIDE) {
+            slot.read_number = BETWEEN_READS;
+            due_slots_ |= bit(index);
+        } else {
+            slot.read_number = n;
+            slot.phase = n % stride;
+        }
+    }
+
+    // Mask of the SOURCEs in selective that read every stride'th sample and
+    // whose phase is that of sample n
+    uint64_t strided(uint64_t selective, const uint64_t n) const
+    {
+        uint64_t takes = 0;
+        while (selective != 0) {
+            const size_t i = __builtin_ctzll(selective);
+            selective &= selective - 1;
+            const uint32_t stride = slots_[i].stride;
+            if (stride != DROP_STRIDE && n % stride == slots_[i].phase)
+                takes |= bit(i);
+        }
+        return takes;
+    }
+
+    // Hand sample n to the dropping SOURCEs that have released their last
+    // sample, moving their cursor to it. A SOURCE whose slot was released, or
+    // released and taken again, since it became due is left alone.
+    uint64_t handOut(const uint64_t n)
+    {
+        uint64_t due = due_slots_.exchange(0);
+        uint64_t handed = 0;
+        while (due != 0) {
+            const size_t i = __builtin_ctzll(due);
+            due &= due - 1;
+            uint64_t cursor = BETWEEN_READS;
+            if (slots_[i].read_number.compare_exchange_strong(cursor, n))
+                handed |= bit(i);
+        }
+        return handed;
+    }
+
+    // SINK telemetry. Only modified by the SINK.
+    struct alignas(CACHE_LINE) SinkStats {
+        LatencyHistogram wait; //!< Time spent waiting for a free buffer
+        std::atomic<uint64_t> overruns {0}; //!< Writes that found the ring full
+        std::atomic<uint64_t> last_write_ns {0}; //!< When the last write finished
+        std::atomic<uint64_t> evictions {0}; //!< SOURCEs evicted by the SINK
+    };
+    static_assert(sizeof(LatencyHistogram) % CACHE_LINE == 0,
+                  "Telemetry must not share cache lines with hot state.");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+                  "Lock-free 64-bit atomics are required in shared memory.");
+
+    static uint64_t bit(size_t index) { return uint64_t(1) << index; }
+
+    // Bump a futex sequence word and wake anyone waiting on it. The syscall is
+    // skipped if nobody is waiting.
+    static void wake(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiting)
+    {
+        ++seq;
+        if (waiting > 0)
+            futexWake(seq);
+    }
+
+    void lockSlots(void)
+    {
+        uint32_t seq = slot_seq_;
+        while ((seq & 1) || !slot_seq_.compare_exchange_weak(seq, seq + 1)) {
+            std::this_thread::yield();
+            seq = slot_seq_;
+        }
+    }
+
+    void unlockSlots(void) { ++slot_seq_; }
+
     std::atomic<NodeState> sink_state_ {oat::NodeState::UNDEFINED}; //!< SINK state
-    //std::atomic<size_t> source_read_count_ {0}; //!< Number SOURCE reads that have occured since last sink reset
-    std::bitset<NUM_SLOTS> source_slots_;
-    std::bitset<NUM_SLOTS> source_read_required_;
+    std::atomic<uint64_t> sink_pid_ {0}; //!< Process that bound the SINK
+    std::atomic<uint64_t> source_slots_ {0}; //!< Mask of SOURCE slots in use
+    std::atomic<uint64_t> joining_slots_ {0}; //!< SOURCEs without a cursor
+    std::atomic<uint64_t> selective_slots_ {0}; //!< SOURCEs that skip samples
+    std::atomic<uint64_t> due_slots_ {0}; //!< Dropping SOURCEs that take the next sample
+
+    // One mask of required reads per buffer in the ring
+    std::array<Entry, MAX_DEPTH> entries_;
+
+    // Per-SOURCE read cursors and telemetry
+    std::array<Slot, NUM_SLOTS> slots_;
+
+    SinkStats sink_stats_;
+
+    // Latency trace of the sample in each buffer in the ring
+    std::array<Trace, MAX_DEPTH> traces_;
 
-    size_t source_ref_count_ {0}; //!< Number of SOURCES sharing this node
-    uint64_t write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
+    std::atomic<uint64_t> write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
+    size_t depth_ {1}; //!< Number of buffers in the ring
+    std::atomic<uint64_t> source_timeout_ns_ {0}; //!< Zero to never evict live SOURCEs
 
-    // Unfortunately, must manually maintain the number of rbx_'s to match NUM_SLOTS
-    semaphore mutex_ {1}; //!< mutex governing exclusive acces to the read_barrier_
-    semaphore rb0_ {0}, rb1_ {0}, rb2_ {0}, rb3_ {0}, rb4_ {0},
-              rb5_ {0}, rb6_ {0}, rb7_ {0}, rb8_ {0}, rb9_ {0};
+    // Seqlock governing changes to SOURCE slots. Odd while a change is in
+    // progress.
+    std::atomic<uint32_t> slot_seq_ {0};
+
+    // Futex words and waiter counts
+    std::atomic<uint32_t> write_seq_ {0};
+    std::atomic<uint32_t> release_seq_ {0};
+    std::atomic<uint32_t> sources_waiting_ {0};
+    std::atomic<uint32_t> sink_waiting_ {0};
 };
 
+// Every table entry starts a cache line as long as the Node does
+static_assert(alignof(Node) == Node::CACHE_LINE,
+              "The Node must be aligned to a cache line.");
+
+// Name of the handle to a node's Node in its segment
+inline const char *nodeName(void) { return typeid(Node).name(); }
+
+// Bytes needed for a node's segment. Extra 1024 bytes are used to hold
+// managed shared mem helper objects (name-object index, internal
+// synchronization objects, internal variables...), and a cache line to
+// align the Node.
+inline size_t nodeSegmentBytes(void)
+{
+    return 1024 + Node::CACHE_LINE + sizeof(Node);
+}
+
+/**
+ * @brief Find the Node in a node's segment, constructing it if it is not
+ * there yet. Named construction only offers 16-byte alignment, so the Node
+ * is allocated at cache line alignment and a handle to it is stored under
+ * nodeName(). Both happen under the segment's lock, so a SINK and SOURCE
+ * that race to create the node agree on a single Node.
+ * @param shmem The node's segment.
+ * @return The Node.
+ */
+inline Node *findOrConstructNode(Segment &shmem)
+{
+    using handle_t = Segment::handle_t;
+
+    Node *node = nullptr;
+    auto find_or_construct = [&shmem, &node] {
+
+        auto found = shmem.find<handle_t>(nodeName());
+        if (found.first) {
+            node = static_cast<Node *>(
+                shmem.get_address_from_handle(*found.first));
+            return;
+        }
+
+        void *p = shmem.allocate_aligned(sizeof(Node), Node::CACHE_LINE);
+        node = new (p) Node();
+        shmem.construct<handle_t>(nodeName())(shmem.get_handle_from_address(p));
+    };
+    shmem.atomic_func(find_or_construct);
+
+    return node;
+}
+
+/**
+ * @brief Find the Node in a node's segment without locking it, e.g. in a
+ * segment that was mapped read-only by a tool that observes the node.
+ * @param shmem The node's segment.
+ * @return The Node, or nullptr if it has not been constructed.
+ */
+template <typename Managed>
+const Node *findNode(Managed &shmem)
+{
+    auto found = shmem.template find_no_lock<Segment::handle_t>(nodeName());
+    if (!found.first)
+        return nullptr;
+    return static_cast<const Node *>(
+        shmem.get_address_from_handle(*found.first));
+}
+
 }       /* namespace oat */
 #endif	/* OAT_NODE_H */
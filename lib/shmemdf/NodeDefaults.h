@@ -0,0 +1,62 @@
+//******************************************************************************
+//* File:   NodeDefaults.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_NODEDEFAULTS_H
+#define	OAT_NODEDEFAULTS_H
+
+#include <chrono>
+#include <cstddef>
+
+#include "SourcePolicy.h"
+
+namespace oat {
+
+/**
+ * @brief Defaults used by SINKs and SOURCEs when they bind to or touch a node.
+ * These are set once, typically from common program options, before any node
+ * is created. They are per-thread so that components hosted as threads of a
+ * single process (see oat-run) can each have their own. A component must
+ * therefore set them on the thread that binds and touches its nodes.
+ */
+struct NodeDefaults {
+
+    // Number of samples a SINK can write ahead of its slowest SOURCE
+    size_t depth {1};
+
+    // Back shared object segments with huge pages, and prefault and lock
+    // them in RAM when they are bound or connected
+    bool pin_memory {false};
+
+    // How long a SOURCE may hold up a SINK before the SINK evicts it. Set
+    // from the source-timeout option, which is in seconds. Zero only evicts
+    // SOURCEs whose process has died.
+    std::chrono::milliseconds source_timeout {0};
+
+    // Which samples SOURCEs that hold a slot read
+    SourcePolicy source_policy;
+};
+
+inline NodeDefaults &nodeDefaults()
+{
+    static thread_local NodeDefaults defaults;
+    return defaults;
+}
+
+}       /* namespace oat */
+#endif	/* OAT_NODEDEFAULTS_H */
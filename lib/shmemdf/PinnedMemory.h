@@ -0,0 +1,114 @@
+//******************************************************************************
+//* File:   PinnedMemory.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PINNEDMEMORY_H
+#define	OAT_PINNEDMEMORY_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "ForwardsDecl.h"
+#include "NodeDefaults.h"
+
+namespace oat {
+
+// Size of a huge page on the platforms we care about
+static constexpr size_t HUGE_PAGE_BYTES {2 * 1024 * 1024};
+
+/**
+ * @brief Round a shared memory segment size up to a whole number of huge
+ * pages so that none of it has to be backed by small pages.
+ * @param bytes Requested segment size.
+ * @return Rounded segment size.
+ */
+inline size_t hugePageRound(const size_t bytes)
+{
+    return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+}
+
+/**
+ * @brief Ask the kernel to back a mapped shared memory segment with
+ * transparent huge pages, fault in all of its pages, and lock them in RAM so
+ * that later accesses neither fault nor get paged out.
+ *
+ * Huge pages are only used if the kernel permits them for shared memory
+ * (/sys/kernel/mm/transparent_hugepage/shmem_enabled is 'advise' or
+ * 'always'). Pages are prefaulted by reading them, so this is safe to call
+ * on a segment that another process is writing.
+ *
+ * @param shmem Mapped segment.
+ * @return True if the segment was locked in RAM. False if locking failed,
+ * most likely due to RLIMIT_MEMLOCK, in which case the segment is still
+ * prefaulted.
+ */
+inline bool pinSegment(shmem_t &shmem)
+{
+    char *addr = static_cast<char *>(shmem.get_address());
+    const size_t bytes = shmem.get_size();
+
+#ifdef __linux__
+#ifdef MADV_HUGEPAGE
+    madvise(addr, bytes, MADV_HUGEPAGE);
+#endif
+
+    // Locking faults in every page
+    if (mlock(addr, bytes) == 0)
+        return true;
+
+    const size_t page = sysconf(_SC_PAGESIZE);
+#else
+    const size_t page = 4096;
+#endif
+
+    volatile const char *p = addr;
+    for (size_t i = 0; i < bytes; i += page)
+        (void)p[i];
+
+    return false;
+}
+
+/**
+ * @brief Pin a node's shared memory segments using pinSegment() if
+ * oat::nodeDefaults().pin_memory is set.
+ * @param address Node address, for warnings.
+ * @param node_shmem Node segment.
+ * @param obj_shmem Shared object segment.
+ */
+inline void pinNodeSegments(const std::string &address,
+                            shmem_t &node_shmem,
+                            shmem_t &obj_shmem)
+{
+    if (!oat::nodeDefaults().pin_memory)
+        return;
+
+    bool locked = pinSegment(node_shmem);
+    locked &= pinSegment(obj_shmem);
+    if (!locked)
+        std::cerr << "Warning: shared memory at '" + address + "' could not "
+                     "be locked in RAM. Check RLIMIT_MEMLOCK (ulimit -l).\n";
+}
+
+}       /* namespace oat */
+#endif	/* OAT_PINNEDMEMORY_H */
@@ -0,0 +1,307 @@
+//******************************************************************************
+//* File:   Segment.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEGMENT_H
+#define	OAT_SEGMENT_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <boost/interprocess/anonymous_shared_memory.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/managed_external_buffer.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace oat {
+
+namespace bip = boost::interprocess;
+
+/**
+ * @brief Registry of the nodes that are private to this process. Their
+ * segments live in anonymous memory rather than in named shared memory, so
+ * they are invisible to, and cannot be attached by, other processes. This
+ * lets components that run as threads of a single process (see oat-run) talk
+ * through nodes without touching /dev/shm. By default no node is local, and
+ * nodes behave exactly as before.
+ */
+class LocalNodes {
+
+    friend class Segment;
+
+public:
+
+    /**
+     * @brief Make a node private to this process. Must be called before any
+     * SINK or SOURCE in this process binds or touches the node.
+     * @param address Node address.
+     */
+    void add(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        local_.insert(address + "_node");
+        local_.insert(address + "_obj");
+    }
+
+    /**
+     * @brief Keep a node in named shared memory even when nodes are local by
+     * default, so that other processes can attach to it.
+     * @param address Node address.
+     */
+    void publish(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        published_.insert(address + "_node");
+        published_.insert(address + "_obj");
+    }
+
+    /**
+     * @brief Make every node that has not been published local.
+     * @param local True to make unpublished nodes local by default.
+     */
+    void set_local_by_default(const bool local)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        local_by_default_ = local;
+    }
+
+    bool contains(const std::string &address) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return isLocal(address + "_node");
+    }
+
+private:
+
+    using Block = std::shared_ptr<bip::mapped_region>;
+
+    // Must be called with mutex_ held
+    bool isLocal(const std::string &name) const
+    {
+        if (published_.count(name))
+            return false;
+
+        return local_by_default_ || local_.count(name);
+    }
+
+    mutable std::mutex mutex_;
+    bool local_by_default_ {false};
+    std::set<std::string> local_, published_;
+    std::map<std::string, Block> blocks_; //!< Segments that currently exist
+};
+
+inline LocalNodes &localNodes()
+{
+    static LocalNodes nodes;
+    return nodes;
+}
+
+/**
+ * @brief Managed memory segment holding either half of a node: its Node or
+ * its shared objects. Backed by named shared memory unless the node was made
+ * local using oat::localNodes(), in which case it is backed by anonymous
+ * memory owned by this process. Either way, objects are constructed, found
+ * and addressed by handle in the same way, with the same semantics as
+ * bip::managed_shared_memory.
+ */
+class Segment {
+
+    // Shares its segment manager type, and therefore its thread safety, with
+    // bip::managed_shared_memory
+    using local_t = bip::basic_managed_external_buffer<
+        char, bip::rbtree_best_fit<bip::mutex_family>, bip::iset_index>;
+
+public:
+
+    using segment_manager = bip::managed_shared_memory::segment_manager;
+    using handle_t = bip::managed_shared_memory::handle_t;
+
+    Segment() = default;
+    Segment(Segment &&) = default;
+    Segment &operator=(Segment &&) = default;
+
+    Segment(bip::open_or_create_t, const std::string &name, const size_t bytes)
+    {
+        auto &nodes = localNodes();
+        std::lock_guard<std::mutex> lock(nodes.mutex_);
+
+        if (!nodes.isLocal(name)) {
+            shared_.reset(new bip::managed_shared_memory(
+                bip::open_or_create, name.c_str(), bytes));
+            attach(*shared_);
+        } else if (nodes.blocks_.count(name)) {
+            openLocal(nodes.blocks_[name]);
+        } else {
+            createLocal(nodes.blocks_[name], bytes);
+        }
+    }
+
+    Segment(bip::create_only_t, const std::string &name, const size_t bytes)
+    {
+        auto &nodes = localNodes();
+        std::lock_guard<std::mutex> lock(nodes.mutex_);
+
+        if (!nodes.isLocal(name)) {
+            shared_.reset(new bip::managed_shared_memory(
+                bip::create_only, name.c_str(), bytes));
+            attach(*shared_);
+        } else if (nodes.blocks_.count(name)) {
+            throw bip::interprocess_exception(
+                bip::error_info(bip::already_exists_error));
+        } else {
+            createLocal(nodes.blocks_[name], bytes);
+        }
+    }
+
+    Segment(bip::open_only_t, const std::string &name)
+    {
+        auto &nodes = localNodes();
+        std::lock_guard<std::mutex> lock(nodes.mutex_);
+
+        if (!nodes.isLocal(name)) {
+            shared_.reset(
+                new bip::managed_shared_memory(bip::open_only, name.c_str()));
+            attach(*shared_);
+        } else if (nodes.blocks_.count(name)) {
+            openLocal(nodes.blocks_[name]);
+        } else {
+            throw bip::interprocess_exception(
+                bip::error_info(bip::not_found_error));
+        }
+    }
+
+    /**
+     * @brief Remove a segment's name. As with shared memory, Segments that
+     * are already mapped remain valid until they are destroyed.
+     * @param name Segment name.
+     * @return True if the segment existed.
+     */
+    static bool remove(const std::string &name)
+    {
+        auto &nodes = localNodes();
+        std::lock_guard<std::mutex> lock(nodes.mutex_);
+
+        if (!nodes.isLocal(name))
+            return bip::shared_memory_object::remove(name.c_str());
+
+        return nodes.blocks_.erase(name) != 0;
+    }
+
+    bool local(void) const { return block_ != nullptr; }
+
+    // Mapped memory
+    void *get_address(void) const { return address_; }
+    size_t get_size(void) const { return size_; }
+
+    // Object construction and lookup, as in bip::managed_shared_memory
+    template <typename T>
+    typename segment_manager::template construct_proxy<T>::type
+    find_or_construct(const char *name)
+    {
+        return manager_->template find_or_construct<T>(name);
+    }
+
+    template <typename T>
+    typename segment_manager::template construct_proxy<T>::type
+    construct(const bip::ipcdetail::anonymous_instance_t *)
+    {
+        return manager_->template construct<T>(bip::anonymous_instance);
+    }
+
+    template <typename T>
+    std::pair<T *, size_t> find(const char *name)
+    {
+        return manager_->template find<T>(name);
+    }
+
+    template <typename T>
+    typename segment_manager::template construct_proxy<T>::type
+    construct(const char *name)
+    {
+        return manager_->template construct<T>(name);
+    }
+
+    // Call f while holding the segment's lock, which the named object
+    // functions above also take
+    template <typename Func>
+    void atomic_func(Func &f)
+    {
+        manager_->atomic_func(f);
+    }
+
+    void *allocate_aligned(const size_t bytes, const size_t alignment)
+    {
+        return manager_->allocate_aligned(bytes, alignment);
+    }
+
+    // Handles are offsets from the start of the segment, so they are valid in
+    // every thread or process that has the segment mapped
+    handle_t get_handle_from_address(const void *ptr) const
+    {
+        return static_cast<const char *>(ptr)
+               - static_cast<const char *>(address_);
+    }
+
+    void *get_address_from_handle(const handle_t handle) const
+    {
+        return static_cast<char *>(address_) + handle;
+    }
+
+private:
+
+    template <typename Managed>
+    void attach(Managed &m)
+    {
+        manager_ = m.get_segment_manager();
+        address_ = m.get_address();
+        size_ = m.get_size();
+    }
+
+    void createLocal(LocalNodes::Block &block, const size_t bytes)
+    {
+        block = std::make_shared<bip::mapped_region>(
+            bip::anonymous_shared_memory(bytes));
+        block_ = block;
+        local_.reset(new local_t(
+            bip::create_only, block_->get_address(), block_->get_size()));
+        attach(*local_);
+    }
+
+    void openLocal(const LocalNodes::Block &block)
+    {
+        block_ = block;
+        local_.reset(new local_t(
+            bip::open_only, block_->get_address(), block_->get_size()));
+        attach(*local_);
+    }
+
+    LocalNodes::Block block_; //!< Keeps local memory alive while mapped
+    std::unique_ptr<bip::managed_shared_memory> shared_;
+    std::unique_ptr<local_t> local_;
+
+    segment_manager *manager_ {nullptr};
+    void *address_ {nullptr};
+    size_t size_ {0};
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SEGMENT_H */
@@ -20,10 +20,17 @@
 #ifndef OAT_SHAREDFRAMEHEADER_H
 #define	OAT_SHAREDFRAMEHEADER_H
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <stdexcept>
+#include <string>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
 #include "../datatypes/Color.h"
+#include "../datatypes/Sample.h"
+
+#include "Node.h"
 
 namespace oat {
 namespace bip = boost::interprocess;
@@ -33,9 +40,34 @@ struct FrameParams {
     size_t rows  {0};
     int type  {0};
     oat::PixelColor color {oat::PIX_BGR};
-    size_t bytes {0};
+    size_t step {0}; //!< Bytes per row, including any padding
+    size_t bytes {0}; //!< rows * step
+    uint32_t generation {0}; //!< Incremented each time the SINK reshapes
 };
 
+// Alignment of each frame buffer's data in shared memory. Suitable for
+// aligned loads of the widest SIMD registers.
+static constexpr size_t FRAME_ALIGNMENT {64};
+
+// Round a size in bytes up to a multiple of FRAME_ALIGNMENT
+inline size_t alignFrameBytes(const size_t bytes)
+{
+    return (bytes + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+}
+
+/**
+ * @brief Row step that pads each row of a frame to a multiple of
+ * FRAME_ALIGNMENT so that every row, and not only the first, starts on an
+ * aligned address.
+ * @param cols Number of columns in the frame.
+ * @param type OpenCV cv::Mat type of the frame.
+ * @return Padded row step in bytes.
+ */
+inline size_t paddedStep(const size_t cols, const int type)
+{
+    return alignFrameBytes(cols * CV_ELEM_SIZE(type));
+}
+
 /** Header to facilitate zero-copy oat::Frame exchange through shared
   * memory.
   *
@@ -45,6 +77,21 @@ struct FrameParams {
   * two blocks of shared memory, one for matrix data and other for sample count
   * and rate information. Non-pointer members allow construction of Frames at
   * source and sink end contain this data and sample information.
+  *
+  * data_ and sample_ point to the first of depth_ + 1 contiguous buffers. The
+  * handle for buffer i is found using data(i) and sample(i). Each data buffer
+  * holds up to capacity() bytes and starts on a FRAME_ALIGNMENT byte
+  * boundary. Each of the node's depth_ ring entries refers to one of these
+  * buffers, given by buffer(entry). The remaining buffer is a back buffer that
+  * belongs to the SINK, which can render into it while SOURCEs read and then
+  * publish it by swapping it with a ring entry's buffer using swapBuffer().
+  *
+  * The SINK can change the frame geometry at any time using reshape(), as
+  * long as frames still fit within capacity(). Each change increments the
+  * parameters' generation. Because SOURCEs may still be reading frames of
+  * the old geometry, each buffer keeps the parameters it was written with,
+  * given by params(buffer), which the SINK sets using stamp() just before it
+  * publishes the buffer.
   */
 
 class SharedFrameHeader {
@@ -55,8 +102,45 @@ public :
 
     handle_t sample() const { return sample_; }
     handle_t data() const { return data_; }
+    handle_t sample(const size_t index) const
+    {
+        return sample_ + index * sizeof(oat::Sample);
+    }
+    handle_t data(const size_t index) const
+    {
+        return data_ + index * capacity_;
+    }
+    size_t capacity() const { return capacity_; }
+
+    // Parameters of frames that the SINK is currently writing
     FrameParams params() const { return params_; }
 
+    // Parameters of the frame held in a buffer
+    FrameParams params(const size_t buffer) const
+    {
+        return buffer_params_[buffer];
+    }
+    size_t depth() const { return depth_; }
+    size_t buffers() const { return depth_ + 1; }
+
+    // Buffer currently referred to by a ring entry
+    size_t buffer(const size_t entry) const { return buffer_[entry]; }
+
+    /**
+     * Make a ring entry refer to a different buffer. Must only be called by
+     * the SINK while no SOURCE is permitted to read the entry.
+     *
+     * @param entry Ring entry
+     * @param buffer Buffer that the entry should refer to
+     * @return Buffer that the entry referred to previously
+     */
+    size_t swapBuffer(const size_t entry, const size_t buffer)
+    {
+        size_t prev = buffer_[entry];
+        buffer_[entry] = buffer;
+        return prev;
+    }
+
     /**
      * Set header data fields.
      *
@@ -65,35 +149,121 @@ public :
      * @param rows Number of rows in the matrix
      * @param cols Number of columns in the matrix
      * @param type OpenCV cv::Mat type of the frame
+     * @param color Pixel color of the frame
+     * @param depth Number of ring entries. depth + 1 frame buffers must
+     * start at data and sample.
+     * @param step Bytes per matrix row. 0 indicates tightly packed rows.
+     * @param capacity Bytes available to each buffer. 0 indicates that
+     * buffers are just large enough to hold frames of these parameters.
      */
     void setParameters(const handle_t data,
                        const handle_t sample,
                        const size_t rows,
                        const size_t cols,
                        const int type,
-                       const oat::PixelColor color)
+                       const oat::PixelColor color,
+                       const size_t depth = 1,
+                       const size_t step = 0,
+                       const size_t capacity = 0)
     {
+        const FrameParams p = makeParams(rows, cols, type, color, step, 0);
+
         data_ = data;
         sample_ = sample;
-        params_.rows = rows;
-        params_.cols = cols;
-        params_.type = type;
-        params_.color = color;
+        params_ = p;
+        depth_ = depth;
+        capacity_ = std::max(alignFrameBytes(p.bytes), capacity);
+
+        for (size_t i = 0; i < buffer_.size(); i++)
+            buffer_[i] = i;
+        for (auto &b : buffer_params_)
+            b = p;
     }
 
+    /**
+     * Change the parameters of frames that the SINK writes from now on.
+     * Must only be called by the SINK.
+     *
+     * @param rows Number of rows in the matrix
+     * @param cols Number of columns in the matrix
+     * @param type OpenCV cv::Mat type of the frame
+     * @param color Pixel color of the frame
+     * @param step Bytes per matrix row. 0 indicates tightly packed rows.
+     */
+    void reshape(const size_t rows,
+                 const size_t cols,
+                 const int type,
+                 const oat::PixelColor color,
+                 const size_t step = 0)
+    {
+        const FrameParams p = makeParams(
+            rows, cols, type, color, step, params_.generation + 1);
+
+        if (p.bytes > capacity_)
+            throw std::runtime_error("Frame of " + std::to_string(p.bytes)
+                                     + " bytes exceeds the node's capacity of "
+                                     + std::to_string(capacity_) + " bytes.");
+
+        params_ = p;
+    }
+
+    /**
+     * Record that a buffer holds a frame with the current parameters. Must
+     * only be called by the SINK while no SOURCE is permitted to read the
+     * buffer.
+     *
+     * @param buffer Buffer that the SINK wrote
+     */
+    void stamp(const size_t buffer) { buffer_params_[buffer] = params_; }
+
 private :
 
+    static FrameParams makeParams(const size_t rows,
+                                  const size_t cols,
+                                  const int type,
+                                  const oat::PixelColor color,
+                                  const size_t step,
+                                  const uint32_t generation)
+    {
+        const size_t row_bytes = cols * CV_ELEM_SIZE(type);
+        if (step != 0 && step < row_bytes)
+            throw std::runtime_error("Frame row step must be at least "
+                                     + std::to_string(row_bytes) + " bytes.");
+
+        FrameParams p;
+        p.rows = rows;
+        p.cols = cols;
+        p.type = type;
+        p.color = color;
+        p.step = step == 0 ? row_bytes : step;
+        p.bytes = rows * p.step;
+        p.generation = generation;
+        return p;
+    }
+
     // TODO: Should these be atomic? They should already be protected by
     // the semaphores wrapping critical sections in the code. I guess they
     // are manipulated by bind() and connect() methods without semaphore
     // protection though. But, only bind writes.
 
-    // Matrix metadata
+    // Matrix metadata of frames being written
     FrameParams params_;
 
+    // Bytes available to each buffer
+    size_t capacity_ {0};
+
     // Interprocess matrix data and sample handles
     handle_t data_;
     handle_t sample_;
+
+    // Number of entries in the ring
+    size_t depth_ {1};
+
+    // Buffer referred to by each ring entry
+    std::array<size_t, Node::MAX_DEPTH> buffer_ {{0}};
+
+    // Matrix metadata of the frame held in each buffer
+    std::array<FrameParams, Node::MAX_DEPTH + 1> buffer_params_;
 };
 
 }       /* namespace oat */
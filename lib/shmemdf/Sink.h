@@ -20,19 +20,22 @@
 #ifndef OAT_SINK_H
 #define	OAT_SINK_H
 
+#include <algorithm>
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 #include <iostream>
 #include <memory>
 #include <string>
 
 #include "../datatypes/Color.h"
 #include "../datatypes/Frame.h"
+#include "../datatypes/Metadata.h"
 #include "../datatypes/Sample.h"
 #include "../base/Globals.h"
 
 #include "ForwardsDecl.h"
 #include "Node.h"
+#include "NodeDefaults.h"
+#include "PinnedMemory.h"
 #include "SharedFrameHeader.h"
 
 namespace oat {
@@ -50,6 +53,15 @@ public:
     void wait();
     void post();
 
+    /**
+     * @brief Set the number of samples that can be written to the node before
+     * the SINK must wait for its slowest SOURCE. Must be called before bind().
+     * If not called, oat::nodeDefaults().depth is used.
+     * @param depth Number of shared objects in the node's ring buffer.
+     */
+    void set_depth(const size_t depth);
+    size_t depth(void) const { return depth_; }
+
 protected:
 
     std::string address_;
@@ -58,6 +70,29 @@ protected:
     T * sh_object_ {nullptr};
     std::string node_address_, obj_address_;
     bool bound_ {false};
+    size_t depth_ {0}; //!< Zero until bind() unless set_depth() was called
+
+    void resolveDepth(void)
+    {
+        if (depth_ == 0)
+            depth_ = oat::nodeDefaults().depth;
+    }
+
+    /**
+     * @brief Open, or create, the node at address and claim it for this
+     * SINK. A node left behind by components that crashed is removed and
+     * created anew.
+     * @param address Node address.
+     */
+    void openNode(const std::string &address);
+
+    // Size of the shared object segment, rounded up to whole huge pages if
+    // node memory is pinned
+    static size_t objectSegmentSize(const size_t bytes)
+    {
+        return oat::nodeDefaults().pin_memory ? oat::hugePageRound(bytes)
+                                              : bytes;
+    }
 
 private:
     bool did_wait_need_post_ {false};
@@ -79,8 +114,8 @@ inline SinkBase<T>::~SinkBase()
 
         // If the client ref count is 0, memory can be deallocated
         if (node_->source_ref_count() == 0 &&
-            bip::shared_memory_object::remove(node_address_.c_str()) &&
-            bip::shared_memory_object::remove(obj_address_.c_str())) {
+            shmem_t::remove(node_address_) &&
+            shmem_t::remove(obj_address_)) {
 
 #ifndef NDEBUG
         std::cout << "Shared memory at \'" + node_address_ +
@@ -101,16 +136,16 @@ inline void SinkBase<T>::wait()
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
+    // Only blocks if a SOURCE has not finished reading the buffer we are
+    // about to write. Leaving SOURCEs release the buffers they hold.
+    uint64_t waited_ns;
+    node_->waitWriteBufferFree(quit, &waited_ns);
+    oat::tracer().beginWrite();
 
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (node_->source_ref_count() > 0 &&
-          !node_->write_barrier.timed_wait(timeout) &&
-          !quit) {
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
-    }
+    auto &activity = nodeActivity();
+    activity.sink_wait_ns += waited_ns;
+    if (waited_ns > 0)
+        activity.overruns++;
 
     did_wait_need_post_ = true;
 }
@@ -126,6 +161,10 @@ inline void SinkBase<T>::post()
         throw std::runtime_error("post() called when wait() was required.");
 #endif
 
+    // Publish the sample's trace along with it
+    oat::tracer().write(node_->trace(node_->write_index()), address_,
+                        node_->write_number());
+
     // Increment the number times this node has facilitated a shmem write
     node_->notifySinkWriteComplete();
 
@@ -137,6 +176,68 @@ inline void SinkBase<T>::post()
 #endif
 }
 
+template <typename T>
+inline void SinkBase<T>::openNode(const std::string &address)
+{
+    // Addresses for this block of shared memory
+    address_ = address;
+    node_address_ = address + "_node";
+    obj_address_ = address + "_obj";
+
+    // Define shared memory
+    node_shmem_ = shmem_t(
+            bip::open_or_create,
+            node_address_.c_str(),
+            nodeSegmentBytes());
+
+    // Bind to a node which facilitates synchronized access to shmem
+    node_ = findOrConstructNode(node_shmem_);
+
+    // Clean up after a SINK that crashed, or a SINK that left SOURCEs behind
+    // that then crashed
+    if (node_->abandoned()) {
+
+        node_shmem_ = shmem_t();
+        shmem_t::remove(node_address_);
+        shmem_t::remove(obj_address_);
+
+        node_shmem_ = shmem_t(
+                bip::open_or_create,
+                node_address_.c_str(),
+                nodeSegmentBytes());
+        node_ = findOrConstructNode(node_shmem_);
+    }
+
+    // Make sure there is not another SINK using this shmem
+    if (node_->sink_state() != NodeState::UNDEFINED) {
+
+        // There is already a SINK using this shmem
+        throw (std::runtime_error(
+                "Requested SINK address, '" + address + "', is not available."));
+    }
+
+    // No SINK has bound this node, so any object segment was left by one that
+    // crashed before it could bind
+    shmem_t::remove(obj_address_);
+
+    resolveDepth();
+    node_->set_depth(depth_);
+    node_->set_source_timeout(oat::nodeDefaults().source_timeout);
+}
+
+template <typename T>
+inline void SinkBase<T>::set_depth(const size_t depth)
+{
+    if (bound_)
+        throw std::runtime_error("Sink depth must be set before bind().");
+
+    if (depth == 0 || depth > Node::MAX_DEPTH)
+        throw std::runtime_error("Sink depth must be between 1 and "
+                                 + std::to_string(Node::MAX_DEPTH) + ".");
+
+    depth_ = depth;
+}
+
 /* SPECIALIZATIONS */
 
 // 0. Generic without need for zero-copy storage
@@ -152,6 +253,7 @@ class Sink : public SinkBase<T> {
     using SinkBase<T>::node_;
     using SinkBase<T>::sh_object_;
     using SinkBase<T>::bound_;
+    using SinkBase<T>::depth_;
 
 public:
 
@@ -159,6 +261,17 @@ public:
     void bind(const std::string &address, Targs... args);
     T * retrieve();
 
+    /**
+     * @brief Set information that is the same for every sample published to
+     * the node, e.g. the coordinate system of positions. Must be called
+     * before bind() so that SOURCEs have it as soon as they connect.
+     * @param metadata Node metadata.
+     */
+    void set_metadata(const Metadata<T> &metadata);
+    const Metadata<T> &metadata(void) const { return metadata_; }
+
+private:
+    Metadata<T> metadata_;
 };
 
 template <typename T>
@@ -169,43 +282,36 @@ inline void Sink<T>::bind(const std::string &address, Targs... args)
         throw std::runtime_error("A sink can only bind a "
                                  "single time to a single node.");
 
-    // Addresses for this block of shared memory
-    address_ = address;
-    node_address_ = address + "_node";
-    obj_address_ = address + "_obj";
-
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024 + sizeof(Node));
-
-    // Bind to a node which facilitates synchronized access to shmem
-    node_ = node_shmem_.template find_or_construct<Node>(typeid(Node).name())();
+    this->openNode(address);
 
-    // Make sure there is not another SINK using this shmem
-    if (node_->sink_state() != NodeState::UNDEFINED) {
+    obj_shmem_ = shmem_t(
+        bip::create_only,
+        obj_address_.c_str(),
+        this->objectSegmentSize(2048 + sizeof(Metadata<T>) + depth_ * sizeof (T)));
+    oat::pinNodeSegments(address_, node_shmem_, obj_shmem_);
 
-        // There is already a SINK using this shmem
-        throw (std::runtime_error(
-                "Requested SINK address, '" + address + "', is not available."));
-    } else {
+    // Find an existing shared object ring or construct one
+    sh_object_ = obj_shmem_.template find_or_construct<T>(typeid(T).name())[depth_](args...);
+    obj_shmem_.template find_or_construct<Metadata<T>>(
+        typeid(Metadata<T>).name())(metadata_);
+    node_->set_sink_state(NodeState::SINK_BOUND);
+    bound_ = true;
+}
 
-        obj_shmem_ = bip::managed_shared_memory(
-            bip::create_only,
-            obj_address_.c_str(),
-            1024 + sizeof (T));
+template <typename T>
+inline void Sink<T>::set_metadata(const Metadata<T> &metadata)
+{
+    if (bound_)
+        throw std::runtime_error("Node metadata must be set before bind().");
 
-        // Find an existing shared object or construct one
-        sh_object_ = obj_shmem_.template find_or_construct<T>(typeid(T).name())(args...);
-        node_->set_sink_state(NodeState::SINK_BOUND);
-        bound_ = true;
-    }
+    metadata_ = metadata;
 }
 
+/**
+ * @brief Get the shared object that will be published by the next post().
+ * When the node is more than one sample deep, this changes after each post()
+ * so the pointer must be retrieved again after each wait().
+ */
 template <typename T>
 inline T *Sink<T>::retrieve()
 {
@@ -215,7 +321,7 @@ inline T *Sink<T>::retrieve()
         throw (std::runtime_error("SINK must be bound before shared object is retrieved."));
 #endif
 
-    return sh_object_;
+    return sh_object_ + node_->write_index();
 }
 
 // 1. SharedFrameHeader
@@ -224,9 +330,76 @@ template <>
 class Sink<Frame> : public SinkBase<SharedFrameHeader> {
 
 public:
+    /**
+     * @brief Bind a node that holds frames.
+     * @param address Node address.
+     * @param bytes Bytes of data in each frame, including any row padding.
+     * This is the largest frame that can be published, including after a
+     * reshape().
+     */
     void bind(const std::string &address, const size_t bytes);
+
+    /**
+     * @brief Allocate the node's frame buffers and get a view of the frame
+     * that will be published by the next post(). Frame data is aligned to
+     * FRAME_ALIGNMENT bytes.
+     * @param rows Number of rows in each frame.
+     * @param cols Number of columns in each frame.
+     * @param type OpenCV cv::Mat type of each frame.
+     * @param color Pixel color of each frame.
+     * @param step Bytes per row. 0 gives tightly packed rows. Use
+     * oat::paddedStep() to align every row.
+     */
     oat::Frame retrieve(const size_t rows, size_t cols, const int type, const
-            oat::PixelColor color);
+            oat::PixelColor color, const size_t step = 0);
+    oat::Frame retrieve();
+
+    /**
+     * @brief Change the geometry of frames published from now on, without
+     * reallocating or reconnecting. SOURCEs pick up the change on the wait()
+     * that returns the first frame with the new geometry.
+     * @param rows Number of rows in each frame.
+     * @param cols Number of columns in each frame.
+     * @param type OpenCV cv::Mat type of each frame.
+     * @param color Pixel color of each frame.
+     * @param step Bytes per row. 0 gives tightly packed rows.
+     * @return View of the frame being written, with the new geometry. Views
+     * obtained before the call must not be used.
+     */
+    oat::Frame reshape(const size_t rows, const size_t cols, const int type,
+                       const oat::PixelColor color, const size_t step = 0);
+
+    // Hides SinkBase::wait() in order to carry sample info across the ring
+    void wait();
+
+    // Hides SinkBase::post() in order to record the geometry of the frame
+    // being published
+    void post();
+
+    /**
+     * @brief Get a view of the SINK's back buffer, which no SOURCE can see,
+     * so that the next frame can be rendered straight into shared memory.
+     * Does not block. Must be followed by publish(), and should not be mixed
+     * with wait()/retrieve()/post().
+     */
+    oat::Frame acquireWriteBuffer();
+
+    /**
+     * @brief Wait until the next ring entry is free, swap the back buffer
+     * into it, and tell SOURCEs that there is new data. The buffer that the
+     * entry referred to becomes the new back buffer, so no frame data is
+     * copied.
+     */
+    void publish();
+
+private:
+    oat::Frame view(const size_t buffer);
+
+    oat::Sample * samples_ {nullptr};
+    char * data_ {nullptr};
+    size_t bytes_ {0};
+    size_t back_ {0}; //!< Back buffer index
+    bool did_acquire_need_publish_ {false};
 };
 
 inline void Sink<Frame>::bind(const std::string &address, const size_t bytes)
@@ -235,66 +408,162 @@ inline void Sink<Frame>::bind(const std::string &address, const size_t bytes)
         throw std::runtime_error("A sink can only bind a "
                                  "single time to a single node.");
 
-    // Addresses for this block of shared memory
-    address_ = address;
-    node_address_ = address + "_node";
-    obj_address_ = address + "_obj";
+    openNode(address);
 
-    // Define shared memory
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024  + sizeof(Node));
+    // Largest frame that can be held by each buffer
+    bytes_ = alignFrameBytes(bytes);
 
-    // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    // Object shared memory
+    obj_shmem_ = shmem_t(
+        bip::create_only,
+        obj_address_.c_str(),
+        objectSegmentSize(1024 + sizeof(SharedFrameHeader) + FRAME_ALIGNMENT
+             + (depth_ + 1) * (bytes_ + sizeof(oat::Sample))));
+    oat::pinNodeSegments(address_, node_shmem_, obj_shmem_);
 
-    // Make sure there is not another SINK using this shmem
-    if (node_->sink_state() != NodeState::UNDEFINED) {
+    // Find an existing shared object or construct one
+    sh_object_ = obj_shmem_.find_or_construct<SharedFrameHeader>(typeid(SharedFrameHeader).name())();
 
-        // There is already a SINK using this shmem
-        throw (std::runtime_error(
-                "Requested SINK address, '" + address + "', is not available."));
-    } else {
-
-        // Object shared memory
-        obj_shmem_ = bip::managed_shared_memory(
-            bip::create_only,
-            obj_address_.c_str(),
-            1024 + sizeof(SharedFrameHeader) + bytes + sizeof(uint64_t));
-
-        // Find an existing shared object or construct one
-        sh_object_ = obj_shmem_.find_or_construct<SharedFrameHeader>(typeid(SharedFrameHeader).name())();
-
-        node_->set_sink_state(NodeState::SINK_BOUND);
-        bound_ = true;
-    }
+    node_->set_sink_state(NodeState::SINK_BOUND);
+    bound_ = true;
 }
 
 inline oat::Frame Sink<Frame>::retrieve(const size_t rows,
                                         const size_t cols,
                                         const int type,
-                                        const oat::PixelColor color)
+                                        const oat::PixelColor color,
+                                        const size_t step)
 {
     // Make sure that the SINK is bound to a shared memory segment
     //assert(bound_);
     if (!bound_)
         throw (std::runtime_error("SINK must be bound before shared frame is retrieved."));
 
-    // Allocate memory for sample number
-    void * sample = obj_shmem_.allocate(sizeof(oat::Sample));
-    handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
+    // One buffer per ring entry plus a back buffer
+    const size_t buffers = depth_ + 1;
 
-    // Allocate memory for the shared object's data
-    cv::Mat temp(rows, cols, type);
-    void * data = obj_shmem_.allocate(temp.total() * temp.elemSize());
-    handle_t data_handle = obj_shmem_.get_handle_from_address(data);
+    // Allocate memory for sample number, one per buffer
+    samples_ = obj_shmem_.construct<oat::Sample>(bip::anonymous_instance)[buffers]();
+    handle_t sample_handle = obj_shmem_.get_handle_from_address(samples_);
+
+    // Allocate memory for the shared object's data, one aligned block per
+    // buffer
+    const size_t row_step = step == 0 ? cols * CV_ELEM_SIZE(type) : step;
+    bytes_ = std::max(bytes_, alignFrameBytes(rows * row_step));
+    data_ = static_cast<char *>(
+        obj_shmem_.allocate_aligned(buffers * bytes_, FRAME_ALIGNMENT));
+    handle_t data_handle = obj_shmem_.get_handle_from_address(data_);
 
     // Reset the SharedFrameHeader's parameters now that we know what they should be
-    sh_object_->setParameters(data_handle, sample_handle, rows, cols, type, color);
+    sh_object_->setParameters(data_handle, sample_handle, rows, cols, type,
+                              color, depth_, step, bytes_);
+    back_ = depth_;
 
     // Return pointer to memory allocated for shared object
-    return oat::Frame(rows, cols, type, color, data, sample);
+    return retrieve();
+}
+
+/**
+ * @brief Get a view of the shared frame that will be published by the next
+ * post(). When the node is more than one sample deep, this changes after each
+ * post() so the view must be retrieved again after each wait().
+ */
+inline oat::Frame Sink<Frame>::retrieve()
+{
+    if (samples_ == nullptr)
+        throw (std::runtime_error("Shared frame must be allocated before it is retrieved."));
+
+    return view(sh_object_->buffer(node_->write_index()));
+}
+
+inline oat::Frame Sink<Frame>::reshape(const size_t rows,
+                                       const size_t cols,
+                                       const int type,
+                                       const oat::PixelColor color,
+                                       const size_t step)
+{
+    if (samples_ == nullptr)
+        throw (std::runtime_error("Shared frame must be allocated before it is reshaped."));
+
+    sh_object_->reshape(rows, cols, type, color, step);
+
+    return did_acquire_need_publish_ ? view(back_) : retrieve();
+}
+
+inline void Sink<Frame>::wait()
+{
+    SinkBase<SharedFrameHeader>::wait();
+
+    // Each buffer has its own sample info. Carry the last one forward so that
+    // the count, rate, etc. continue from the previous write.
+    uint64_t n = node_->write_number();
+    if (samples_ != nullptr && depth_ > 1 && n > 0)
+        samples_[sh_object_->buffer(n % depth_)] =
+            samples_[sh_object_->buffer((n - 1) % depth_)];
+}
+
+inline void Sink<Frame>::post()
+{
+    // SOURCEs cannot read the buffer until after the post
+    if (samples_ != nullptr)
+        sh_object_->stamp(sh_object_->buffer(node_->write_index()));
+
+    SinkBase<SharedFrameHeader>::post();
+}
+
+inline oat::Frame Sink<Frame>::acquireWriteBuffer()
+{
+    if (samples_ == nullptr)
+        throw (std::runtime_error("Shared frame must be allocated before it is acquired."));
+
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if (did_acquire_need_publish_)
+        throw std::runtime_error("acquireWriteBuffer() called when publish() was required.");
+#endif
+
+    // Carry sample info forward from the last published buffer. SOURCEs may
+    // be reading that buffer, but they do not write to it.
+    uint64_t n = node_->write_number();
+    if (n > 0)
+        samples_[back_] = samples_[sh_object_->buffer((n - 1) % depth_)];
+
+    did_acquire_need_publish_ = true;
+
+    return view(back_);
+}
+
+inline void Sink<Frame>::publish()
+{
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if (!did_acquire_need_publish_)
+        throw std::runtime_error("publish() called when acquireWriteBuffer() was required.");
+#endif
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to finish with the entry we are about to replace
+    SinkBase<SharedFrameHeader>::wait();
+
+    // Pointer swap: the rendered back buffer becomes the published entry
+    back_ = sh_object_->swapBuffer(node_->write_index(), back_);
+
+    // Tell sources there is new data
+    post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    did_acquire_need_publish_ = false;
+}
+
+inline oat::Frame Sink<Frame>::view(const size_t buffer)
+{
+    auto p = sh_object_->params();
+    return oat::Frame(p.rows, p.cols, p.type, p.color,
+                      data_ + buffer * bytes_, samples_ + buffer, p.step);
 }
 
 } // namespace oat
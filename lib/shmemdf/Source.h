@@ -22,7 +22,10 @@
 
 #include "ForwardsDecl.h"
 #include "Node.h"
+#include "NodeDefaults.h"
+#include "PinnedMemory.h"
 #include "SharedFrameHeader.h"
+#include "SourcePolicy.h"
 
 #include <exception>
 #include <iostream>
@@ -32,9 +35,9 @@
 #include <thread>
 
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 
 #include "../datatypes/Frame.h"
+#include "../datatypes/Metadata.h"
 #include "../base/Globals.h"
 
 namespace oat {
@@ -49,15 +52,43 @@ enum class SourceState : std::int16_t
     CONNECTED       = 2,
 };
 
+// How a SOURCE receives samples from its node
+enum class SourceMode
+{
+    BLOCKING,   //!< Hold a slot. The SINK waits for the samples we read.
+    LATEST,     //!< Read the newest sample without ever holding up the SINK
+};
+
 template <typename T>
 class SourceBase {
 public:
     SourceBase();
     virtual ~SourceBase();
 
-    // Node connection
-    void touch(const std::string &address);
+    /**
+     * @brief Attach to a node.
+     * @param address Node address.
+     * @param mode BLOCKING to take a slot in the node and read samples
+     * according to oat::nodeDefaults().source_policy. LATEST to read the
+     * newest sample, when there is one, without taking a slot. The SINK
+     * never waits on a LATEST SOURCE, which may skip samples and must use
+     * clone() or copyTo() to read, since these detect and retry reads that
+     * the SINK overwrote.
+     */
+    void touch(const std::string &address,
+               const SourceMode mode = SourceMode::BLOCKING);
+
+    /**
+     * @brief Attach to a node, taking a slot, and read the samples chosen by
+     * policy.
+     * @param address Node address.
+     * @param policy Which samples to read.
+     */
+    void touch(const std::string &address, const SourcePolicy &policy);
+
     virtual SourceState connect(void);
+    SourceMode mode(void) const { return mode_; }
+    SourcePolicy policy(void) const { return policy_; }
 
     // Sychronization
     NodeState wait();
@@ -75,10 +106,75 @@ protected:
     Node * node_ {nullptr};
     std::string address_, node_address_, obj_address_;
     size_t slot_index_ {0};
+    uint64_t lease_ {0}; //!< Lease under which we hold slot_index_
     std::atomic<SourceState> state_ {SourceState::VIRGIN};
     bool touched_ {false};
     bool connected_ {false};
     bool did_wait_need_post_ {false};
+
+    // LATEST mode
+    SourceMode mode_ {SourceMode::BLOCKING};
+    SourcePolicy policy_; //!< Samples read by BLOCKING SOURCEs
+    uint64_t seen_ {0}; //!< Samples published when we last post()ed
+    uint64_t last_read_ {NOT_READ}; //!< Number of the last sample we read
+
+    // Map the node's segment without taking a slot
+    void attach(const std::string &address);
+
+    // Ring buffer entry holding the newest sample
+    size_t latest_index(void) const
+    {
+        uint64_t n = node_->write_number();
+        return n == 0 ? 0 : (n - 1) % node_->depth();
+    }
+
+    // Carry the trace of the sample we are about to read forward to the
+    // nodes this thread writes
+    void readTrace(void)
+    {
+        if (mode_ != SourceMode::LATEST) {
+            oat::tracer().read(node_->trace(node_->read_index(slot_index_)));
+            return;
+        }
+
+        // Retry if the SINK wrote the sample while we copied its trace
+        for (;;) {
+            size_t i = latest_index();
+            uint32_t seq = node_->beginLatestRead(i);
+            Trace t = node_->trace(i);
+            if (node_->endLatestRead(i, seq)) {
+                oat::tracer().read(t);
+                return;
+            }
+        }
+    }
+
+    // Count the samples the SINK published since our last read that our
+    // policy did not mean to skip. Only SOURCEs that never hold up the SINK,
+    // or that were evicted and rejoined, miss any.
+    void countDropped(void)
+    {
+        const bool latest = mode_ == SourceMode::LATEST;
+        const uint64_t n = latest ? node_->write_number() - 1
+                                  : node_->read_number(slot_index_);
+        const uint64_t stride =
+            latest || policy_.kind == SourcePolicy::DROP ? 1 : policy_.n;
+
+        if (last_read_ != NOT_READ && n > last_read_ + stride)
+            nodeActivity().dropped += n - last_read_ - stride;
+        last_read_ = n;
+    }
+
+    static constexpr uint64_t NOT_READ {~uint64_t(0)};
+
+    // The SINK evicts SOURCEs that hold it up for longer than the node's
+    // source timeout. Our slot may since belong to someone else.
+    void checkEviction(void) const
+    {
+        if (!node_->ownsSlot(slot_index_, lease_))
+            throw std::runtime_error("SOURCE at '" + address_ + "' was evicted "
+                                     "from the node for holding up its SINK.");
+    }
 };
 
 template <typename T>
@@ -91,9 +187,11 @@ template <typename T>
 inline SourceBase<T>::~SourceBase()
 {
     // If we have touched the node, or there was a node type mismatch, we must
-    // release our slot
-    if (state_ >= SourceState::TOUCHED || state_ == SourceState::ERR_TYPEMIS)
-        node_->releaseSlot(slot_index_);
+    // release our slot. Any buffers that were waiting only on us are
+    // returned to the SINK.
+    if ((state_ >= SourceState::TOUCHED || state_ == SourceState::ERR_TYPEMIS)
+        && mode_ == SourceMode::BLOCKING)
+        node_->releaseSlot(slot_index_, lease_);
 
     // If the client reference count is 0 and there is no server
     // attached to the node, deallocate the shmem
@@ -101,8 +199,8 @@ inline SourceBase<T>::~SourceBase()
         node_->sink_state() != NodeState::SINK_BOUND) {
 
         bool shmem_freed = false;
-        shmem_freed |= bip::shared_memory_object::remove(node_address_.c_str());
-        shmem_freed |= bip::shared_memory_object::remove(obj_address_.c_str());
+        shmem_freed |= shmem_t::remove(node_address_);
+        shmem_freed |= shmem_t::remove(obj_address_);
 
 #ifndef NDEBUG
         if (shmem_freed)
@@ -112,7 +210,41 @@ inline SourceBase<T>::~SourceBase()
 }
 
 template <typename T>
-inline void SourceBase<T>::touch(const std::string &address)
+inline void SourceBase<T>::touch(const std::string &address,
+                                 const SourceMode mode)
+{
+    if (mode == SourceMode::BLOCKING) {
+        touch(address, oat::nodeDefaults().source_policy);
+        return;
+    }
+
+    attach(address);
+
+    // Latest-sample SOURCEs do not take a slot
+    mode_ = mode;
+    state_ = SourceState::TOUCHED;
+}
+
+template <typename T>
+inline void SourceBase<T>::touch(const std::string &address,
+                                 const SourcePolicy &policy)
+{
+    attach(address);
+
+    // Let the node know this source is attached and retrieve *this's index
+    policy_ = policy;
+    if (node_->acquireSlot(slot_index_, policy_) < 0) {
+        state_ = SourceState::ERR_NODEFULL;
+        return;
+    }
+    lease_ = node_->lease(slot_index_);
+
+    // We have touched the node and must sychronize with its sink
+    state_ = SourceState::TOUCHED;
+}
+
+template <typename T>
+inline void SourceBase<T>::attach(const std::string &address)
 {
     // Make sure we did not connect already
     if (state_ != SourceState::VIRGIN)
@@ -125,25 +257,13 @@ inline void SourceBase<T>::touch(const std::string &address)
     obj_address_ = address + "_obj";
 
     // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
-    node_shmem_ = bip::managed_shared_memory(
+    node_shmem_ = shmem_t(
             bip::open_or_create,
             node_address_.c_str(),
-            1024 + sizeof(Node));
+            nodeSegmentBytes());
 
     // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
-
-    // Let the node know this source is attached and retrieve *this's index
-    if (node_->acquireSlot(slot_index_) < 0) {
-        state_ = SourceState::ERR_NODEFULL;
-        return;
-    }
-
-    // We have touched the node and must sychronize with its sink
-    state_ = SourceState::TOUCHED;
+    node_ = findOrConstructNode(node_shmem_);
 }
 
 template <typename T>
@@ -161,18 +281,17 @@ inline SourceState SourceBase<T>::connect()
             return SourceState::ERR_CONNECT; // No throw because this can occur
                                              // at quit
 
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
+        // All loops start with wait() and we just finished our wait(). We
+        // have not read yet, so the next call to wait() will be a 'freebie'
         did_wait_need_post_ = false;
     }
 
     // Find an existing shared object constructed by the SINK
     obj_shmem_ =
-            bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
+            shmem_t(bip::open_only, obj_address_.c_str());
     std::pair<T *,std::size_t> temp = obj_shmem_.find<T>(typeid(T).name());
     sh_object_ = temp.first;
+    oat::pinNodeSegments(address_, node_shmem_, obj_shmem_);
 
     // Only occurs when the name of the shared object does not match typeid(T).name()
     if (sh_object_ == nullptr) {
@@ -195,21 +314,25 @@ inline NodeState SourceBase<T>::wait()
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
-
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (!node_->read_barrier(slot_index_).timed_wait(timeout) && !quit) {
-
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
-
-        // If the sink has left the room, we should too
-        if (node_->sink_state() == NodeState::END)
-            break;
+    // Wait for the SINK to publish the next sample. If the sink has left the
+    // room, we should too.
+    const uint64_t start_ns = steadyNanoseconds();
+    bool ready;
+    if (mode_ == SourceMode::LATEST) {
+        ready = node_->waitWriteNumber(seen_, quit);
+    } else {
+        ready = node_->waitReadBufferReady(slot_index_, lease_, quit);
+        if (!ready)
+            checkEviction();
     }
 
     did_wait_need_post_ = true;
+    nodeActivity().source_wait_ns += steadyNanoseconds() - start_ns;
+
+    if (ready && state_ == SourceState::CONNECTED) {
+        readTrace();
+        countDropped();
+    }
 
     return node_->sink_state();
 }
@@ -225,8 +348,11 @@ inline void SourceBase<T>::post()
         throw std::runtime_error("post() called when wait() was required.");
 #endif
 
-    if (node_->notifySourceReadComplete(slot_index_))
-        node_->write_barrier.post();
+    if (mode_ == SourceMode::LATEST) {
+        seen_ = node_->write_number();
+    } else if (node_->notifySourceReadComplete(slot_index_, lease_) < 0) {
+        checkEviction();
+    }
 
     did_wait_need_post_ = false;
 }
@@ -239,14 +365,49 @@ template <typename T>
 class Source : public SourceBase<T> {
 
     using SourceBase<T>::sh_object_;
+    using SourceBase<T>::node_;
+    using SourceBase<T>::slot_index_;
     using SourceBase<T>::connected_;
     using SourceBase<T>::state_;
+    using SourceBase<T>::mode_;
 
 public:
+    // Also finds the node's metadata
+    SourceState connect(void) override;
+
     T *retrieve() const;
     T clone() const;
+
+    /**
+     * @brief Get information that is the same for every sample published to
+     * the node, as set by its SINK. Only available once connected.
+     */
+    const Metadata<T> &metadata() const;
+
+private:
+    using SourceBase<T>::obj_shmem_;
+
+    const Metadata<T> *sh_metadata_ {nullptr};
 };
 
+template <typename T>
+inline SourceState Source<T>::connect()
+{
+    auto rc = SourceBase<T>::connect();
+
+    // Constructed by the SINK when it bound the node
+    if (rc == SourceState::CONNECTED)
+        sh_metadata_ = obj_shmem_.template find<Metadata<T>>(
+            typeid(Metadata<T>).name()).first;
+
+    return rc;
+}
+
+/**
+ * @brief Get the shared object that this SOURCE is currently permitted to
+ * read. When the node is more than one sample deep, this changes after each
+ * post() so the pointer must be retrieved again after each wait().
+ */
 template <typename T>
 inline T *Source<T>::retrieve() const
 {
@@ -256,7 +417,11 @@ inline T *Source<T>::retrieve() const
         throw (std::runtime_error("Source must be connected before shared object is retrieved."));
 #endif
 
-    return sh_object_;
+    if (mode_ == SourceMode::LATEST)
+        throw (std::runtime_error("A SOURCE reading the latest sample must "
+                                  "use clone() rather than retrieve()."));
+
+    return sh_object_ + node_->read_index(slot_index_);
 }
 
 template <typename T>
@@ -268,7 +433,29 @@ inline T Source<T>::clone() const
         throw (std::runtime_error("Source must be connected before shared object is cloned."));
 #endif
 
-    return *sh_object_;
+    if (mode_ == SourceMode::LATEST) {
+
+        // Retry if the SINK wrote the sample while we copied it
+        for (;;) {
+            size_t i = this->latest_index();
+            uint32_t seq = node_->beginLatestRead(i);
+            T obj = *(sh_object_ + i);
+            if (node_->endLatestRead(i, seq))
+                return obj;
+        }
+    }
+
+    return *(sh_object_ + node_->read_index(slot_index_));
+}
+
+template <typename T>
+inline const Metadata<T> &Source<T>::metadata() const
+{
+    if (sh_metadata_ == nullptr)
+        throw (std::runtime_error("Source must be connected before node "
+                                  "metadata is read."));
+
+    return *sh_metadata_;
 }
 
 // 1. SharedFrameHeader
@@ -279,24 +466,180 @@ public:
 
     using FrameParams = oat::FrameParams;
 
+    /**
+     * @brief Scoped, zero-copy read access to the shared frame. Obtained
+     * using lease() after a call to wait(). The lease post()s the SOURCE
+     * when it is destroyed or release()d. Until then, the SINK cannot
+     * overwrite the leased frame, so keep the lease short. Consumers that
+     * need to modify the frame should copyTo() a private frame instead.
+     */
+    class ReadLease {
+    public:
+        explicit ReadLease(Source<Frame> *source)
+        : source_(source)
+        {
+            // Nothing
+        }
+
+        ReadLease(ReadLease &&other)
+        : source_(other.source_)
+        {
+            other.source_ = nullptr;
+        }
+
+        // Leases cannot be copied
+        ReadLease(const ReadLease &) = delete;
+        ReadLease &operator=(const ReadLease &) = delete;
+        ReadLease &operator=(ReadLease &&) = delete;
+
+        ~ReadLease() { release(); }
+
+        const oat::Frame &frame() const { return source_->frame_; }
+        const oat::Frame &operator*() const { return frame(); }
+        const oat::Frame *operator->() const { return &frame(); }
+
+        // Give up access to the shared frame before the lease is destroyed
+        void release()
+        {
+            if (source_ != nullptr) {
+                source_->post();
+                source_ = nullptr;
+            }
+        }
+
+    private:
+        Source<Frame> *source_;
+    };
+
     // TODO: This info is sitting inside SharedFrameHeader. Why am I creating a
     // new class here? This should be part of SharedFrameHeader so I can just
     // copy it out of there.
     SourceState connect() override;
     SourceState connect(const oat::PixelColor col);
 
-    const oat::Frame * retrieve() const { return &frame_; }
-    oat::Frame clone() const { return frame_.clone(); }
-    void copyTo(oat::Frame &frame) const { frame_.copyTo(frame); };
+    // Hides SourceBase::wait() in order to point frame_ at the buffer the
+    // SINK published. If the SINK has reshape()d its frames, the new
+    // geometry is picked up here.
+    NodeState wait();
+
+    const oat::Frame * retrieve() const;
+    ReadLease lease();
+    oat::Frame clone();
+    void copyTo(oat::Frame &frame);
+
+    // Parameters of the frame mapped by the last wait(). Their generation
+    // changes whenever the frame geometry does.
     FrameParams parameters() const { return parameters_; }
 
+    // Largest frame, in bytes, that the SINK can publish
+    size_t capacity() const { return sh_object_->capacity(); }
+
 private :
 
+    bool mapFrame(const size_t entry);
+
     // Shared frame
     oat::Frame frame_;
     FrameParams parameters_;
 };
 
+inline const oat::Frame * Source<Frame>::retrieve() const
+{
+    if (mode_ == SourceMode::LATEST)
+        throw (std::runtime_error("A SOURCE reading the latest sample must "
+                                  "use clone() or copyTo() rather than "
+                                  "retrieve()."));
+
+    return &frame_;
+}
+
+inline Source<Frame>::ReadLease Source<Frame>::lease()
+{
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if (state_ < SourceState::CONNECTED)
+        throw std::runtime_error("Source must be connected before calling lease()");
+    if (!did_wait_need_post_)
+        throw std::runtime_error("lease() called when wait() was required.");
+#endif
+
+    if (mode_ == SourceMode::LATEST)
+        throw (std::runtime_error("A SOURCE reading the latest sample must "
+                                  "use clone() or copyTo() rather than "
+                                  "lease()."));
+
+    return ReadLease(this);
+}
+
+inline oat::Frame Source<Frame>::clone()
+{
+    if (mode_ != SourceMode::LATEST)
+        return frame_.clone();
+
+    oat::Frame frame;
+    copyTo(frame);
+    return frame;
+}
+
+inline void Source<Frame>::copyTo(oat::Frame &frame)
+{
+    if (mode_ != SourceMode::LATEST) {
+        frame_.copyTo(frame);
+        return;
+    }
+
+    // Retry if the SINK wrote the frame while we copied it
+    for (;;) {
+        size_t i = latest_index();
+        uint32_t seq = node_->beginLatestRead(i);
+        if (!mapFrame(i))
+            continue;
+        frame_.copyTo(frame);
+        if (node_->endLatestRead(i, seq))
+            return;
+    }
+}
+
+inline NodeState Source<Frame>::wait()
+{
+    auto rc = SourceBase<SharedFrameHeader>::wait();
+
+    // Even with a single ring entry, the SINK may have swapped a new buffer
+    // into it. Latest-sample SOURCEs map the frame when they copy it.
+    if (state_ == SourceState::CONNECTED && mode_ == SourceMode::BLOCKING)
+        mapFrame(node_->read_index(slot_index_));
+
+    return rc;
+}
+
+/**
+ * @brief Point frame_ at the buffer held by a ring entry, using the geometry
+ * that buffer was written with.
+ * @param entry Ring entry.
+ * @return False if the buffer's parameters are inconsistent, which can only
+ * happen to latest-sample SOURCEs that race the SINK. The read must be
+ * retried.
+ */
+inline bool Source<Frame>::mapFrame(const size_t entry)
+{
+    const size_t buffer = sh_object_->buffer(entry);
+    const FrameParams p = sh_object_->params(buffer);
+    if (buffer >= sh_object_->buffers()
+        || p.bytes > sh_object_->capacity()
+        || p.step < p.cols * CV_ELEM_SIZE(p.type))
+        return false;
+
+    parameters_ = p;
+    frame_ = oat::Frame(p.rows,
+                        p.cols,
+                        p.type,
+                        p.color,
+                        obj_shmem_.get_address_from_handle(sh_object_->data(buffer)),
+                        obj_shmem_.get_address_from_handle(sh_object_->sample(buffer)),
+                        p.step);
+    return true;
+}
+
 inline SourceState Source<Frame>::connect(const oat::PixelColor color)
 {
     auto rc = connect();
@@ -327,19 +670,18 @@ inline SourceState Source<Frame>::connect()
             return SourceState::ERR_CONNECT; // No throw because this can occur
                                              // at quit
 
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
+        // All loops start with wait() and we just finished our wait(). We
+        // have not read yet, so the next call to wait() will be a 'freebie'
         did_wait_need_post_ = false;
     }
 
     // Find an existing shared object constructed by the SINK
     obj_shmem_ =
-            bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
+            shmem_t(bip::open_only, obj_address_.c_str());
     std::pair<SharedFrameHeader *, size_t> temp =
             obj_shmem_.find<SharedFrameHeader>(typeid(SharedFrameHeader).name());
     sh_object_ = temp.first;
+    oat::pinNodeSegments(address_, node_shmem_, obj_shmem_);
 
     // Only occurs when the name of the shared object does not match typeid(T).name()
     if (sh_object_ == nullptr) {
@@ -347,21 +689,13 @@ inline SourceState Source<Frame>::connect()
         throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
     }
 
-    // Generate frame header using info in shmem segment
-    auto p = sh_object_->params();
-    frame_ = oat::Frame(p.rows,
-                        p.cols,
-                        p.type,
-                        p.color,
-                        obj_shmem_.get_address_from_handle(sh_object_->data()),
-                        obj_shmem_.get_address_from_handle(sh_object_->sample()));
-
     // Save parameters to construct cv::Mats with
-    parameters_.cols = p.cols;
-    parameters_.rows = p.rows;
-    parameters_.type = p.type;
-    parameters_.color = p.color;
-    parameters_.bytes = frame_.total() * frame_.elemSize();
+    parameters_ = sh_object_->params();
+
+    // Generate frame header using info in shmem segment. Replaces the
+    // parameters with those of the mapped frame.
+    mapFrame(mode_ == SourceMode::LATEST ? latest_index()
+                                         : node_->read_index(slot_index_));
 
     state_ = SourceState::CONNECTED;
     return SourceState::CONNECTED;
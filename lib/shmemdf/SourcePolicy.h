@@ -0,0 +1,82 @@
+//******************************************************************************
+//* File:   SourcePolicy.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SOURCEPOLICY_H
+#define	OAT_SOURCEPOLICY_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace oat {
+
+/**
+ * @brief Which of its SINK's samples a SOURCE that holds a slot in a node
+ * reads, and so how much it can hold up the SINK.
+ *
+ * BLOCK SOURCEs read every sample. DROP SOURCEs read the first sample
+ * published after they release the last one and skip those published while
+ * they are busy. They hold at most one buffer, so they only hold up the SINK
+ * if a single read takes longer than the node's depth in samples. EVERY
+ * SOURCEs read every nth sample and the SINK only waits for them on those.
+ */
+struct SourcePolicy {
+
+    enum Kind { BLOCK, DROP, EVERY };
+
+    explicit SourcePolicy(const Kind k = BLOCK, const uint32_t every = 1)
+    : kind(k)
+    , n(k == EVERY ? every : 1)
+    {
+        if (n == 0)
+            throw std::runtime_error("A SOURCE must read at least every "
+                                     "first sample.");
+    }
+
+    Kind kind;
+    uint32_t n; //!< Samples per read for EVERY SOURCEs, otherwise 1
+};
+
+/**
+ * @brief Parse a policy from its program option form: 'block', 'drop' or
+ * 'every-N', where N is a positive integer.
+ */
+inline SourcePolicy sourcePolicy(const std::string &s)
+{
+    if (s == "block")
+        return SourcePolicy(SourcePolicy::BLOCK);
+    if (s == "drop")
+        return SourcePolicy(SourcePolicy::DROP);
+
+    const std::string prefix {"every-"};
+    if (s.compare(0, prefix.size(), prefix) == 0
+        && s.size() > prefix.size() && s.size() <= prefix.size() + 9
+        && s.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+
+        const unsigned long n = std::stoul(s.substr(prefix.size()));
+        if (n > 0)
+            return SourcePolicy(SourcePolicy::EVERY, static_cast<uint32_t>(n));
+    }
+
+    throw std::runtime_error("Invalid SOURCE policy '" + s + "'. Use 'block', "
+                             "'drop' or 'every-N' for some N > 0.");
+}
+
+}       /* namespace oat */
+#endif	/* OAT_SOURCEPOLICY_H */
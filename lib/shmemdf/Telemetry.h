@@ -0,0 +1,179 @@
+//******************************************************************************
+//* File:   Telemetry.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TELEMETRY_H
+#define	OAT_TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace oat {
+
+/**
+ * @brief Nanoseconds on the monotonic clock. On Linux, this clock is shared by
+ * all processes, so timestamps written into shared memory by different
+ * components can be compared.
+ */
+inline uint64_t steadyNanoseconds(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Add to a counter that only one thread writes. Cheaper than an atomic
+ * read-modify-write, and readers in other processes still never see a torn
+ * value.
+ */
+inline void bump(std::atomic<uint64_t> &counter, const uint64_t n = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+}
+
+/**
+ * @brief Raise a running maximum. Unlike bump(), the maximum may be reset by
+ * a reader, e.g. once per snapshot, so this is a compare-and-swap.
+ */
+inline void raiseMax(std::atomic<uint64_t> &max, const uint64_t n)
+{
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (n > seen
+           && !max.compare_exchange_weak(seen, n, std::memory_order_relaxed))
+        ;
+}
+
+/**
+ * @brief Time the calling thread's SINKs and SOURCEs have spent blocked, and
+ * the samples they lost. There is one per thread, like the tracer, so that
+ * components can attribute it to themselves by differencing it around their
+ * work.
+ */
+struct NodeActivity {
+    uint64_t source_wait_ns {0}; //!< Waiting for SINKs to publish
+    uint64_t sink_wait_ns {0}; //!< Waiting for SOURCEs to free a buffer
+    uint64_t overruns {0}; //!< Writes that found the ring full
+    uint64_t dropped {0}; //!< Samples SOURCEs missed beyond their policy
+};
+
+/**
+ * @brief The calling thread's node activity.
+ */
+inline NodeActivity &nodeActivity(void)
+{
+    static thread_local NodeActivity activity;
+    return activity;
+}
+
+/**
+ * @brief Fixed-size latency histogram that can live in shared memory. Bucket 0
+ * counts zero durations and bucket i > 0 counts durations in [2^(i-1),
+ * 2^i) ns. The last bucket also counts everything longer. Must only be
+ * recorded to by a single thread, but can be read by anyone at any time.
+ */
+class LatencyHistogram {
+public:
+
+    static constexpr size_t NUM_BUCKETS {32};
+
+    LatencyHistogram() { clear(); }
+
+    void clear(void)
+    {
+        for (auto &b : buckets_)
+            b.store(0, std::memory_order_relaxed);
+    }
+
+    void record(const uint64_t ns)
+    {
+        size_t i = 0;
+        for (uint64_t v = ns; v != 0 && i < NUM_BUCKETS - 1; v >>= 1)
+            i++;
+        bump(buckets_[i]);
+    }
+
+    using Counts = std::array<uint64_t, NUM_BUCKETS>;
+
+    uint64_t count(const size_t bucket) const
+    {
+        return buckets_[bucket].load(std::memory_order_relaxed);
+    }
+
+    // Copy of all bucket counts, e.g. to difference against a later copy
+    Counts counts(void) const
+    {
+        Counts c;
+        for (size_t i = 0; i < NUM_BUCKETS; i++)
+            c[i] = count(i);
+        return c;
+    }
+
+    uint64_t total(void) const
+    {
+        uint64_t n = 0;
+        for (auto c : counts())
+            n += c;
+        return n;
+    }
+
+    // Exclusive upper edge of a bucket in ns
+    static uint64_t upper_bound(const size_t bucket)
+    {
+        return uint64_t(1) << bucket;
+    }
+
+    /**
+     * @brief Estimate a quantile of a set of bucket counts.
+     * @param counts Bucket counts.
+     * @param q Quantile in [0, 1].
+     * @return Upper edge of the bucket holding the quantile in ns, or 0 if
+     * the counts are all zero.
+     */
+    static uint64_t quantile(const Counts &counts, const double q)
+    {
+        uint64_t n = 0;
+        for (auto c : counts)
+            n += c;
+        if (n == 0)
+            return 0;
+
+        const uint64_t rank = static_cast<uint64_t>(q * (n - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank)
+                return i == 0 ? 0 : upper_bound(i);
+        }
+
+        return upper_bound(NUM_BUCKETS - 1);
+    }
+
+    // Estimate a quantile of the recorded durations
+    uint64_t quantile(const double q) const { return quantile(counts(), q); }
+
+private:
+
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_TELEMETRY_H */
@@ -0,0 +1,208 @@
+//******************************************************************************
+//* File:   Trace.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TRACE_H
+#define	OAT_TRACE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/syscall.h>
+#include <type_traits>
+#include <unistd.h>
+
+#include "Telemetry.h"
+
+namespace oat {
+
+/**
+ * @brief Latency trace of a single sample. Each node keeps one next to each
+ * of its buffers. It holds the time the sample was acquired by the pure SINK
+ * at the head of the chain and, for each component the sample then passed
+ * through on its way to the node, when that component started and finished
+ * with it. All times are on the monotonic clock, so traces written by
+ * different processes on the same host can be compared.
+ */
+struct Trace {
+
+    static constexpr size_t MAX_STAGES {8};
+    static constexpr size_t NODE_LEN {32};
+
+    struct Stage {
+        uint64_t enter_ns; //!< When the component read the sample
+        uint64_t exit_ns; //!< When it published its result
+        uint32_t pid;
+        uint32_t tid;
+        char node[NODE_LEN]; //!< Address it published to, possibly truncated
+    };
+
+    uint64_t sample; //!< Sample number at the pure SINK
+    uint64_t acquired_ns; //!< When the pure SINK began writing the sample
+    uint32_t stages; //!< Stages in use. Zero if the buffer was never written.
+    uint32_t dropped; //!< Stages that did not fit
+    Stage stage[MAX_STAGES];
+};
+
+static_assert(std::is_trivially_copyable<Trace>::value,
+              "Traces are copied in and out of shared memory.");
+
+/**
+ * @brief Carries the trace of the sample a component is working on from the
+ * nodes it reads to the nodes it writes. There is one per thread, so
+ * components running as threads of a single process do not mix up their
+ * samples. SOURCEs and SINKs update it as they wait and post, so components
+ * do not need to do anything.
+ *
+ * A component's work on a sample starts when it first reads it, or, for a
+ * pure SINK, when it first waits to write it. It ends each time it publishes
+ * a result. If a component reads several nodes to produce one result, the
+ * trace of the oldest sample is carried forward, because that is the one that
+ * determines how stale the result is.
+ */
+class Tracer {
+public:
+
+    /**
+     * @brief Record that a SOURCE read a sample.
+     * @param t Trace of the sample that was read.
+     */
+    void read(const Trace &t)
+    {
+        begin();
+
+        // Buffers that were never written have nothing to carry
+        const uint32_t n = std::min<uint32_t>(t.stages, Trace::MAX_STAGES);
+        if (n == 0 || (carried_ && t.acquired_ns >= in_.acquired_ns))
+            return;
+
+        in_.sample = t.sample;
+        in_.acquired_ns = t.acquired_ns;
+        in_.stages = n;
+        in_.dropped = t.dropped;
+        std::memcpy(in_.stage, t.stage, n * sizeof(Trace::Stage));
+        carried_ = true;
+    }
+
+    /**
+     * @brief Record that a SINK began waiting to write a sample.
+     */
+    void beginWrite(void) { begin(); }
+
+    /**
+     * @brief Record that a SINK published a sample.
+     * @param out Trace stored with the published buffer.
+     * @param node Address of the SINK's node.
+     * @param write_number Write number of the published buffer, used as the
+     * sample number if this SINK is at the head of the chain.
+     */
+    void write(Trace &out, const std::string &node, const uint64_t write_number)
+    {
+        const uint64_t now = steadyNanoseconds();
+        if (enter_ns_ == 0)
+            enter_ns_ = now;
+
+        if (carried_) {
+            out.sample = in_.sample;
+            out.acquired_ns = in_.acquired_ns;
+            out.stages = in_.stages;
+            out.dropped = in_.dropped;
+            std::memcpy(out.stage, in_.stage, in_.stages * sizeof(Trace::Stage));
+        } else {
+            out.sample = write_number;
+            out.acquired_ns = enter_ns_;
+            out.stages = 0;
+            out.dropped = 0;
+        }
+
+        if (out.stages == Trace::MAX_STAGES) {
+            out.dropped++;
+        } else {
+            auto &s = out.stage[out.stages++];
+            s.enter_ns = enter_ns_;
+            s.exit_ns = now;
+            s.pid = pid_;
+            s.tid = tid_;
+            std::strncpy(s.node, node.c_str(), Trace::NODE_LEN - 1);
+            s.node[Trace::NODE_LEN - 1] = '\0';
+        }
+
+        published_ = true;
+    }
+
+    /**
+     * @brief Stop tracing the sample this thread is working on so that
+     * another thread can finish it, e.g. the write stage of a pipelined
+     * component. This thread starts a new sample when it next reads.
+     * @return State to pass to the other thread's resume().
+     */
+    Tracer suspend(void)
+    {
+        Tracer t = *this;
+        published_ = true;
+        return t;
+    }
+
+    /**
+     * @brief Continue tracing a sample that another thread suspended.
+     * @param t Result of the other thread's suspend().
+     */
+    void resume(const Tracer &t)
+    {
+        in_ = t.in_;
+        carried_ = t.carried_;
+        published_ = t.published_;
+        enter_ns_ = t.enter_ns_;
+    }
+
+private:
+
+    // Start working on a new sample if the last one was published
+    void begin(void)
+    {
+        if (published_) {
+            carried_ = false;
+            enter_ns_ = 0;
+            published_ = false;
+        }
+
+        if (enter_ns_ == 0)
+            enter_ns_ = steadyNanoseconds();
+    }
+
+    Trace in_; //!< Trace of the oldest sample read, if carried_
+    bool carried_ {false};
+    bool published_ {false};
+    uint64_t enter_ns_ {0};
+    uint32_t pid_ {static_cast<uint32_t>(getpid())};
+    uint32_t tid_ {static_cast<uint32_t>(syscall(SYS_gettid))};
+};
+
+/**
+ * @brief The calling thread's tracer.
+ */
+inline Tracer &tracer(void)
+{
+    static thread_local Tracer t;
+    return t;
+}
+
+}       /* namespace oat */
+#endif	/* OAT_TRACE_H */
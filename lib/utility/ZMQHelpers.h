@@ -20,6 +20,10 @@
 #ifndef OAT_ZMQHELPERS_H
 #define OAT_ZMQHELPERS_H
 
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include <zmq.hpp>
 
 namespace oat {
@@ -62,6 +66,19 @@ inline bool sendReqEnvelope(zmq::socket_t *socket,
     return good;
 }
 
+inline std::vector<std::string> recvMultipart(zmq::socket_t *socket)
+{
+    std::vector<std::string> parts;
+    int more = 1;
+    size_t more_size = sizeof(more);
+    while (more) {
+        parts.push_back(recvString(socket));
+        socket->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+    }
+
+    return parts;
+}
+
 inline bool recvReqEnvelope(zmq::socket_t *socket,
                            std::string &id,
                            std::string &data)
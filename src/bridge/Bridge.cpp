@@ -0,0 +1,93 @@
+//******************************************************************************
+//* File:   Bridge.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Bridge.h"
+
+#include <string>
+
+namespace oat {
+
+namespace {
+
+// Time that blocking socket calls wait before checking oat::quit
+constexpr int POLL_MS {100};
+
+// Time that queued samples, including END, have to reach the other side
+// after the bridge exits
+constexpr int LINGER_MS {1000};
+
+} /* namespace */
+
+Bridge::Bridge(const std::string &source_address,
+               const std::string &sink_address,
+               const int socket_type)
+: Component()
+, name_("bridge[" + source_address + "->" + sink_address + "]")
+, address_(isEndpoint(source_address) ? sink_address : source_address)
+, endpoint_(isEndpoint(source_address) ? source_address : sink_address)
+, socket_(context_, socket_type)
+{
+    // Nothing
+}
+
+po::options_description Bridge::options() const
+{
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("hwm", po::value<int>(),
+         "Number of samples that can be in flight between the two sides of "
+         "the bridge before the sending side blocks. Higher values ride out "
+         "network hiccups at the cost of latency and memory. Defaults to 10.")
+        ;
+
+    return local_opts;
+}
+
+void Bridge::applyConfiguration(const po::variables_map &vm,
+                                const config::OptionTable &config_table)
+{
+    // High water mark
+    oat::config::getNumericValue<int>(vm, config_table, "hwm", hwm_, 1);
+
+    socket_.setsockopt(ZMQ_SNDHWM, &hwm_, sizeof(hwm_));
+    socket_.setsockopt(ZMQ_RCVHWM, &hwm_, sizeof(hwm_));
+    socket_.setsockopt(ZMQ_SNDTIMEO, &POLL_MS, sizeof(POLL_MS));
+    socket_.setsockopt(ZMQ_RCVTIMEO, &POLL_MS, sizeof(POLL_MS));
+    socket_.setsockopt(ZMQ_LINGER, &LINGER_MS, sizeof(LINGER_MS));
+
+    open();
+}
+
+bool Bridge::send(zmq::message_t &message, const int flags)
+{
+    while (!quit) {
+        if (socket_.send(message, flags))
+            return true;
+    }
+
+    return false;
+}
+
+bool Bridge::recv(zmq::message_t &message)
+{
+    return socket_.recv(&message);
+}
+
+} /* namespace oat */
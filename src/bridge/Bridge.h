@@ -0,0 +1,108 @@
+//******************************************************************************
+//* File:   Bridge.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGE_H
+#define	OAT_BRIDGE_H
+
+#include <string>
+
+#include <zmq.hpp>
+
+#include "../../lib/base/Component.h"
+#include "../../lib/base/Configurable.h"
+
+#include "BridgeWire.h"
+
+namespace oat {
+
+/**
+ * Abstract bridge. A bridge carries the samples of a node between hosts over
+ * a ZMQ PUSH/PULL connection. All concrete bridges implement this ABC.
+ */
+class Bridge : public Component, public Configurable<false> {
+
+public:
+
+    /**
+     * @brief Abstract Bridge.
+     * @param source_address SOURCE node address or ZMQ endpoint
+     * @param sink_address SINK node address or ZMQ endpoint
+     * @param socket_type ZMQ_PUSH to send or ZMQ_PULL to receive
+     */
+    Bridge(const std::string &source_address,
+           const std::string &sink_address,
+           const int socket_type);
+
+    // Component Interface
+    std::string name() const override { return name_; }
+    ComponentType type() const override { return ComponentType::bridge; }
+
+    /**
+     * @brief Check if an address is a ZMQ endpoint rather than a node.
+     * @param address SOURCE or SINK address
+     */
+    static bool isEndpoint(const std::string &address)
+    {
+        return address.find("://") != std::string::npos;
+    }
+
+protected:
+
+    // Configurable Interface
+    po::options_description options() const override;
+    void applyConfiguration(const po::variables_map &vm,
+                            const config::OptionTable &config_table) override;
+
+    /**
+     * @brief Bind or connect the socket to endpoint_. Called after socket
+     * options have been configured.
+     */
+    virtual void open(void) = 0;
+
+    /**
+     * @brief Send a message, retrying until it is queued or oat::quit is
+     * set. The queue holds up to high-water-mark samples that are still in
+     * flight, so sends are pipelined. When it is full this blocks, which
+     * pushes back on the upstream node as a local SOURCE would.
+     * @return True if the message was queued.
+     */
+    bool send(zmq::message_t &message, const int flags = 0);
+
+    /**
+     * @brief Receive a message, giving up after a short timeout so that
+     * oat::quit is honored.
+     * @return True if a message was received.
+     */
+    bool recv(zmq::message_t &message);
+
+    // Bridge name
+    const std::string name_;
+
+    // Node on this side of the bridge and endpoint on the other
+    const std::string address_;
+    const std::string endpoint_;
+
+    // Connection
+    zmq::context_t context_ {1};
+    zmq::socket_t socket_;
+    int hwm_ {10};
+};
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGE_H */
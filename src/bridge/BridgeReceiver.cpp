@@ -0,0 +1,233 @@
+//******************************************************************************
+//* File:   BridgeReceiver.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "BridgeReceiver.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <opencv2/imgcodecs.hpp>
+
+namespace oat {
+
+namespace {
+
+// Receive the next header. Returns false if none arrived before the receive
+// timeout.
+template <typename T>
+bool recvHeader(zmq::socket_t &socket, wire::Header &header)
+{
+    zmq::message_t head;
+    if (!socket.recv(&head))
+        return false;
+
+    if (head.size() != sizeof(header))
+        throw std::runtime_error("Received a message that was not sent by an "
+                                 "oat bridge.");
+
+    std::memcpy(&header, head.data(), sizeof(header));
+    wire::check(header, wire::token<T>());
+
+    return true;
+}
+
+// The parts of a message arrive together, so the payload never times out
+void recvPayload(zmq::socket_t &socket, zmq::message_t &payload)
+{
+    if (!socket.recv(&payload))
+        throw std::runtime_error("Received a sample without a payload.");
+}
+
+// Reject frame geometry that does not describe a frame the node can hold.
+// Returns the bytes in each packed row.
+size_t checkGeometry(const wire::Header &header, const uint64_t capacity)
+{
+    if (header.rows <= 0 || header.cols <= 0)
+        throw std::runtime_error("Received a frame without rows or columns.");
+
+    if (header.color < 0 || header.color >= oat::PIX_COUNT
+        || header.type != oat::cv_type(static_cast<oat::PixelColor>(header.color)))
+        throw std::runtime_error("Received a frame of an unknown color or "
+                                 "type.");
+
+    const uint64_t row_bytes
+        = static_cast<uint64_t>(header.cols) * CV_ELEM_SIZE(header.type);
+    if (static_cast<uint64_t>(header.rows) * row_bytes > capacity)
+        throw std::runtime_error("Received a frame that is larger than the "
+                                 "node's capacity.");
+
+    return row_bytes;
+}
+
+} /* namespace */
+
+template <typename T>
+BridgeReceiver<T>::BridgeReceiver(const std::string &endpoint,
+                                  const std::string &sink_address)
+: Bridge(endpoint, sink_address, ZMQ_PULL)
+{
+    // Nothing
+}
+
+template <typename T>
+void BridgeReceiver<T>::open()
+{
+    socket_.connect(endpoint_);
+}
+
+template <typename T>
+bool BridgeReceiver<T>::connectToNode()
+{
+    // The node is bound when the first sample, which carries the upstream
+    // node's metadata, arrives
+    return true;
+}
+
+template <typename T>
+int BridgeReceiver<T>::process()
+{
+    // Check oat::quit if nothing arrived
+    wire::Header header;
+    if (!recvHeader<T>(socket_, header))
+        return 0;
+
+    if (header.token == wire::Token::end)
+        return 1;
+
+    zmq::message_t payload;
+    recvPayload(socket_, payload);
+    if (payload.size() != sizeof(T) + sizeof(oat::Metadata<T>)
+        || header.bytes != sizeof(T))
+        throw std::runtime_error("Received a token of the wrong size. Both "
+                                 "sides of a bridge must run the same build "
+                                 "of Oat.");
+
+    // Tokens carry their own sample information
+    T token;
+    auto src = static_cast<const char *>(payload.data());
+    std::memcpy(static_cast<void *>(&token), src, sizeof(T));
+
+    // Publish the upstream node's metadata
+    if (!bound_) {
+        oat::Metadata<T> metadata;
+        std::memcpy(static_cast<void *>(&metadata), src + sizeof(T),
+                    sizeof(metadata));
+        sink_.set_metadata(metadata);
+        sink_.bind(address_);
+        bound_ = true;
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    sink_.wait();
+
+    *sink_.retrieve() = token;
+
+    // Tell sources there is new data
+    sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return 0;
+}
+
+template <>
+int BridgeReceiver<oat::Frame>::process()
+{
+    // Check oat::quit if nothing arrived
+    wire::Header header;
+    if (!recvHeader<oat::Frame>(socket_, header))
+        return 0;
+
+    if (header.token == wire::Token::end)
+        return 1;
+
+    zmq::message_t payload;
+    recvPayload(socket_, payload);
+
+    // Until the node is bound, frames must fit the capacity it will be bound
+    // with
+    const size_t row_bytes
+        = checkGeometry(header, bound_ ? capacity_ : header.capacity);
+    const auto color = static_cast<oat::PixelColor>(header.color);
+
+    if (header.codec == wire::Codec::raw) {
+        if (payload.size() != header.bytes
+            || header.bytes != header.rows * row_bytes)
+            throw std::runtime_error("Received a frame of the wrong size.");
+    } else {
+        cv::Mat encoded(1, payload.size(), CV_8UC1, payload.data());
+        decoded_ = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+        if (decoded_.rows != header.rows || decoded_.cols != header.cols
+            || decoded_.type() != header.type)
+            throw std::runtime_error("Received a frame that could not be "
+                                     "decoded.");
+    }
+
+    // Bind the node to hold the largest frame the upstream SINK can publish
+    if (!bound_) {
+        sink_.bind(address_, header.capacity);
+        sink_.retrieve(header.rows, header.cols, header.type, color);
+        capacity_ = header.capacity;
+        bound_ = true;
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    sink_.wait();
+
+    auto frame = sink_.retrieve();
+
+    // Follow the upstream SINK if its frame geometry changed
+    if (frame.rows != header.rows || frame.cols != header.cols
+        || frame.type() != header.type || frame.color() != color)
+        frame = sink_.reshape(header.rows, header.cols, header.type, color);
+
+    if (header.codec == wire::Codec::raw) {
+        auto src = static_cast<const uchar *>(payload.data());
+        for (int i = 0; i < frame.rows; i++)
+            std::memcpy(frame.ptr(i), src + i * row_bytes, row_bytes);
+    } else {
+        decoded_.copyTo(frame);
+    }
+
+    // Keep the upstream sample number and timing
+    frame.set_sample(header.sample);
+
+    // Tell sources there is new data
+    sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return 0;
+}
+
+// Explicit instantiations
+template class oat::BridgeReceiver<oat::Frame>;
+template class oat::BridgeReceiver<oat::Position2D>;
+template class oat::BridgeReceiver<oat::PositionList>;
+
+} /* namespace oat */
@@ -0,0 +1,70 @@
+//******************************************************************************
+//* File:   BridgeReceiver.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGERECEIVER_H
+#define	OAT_BRIDGERECEIVER_H
+
+#include "Bridge.h"
+
+#include <cstdint>
+#include <string>
+
+#include "../../lib/shmemdf/Sink.h"
+
+namespace oat {
+
+/**
+ * Receiving side of a bridge. Pulls samples from the sending side and
+ * publishes them to a local node with their original sample numbers and
+ * timing.
+ */
+template <typename T>
+class BridgeReceiver : public Bridge {
+
+public:
+
+    /**
+     * @brief Receiving side of a bridge.
+     * @param endpoint ZMQ endpoint to connect to
+     * @param sink_address SINK node address
+     */
+    BridgeReceiver(const std::string &endpoint,
+                   const std::string &sink_address);
+
+protected:
+
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+private:
+
+    void open(void) override;
+
+    // Sink
+    oat::Sink<T> sink_;
+
+    // Bound once the first sample describes the node
+    bool bound_ {false};
+    uint64_t capacity_ {0};
+    cv::Mat decoded_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGERECEIVER_H */
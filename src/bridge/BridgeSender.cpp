@@ -0,0 +1,256 @@
+//******************************************************************************
+//* File:   BridgeSender.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "BridgeSender.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+
+namespace oat {
+
+template <typename T>
+BridgeSender<T>::BridgeSender(const std::string &source_address,
+                              const std::string &endpoint)
+: Bridge(source_address, endpoint, ZMQ_PUSH)
+{
+    // Nothing
+}
+
+template <typename T>
+po::options_description BridgeSender<T>::options() const
+{
+    return Bridge::options();
+}
+
+template <>
+po::options_description BridgeSender<oat::Frame>::options() const
+{
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("compress", po::value<std::string>(),
+         "Encode frames before sending them. Values:\n"
+         "  none: Send raw pixels (default).\n"
+         "  png: Lossless. 8- or 16-bit frames with 1, 3 or 4 channels.\n"
+         "  jpeg: Lossy. 8-bit frames with 1 or 3 channels.")
+        ("quality", po::value<int>(),
+         "JPEG quality, 0 to 100. Defaults to 95.")
+        ;
+
+    local_opts.add(Bridge::options());
+
+    return local_opts;
+}
+
+template <typename T>
+void BridgeSender<T>::applyConfiguration(
+    const po::variables_map &vm, const config::OptionTable &config_table)
+{
+    Bridge::applyConfiguration(vm, config_table);
+}
+
+template <>
+void BridgeSender<oat::Frame>::applyConfiguration(
+    const po::variables_map &vm, const config::OptionTable &config_table)
+{
+    // Frame encoding
+    std::string compress;
+    if (oat::config::getValue<std::string>(
+            vm, config_table, "compress", compress)) {
+        if (compress == "none")
+            codec_ = wire::Codec::raw;
+        else if (compress == "png")
+            codec_ = wire::Codec::png;
+        else if (compress == "jpeg" || compress == "jpg")
+            codec_ = wire::Codec::jpeg;
+        else
+            throw std::runtime_error("Unknown compression '" + compress
+                                     + "'.");
+    }
+
+    oat::config::getNumericValue<int>(
+        vm, config_table, "quality", quality_, 0, 100);
+
+    Bridge::applyConfiguration(vm, config_table);
+}
+
+template <typename T>
+void BridgeSender<T>::open()
+{
+    socket_.bind(endpoint_);
+}
+
+template <typename T>
+bool BridgeSender<T>::connectToNode()
+{
+    // Establish our a slot in the node
+    source_.touch(address_);
+
+    // Wait for sychronous start with sink when it binds the node
+    return source_.connect() == SourceState::CONNECTED;
+}
+
+template <typename T>
+int BridgeSender<T>::process()
+{
+    wire::Header header;
+    header.token = wire::token<T>();
+    header.bytes = sizeof(T);
+    zmq::message_t payload(sizeof(T) + sizeof(oat::Metadata<T>));
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sink to write to node
+    if (source_.wait() == oat::NodeState::END) {
+        sendEnd();
+        return 1;
+    }
+
+    // Tokens carry their own sample information. The metadata lets the
+    // receiving bridge's SINK publish the same per-node information.
+    auto dst = static_cast<char *>(payload.data());
+    std::memcpy(dst, source_.retrieve(), sizeof(T));
+    std::memcpy(dst + sizeof(T), &source_.metadata(), sizeof(oat::Metadata<T>));
+
+    // Tell sink it can continue
+    source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    zmq::message_t head(sizeof(header));
+    std::memcpy(head.data(), &header, sizeof(header));
+
+    // Returns once the sample is queued so that the next one can be read
+    // while this one is in flight
+    if (!send(head, ZMQ_SNDMORE) || !send(payload))
+        return 1;
+
+    return 0;
+}
+
+template <>
+int BridgeSender<oat::Frame>::process()
+{
+    wire::Header header;
+    header.token = wire::Token::frame;
+    header.codec = codec_;
+    zmq::message_t payload;
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sink to write to node
+    if (source_.wait() == oat::NodeState::END) {
+        sendEnd();
+        return 1;
+    }
+
+    const oat::Frame *frame = source_.retrieve();
+    header.sample = frame->sample();
+    header.capacity = source_.capacity();
+    header.rows = frame->rows;
+    header.cols = frame->cols;
+    header.type = frame->type();
+    header.color = frame->color();
+    header.bytes = frame->total() * frame->elemSize();
+
+    if (codec_ == wire::Codec::raw) {
+
+        // Pack rows, which may be padded in the node
+        payload.rebuild(header.bytes);
+        const size_t row_bytes = frame->cols * frame->elemSize();
+        auto dst = static_cast<uchar *>(payload.data());
+        for (int i = 0; i < frame->rows; i++)
+            std::memcpy(dst + i * row_bytes, frame->ptr(i), row_bytes);
+
+        // Tell sink it can continue
+        source_.post();
+
+    } else {
+
+        // Encode outside of the critical section so the SINK is not held up
+        static_cast<const cv::Mat &>(*frame).copyTo(pixels_);
+
+        // Tell sink it can continue
+        source_.post();
+    }
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    if (codec_ != wire::Codec::raw) {
+
+        const int depth = pixels_.depth();
+        const int channels = pixels_.channels();
+        bool ok;
+
+        if (codec_ == wire::Codec::png) {
+            if ((depth != CV_8U && depth != CV_16U)
+                || (channels != 1 && channels != 3 && channels != 4))
+                throw std::runtime_error("PNG compression requires 8- or "
+                                         "16-bit frames with 1, 3 or 4 "
+                                         "channels.");
+            ok = cv::imencode(".png", pixels_, encoded_,
+                              {cv::IMWRITE_PNG_COMPRESSION, 1});
+        } else {
+            if (depth != CV_8U || (channels != 1 && channels != 3))
+                throw std::runtime_error("JPEG compression requires 8-bit "
+                                         "frames with 1 or 3 channels.");
+            ok = cv::imencode(".jpg", pixels_, encoded_,
+                              {cv::IMWRITE_JPEG_QUALITY, quality_});
+        }
+
+        if (!ok)
+            throw std::runtime_error("Could not encode frame.");
+
+        payload.rebuild(encoded_.size());
+        std::memcpy(payload.data(), encoded_.data(), encoded_.size());
+    }
+
+    zmq::message_t head(sizeof(header));
+    std::memcpy(head.data(), &header, sizeof(header));
+
+    // Returns once the frame is queued so that the next one can be read
+    // while this one is in flight
+    if (!send(head, ZMQ_SNDMORE) || !send(payload))
+        return 1;
+
+    return 0;
+}
+
+template <typename T>
+void BridgeSender<T>::sendEnd()
+{
+    wire::Header header;
+    zmq::message_t head(sizeof(header));
+    std::memcpy(head.data(), &header, sizeof(header));
+    send(head);
+}
+
+// Explicit instantiations
+template class oat::BridgeSender<oat::Frame>;
+template class oat::BridgeSender<oat::Position2D>;
+template class oat::BridgeSender<oat::PositionList>;
+
+} /* namespace oat */
@@ -0,0 +1,78 @@
+//******************************************************************************
+//* File:   BridgeSender.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGESENDER_H
+#define	OAT_BRIDGESENDER_H
+
+#include "Bridge.h"
+
+#include <string>
+#include <vector>
+
+#include "../../lib/shmemdf/Source.h"
+
+namespace oat {
+
+/**
+ * Sending side of a bridge. Reads samples from a local node and pushes them
+ * to the receiving side, which binds the matching node on its host.
+ */
+template <typename T>
+class BridgeSender : public Bridge {
+
+public:
+
+    /**
+     * @brief Sending side of a bridge.
+     * @param source_address SOURCE node address
+     * @param endpoint ZMQ endpoint to bind
+     */
+    BridgeSender(const std::string &source_address,
+                 const std::string &endpoint);
+
+protected:
+
+    // Configurable Interface
+    po::options_description options() const override;
+    void applyConfiguration(const po::variables_map &vm,
+                            const config::OptionTable &config_table) override;
+
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+private:
+
+    void open(void) override;
+
+    // Tell the receiving side that the stream has ended
+    void sendEnd(void);
+
+    // Source
+    oat::Source<T> source_;
+
+    // Frame encoding
+    wire::Codec codec_ {wire::Codec::raw};
+    int quality_ {95};
+    cv::Mat pixels_;
+    std::vector<uchar> encoded_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGESENDER_H */
@@ -0,0 +1,109 @@
+//******************************************************************************
+//* File:   BridgeWire.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGEWIRE_H
+#define	OAT_BRIDGEWIRE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "../../lib/datatypes/Frame.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList.h"
+#include "../../lib/datatypes/Sample.h"
+
+namespace oat {
+namespace wire {
+
+/**
+ * Each sample crosses the network as a two part ZMQ message: a Header
+ * followed by a payload. The payload of a token is its bytes followed by those
+ * of its node's Metadata, so both ends of a bridge must run the same build of
+ * Oat on the same architecture. The
+ * payload of a frame is its pixels, either packed row after row or encoded as
+ * an image. The END of a stream is a Header without a payload.
+ */
+static constexpr uint32_t MAGIC {0x4f415442}; // "OATB"
+static constexpr uint16_t VERSION {2};
+
+enum class Token : uint16_t {
+    end = 0,
+    frame,
+    position2D,
+    positionList
+};
+
+enum class Codec : uint16_t {
+    raw = 0, //!< Packed pixel rows
+    png,     //!< Lossless
+    jpeg     //!< Lossy
+};
+
+template <typename T> Token token();
+template <> inline Token token<oat::Frame>() { return Token::frame; }
+template <> inline Token token<oat::Position2D>() { return Token::position2D; }
+template <> inline Token token<oat::PositionList>() { return Token::positionList; }
+
+struct Header {
+
+    uint32_t magic {MAGIC};
+    uint16_t version {VERSION};
+    Token token {Token::end};
+    uint64_t bytes {0}; //!< Payload bytes before any encoding
+
+    // Sample number and timing, exactly as published upstream
+    oat::Sample sample;
+
+    // Frame geometry
+    uint64_t capacity {0}; //!< Largest frame, in bytes, the upstream SINK can publish
+    int32_t rows {0};
+    int32_t cols {0};
+    int32_t type {0};
+    int32_t color {0};
+    Codec codec {Codec::raw};
+};
+
+static_assert(std::is_trivially_copyable<Header>::value,
+              "wire::Header must be sendable as raw bytes.");
+
+/**
+ * @brief Check that a received header was sent by a compatible bridge.
+ * @param header Received header.
+ * @param expected Token the receiving bridge publishes.
+ */
+inline void check(const Header &header, const Token expected)
+{
+    if (header.magic != MAGIC)
+        throw std::runtime_error("Received a message that was not sent by an "
+                                 "oat bridge.");
+
+    if (header.version != VERSION)
+        throw std::runtime_error("Received a message from an incompatible "
+                                 "version of oat bridge.");
+
+    if (header.token != Token::end && header.token != expected)
+        throw std::runtime_error("Received a token whose TYPE does not match "
+                                 "this bridge's.");
+}
+
+}      /* namespace wire */
+}      /* namespace oat */
+#endif /* OAT_BRIDGEWIRE_H */
@@ -30,6 +30,7 @@
 
 #include "../../lib/base/Component.h"
 #include "../../lib/base/Configurable.h"
+#include "../../lib/base/Scheduling.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
 
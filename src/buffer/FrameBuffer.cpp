@@ -42,13 +42,14 @@ bool FrameBuffer::connectToNode()
     // Get frame meta data to format sink
     auto param = source_.parameters();
 
-    // Bind sink node
-    sink_.bind(sink_address_, param.bytes);
+    // Bind sink node. Leave room for the largest frame the source can
+    // publish in case it is reshaped.
+    sink_.bind(sink_address_, source_.capacity());
     shared_frame_
-        = sink_.retrieve(param.rows, param.cols, param.type, param.color);
+        = sink_.retrieve(param.rows, param.cols, param.type, param.color, param.step);
 
     // Start consumer thread
-    sink_thread_ = std::thread(&FrameBuffer::pop, this);
+    sink_thread_ = oat::startHelper([this] { pop(); });
 
     return true;
 }
@@ -100,11 +101,19 @@ void FrameBuffer::pop()
 
             // Wait for sources to read
             sink_.wait();
+            shared_frame_ = sink_.retrieve();
 
             // TODO: use specialized spsc allocator for popping somehow?
-            buffer_.consume_one(
-                [this](oat::Frame frame){ frame.copyTo(shared_frame_); }
-            );
+            buffer_.consume_one([this](oat::Frame frame) {
+
+                // Follow the source if its frame geometry changed
+                if (frame.size() != shared_frame_.size()
+                    || frame.type() != shared_frame_.type())
+                    shared_frame_ = sink_.reshape(
+                        frame.rows, frame.cols, frame.type(), frame.color());
+
+                frame.copyTo(shared_frame_);
+            });
 
             // Tell sources there is new data
             sink_.post();
@@ -42,11 +42,13 @@ bool TokenBuffer<T>::connectToNode()
     if (source_.connect() != SourceState::CONNECTED)
         return false;
 
-    sink_.bind(sink_address_, sink_address_);
+    // Forward the upstream node's metadata
+    sink_.set_metadata(source_.metadata());
+    sink_.bind(sink_address_);
     shared_token_ = sink_.retrieve();
 
     // Start consumer thread
-    sink_thread_ = std::thread(&TokenBuffer<T>::pop, this);
+    sink_thread_ = oat::startHelper([this] { pop(); });
 
     return true;
 }
@@ -100,6 +102,7 @@ void TokenBuffer<T>::pop()
 
             // Wait for sources to read
             sink_.wait();
+            shared_token_ = sink_.retrieve();
 
             buffer_.pop(*shared_token_);
 
@@ -114,5 +117,6 @@ void TokenBuffer<T>::pop()
 
 // Explicit instantiations
 template class oat::TokenBuffer<oat::Position2D>;
+template class oat::TokenBuffer<oat::PositionList>;
 
 } /* namespace oat */
@@ -25,6 +25,7 @@
 #include <boost/lockfree/spsc_queue.hpp>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList.h"
 
 namespace oat {
 
@@ -42,11 +42,13 @@
 namespace po = boost::program_options;
 
 using Pos2DBuffer = oat::TokenBuffer<oat::Position2D>;
+using PosListBuffer = oat::TokenBuffer<oat::PositionList>;
 
 const char usage_type[] =
     "TYPE\n"
     "  frame: Frame buffer\n"
-    "  pos2D: 2D Position buffer";
+    "  pos2D: 2D Position buffer\n"
+    "  poslist: 2D Position list buffer";
 
 const char usage_io[] =
     "SOURCE:\n"
@@ -95,6 +97,7 @@ int main(int argc, char *argv[])
     std::unordered_map<std::string, char> type_hash;
     type_hash["frame"] = 'a';
     type_hash["pos2D"] = 'b';
+    type_hash["poslist"] = 'c';
 
     // The component itself
     std::string comp_name = "buffer";
@@ -163,6 +166,11 @@ int main(int argc, char *argv[])
                     buffer = std::make_shared<Pos2DBuffer>(source, sink);
                     break;
                 }
+                case 'c':
+                {
+                    buffer = std::make_shared<PosListBuffer>(source, sink);
+                    break;
+                }
                 default:
                 {
                     printUsage(visible_options, "");
@@ -17,48 +17,78 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
 #include <unistd.h>
 
 #include "Controller.h"
 
-#include "../../lib/base/ControllableComponent.h"
+#include "../../lib/base/Component.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ZMQHelpers.h"
 
 namespace oat {
 
+// Discovery ends once no new component has registered for this long
+static constexpr std::chrono::milliseconds DISCOVERY_SETTLE {250};
+
+// Longest time discovery waits for components
+static constexpr std::chrono::milliseconds DISCOVERY_TIMEOUT {2000};
+
+// Longest time to wait for components to answer a stats or sample request
+static constexpr std::chrono::milliseconds REPLY_TIMEOUT {1000};
+
+// Time allowed to deliver commands to components on exit
+static constexpr int SEND_LINGER_MS {500};
+
 Controller::Controller(const char *endpoint)
 : ctx_(1)
 , router_(ctx_, ZMQ_ROUTER)
 {
-    router_.setsockopt(ZMQ_LINGER, 0);
+    router_.setsockopt(ZMQ_LINGER, SEND_LINGER_MS);
     router_.bind(endpoint);
 }
 
-void Controller::send(const std::string &command)
+void Controller::broadcast(const std::string &command, const std::string &at)
 {
+    std::vector<Identity> targets;
     for (const auto &s : subscriptions_)
-        sendReqEnvelope(&router_, s.first, command);
+        targets.push_back(s.first);
+
+    std::string sample;
+    if (!resolveSample(at, targets, sample))
+        return;
+
+    for (const auto &id : targets)
+        dispatch(id, command, sample);
 }
 
-void Controller::send(const std::string &command, const std::string &target_id)
+void Controller::send(const std::string &command,
+                      const std::string &target_id,
+                      const std::string &at)
 {
     if (subscriptions_.count(target_id)) {
+        std::string sample;
         if (command == "help" || command == "Help")
             help(target_id);
-        else
-            sendReqEnvelope(&router_, target_id, command);
+        else if (command == CTRL_STATS)
+            std::cout << stats(target_id);
+        else if (resolveSample(at, {target_id}, sample))
+            dispatch(target_id, command, sample);
     } else {
         std::cerr << oat::Warn("Target is not available: " + target_id) << "\n";
     }
 }
 
-void Controller::send(const std::string &command, const Subs::size_type idx)
+void Controller::send(const std::string &command,
+                      const Subs::size_type idx,
+                      const std::string &at)
 {
     if (subscriptions_.size() <= idx) {
         std::cerr
@@ -67,49 +97,310 @@ void Controller::send(const std::string &command, const Subs::size_type idx)
     } else {
         auto s = subscriptions_.begin();
         std::advance(s, idx);
-        send(command, s->first);
+        send(command, s->first, at);
+    }
+}
+
+bool Controller::resolveSample(const std::string &at,
+                               const std::vector<Identity> &targets,
+                               std::string &sample)
+{
+    sample.clear();
+    if (at.empty())
+        return true;
+
+    const bool relative = at[0] == '+';
+    uint64_t n;
+    try {
+        size_t end;
+        n = std::stoull(at.substr(relative), &end);
+        if (end + relative != at.size() || at[relative] == '-')
+            throw std::invalid_argument(at);
+    } catch (const std::logic_error &) {
+        std::cerr << oat::Warn("Invalid sample: '" + at + "'. Use a sample "
+                               "count or +N.") << "\n";
+        return false;
+    }
+
+    sample = std::to_string(relative ? latestSample(targets) + n : n);
+    return true;
+}
+
+uint64_t Controller::latestSample(const std::vector<Identity> &targets)
+{
+    // Only components with commands of their own count samples
+    std::vector<Identity> counting;
+    for (const auto &id : targets) {
+        auto s = subscriptions_.find(id);
+        if (s != subscriptions_.end() && s->second.counts_samples)
+            counting.push_back(id);
+    }
+
+    // The counts that components report with their heartbeats can be
+    // seconds old, so ask for the current ones. The latest is taken so that
+    // none of the targets has passed the resolved sample.
+    const auto &replies = request(CTRL_SAMPLE, counting);
+
+    uint64_t latest = 0;
+    for (const auto &id : counting) {
+
+        auto r = replies.find(id);
+        if (r != replies.end()) {
+            latest = std::max<uint64_t>(
+                latest, std::strtoull(r->second.c_str(), nullptr, 10));
+            continue;
+        }
+
+        auto s = subscriptions_.find(id);
+        if (s == subscriptions_.end())
+            continue;
+
+        std::cerr << oat::Warn("No sample count from: " + id + ". Using the "
+                               "last one it reported.") << "\n";
+        latest = std::max(latest, s->second.sample);
+    }
+
+    return latest;
+}
+
+const std::map<Controller::Identity, std::string> &
+Controller::request(const std::string &what, const std::vector<Identity> &targets)
+{
+    auto &replies = replies_[what];
+    replies.clear();
+
+    for (const auto &id : targets)
+        sendReqEnvelope(&router_, id, what);
+
+    auto answered = [&replies, &targets] {
+        for (const auto &id : targets)
+            if (!replies.count(id))
+                return false;
+        return true;
+    };
+
+    const auto deadline = Clock::now() + REPLY_TIMEOUT;
+    while (!answered()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             deadline - Clock::now()).count();
+        if (remaining <= 0)
+            break;
+        update(remaining);
+    }
+
+    return replies;
+}
+
+void Controller::dispatch(const std::string &target_id,
+                          const std::string &command,
+                          const std::string &sample)
+{
+    if (sample.empty()) {
+        sendReqEnvelope(&router_, target_id, command);
+        return;
+    }
+
+    sendStringMore(&router_, target_id);
+    sendStringMore(&router_, "");
+    sendStringMore(&router_, command);
+    sendString(&router_, sample);
+}
+
+void Controller::discover(const std::string &target_id)
+{
+    const auto deadline = Clock::now() + DISCOVERY_TIMEOUT;
+    auto settled = Clock::now() + DISCOVERY_SETTLE;
+
+    while (true) {
+
+        if (!target_id.empty() && subscriptions_.count(target_id))
+            return;
+
+        auto until = target_id.empty() ? std::min(deadline, settled) : deadline;
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             until - Clock::now()).count();
+        if (remaining <= 0)
+            return;
+
+        const auto known = subscriptions_.size();
+        update(remaining);
+        if (subscriptions_.size() > known)
+            settled = Clock::now() + DISCOVERY_SETTLE;
     }
 }
 
-void Controller::scan()
+int Controller::update(const long timeout_ms)
 {
-    // Clear subscriptions in preparation for update
-    subscriptions_.clear();
+    int handled = 0;
+    long timeout = timeout_ms;
 
-    // Poll the socket and find all existing connections
-    int retries_left = 100;
     while (true) {
 
         zmq::pollitem_t p[] = {{router_, 0, ZMQ_POLLIN, 0}};
-        zmq::poll(&p[0], 1, 10);
+        zmq::poll(&p[0], 1, timeout);
 
-        if (p[0].revents & ZMQ_POLLIN) {
+        if (!(p[0].revents & ZMQ_POLLIN))
+            break;
 
-            std::string id, name;
-            if (!recvReqEnvelope(&router_, id, name)) {
-                std::cerr << oat::Warn("Bad receive") << "\n";
-                continue;
-            }
+        receive(oat::recvMultipart(&router_));
+        handled++;
+
+        // Drain whatever else has arrived
+        timeout = 0;
+    }
+
+    expire();
+
+    return handled;
+}
+
+void Controller::receive(const std::vector<std::string> &msg)
+{
+    // Identity, delimeter, message type and, for hello, component info
+    if (msg.size() < 3 || msg[0].empty() || !msg[1].empty()) {
+        std::cerr << oat::Warn("Bad receive") << "\n";
+        return;
+    }
+
+    const auto &id = msg[0];
+    const auto &what = msg[2];
+
+    if (what == CTRL_HELLO && msg.size() == 4) {
+
+        if (addSubscriber(id, msg[3]))
+            std::cerr << oat::Warn("Invalid component: " + id + " " + msg[3])
+                      << "\n";
+
+    } else if (what == CTRL_HEARTBEAT) {
 
-            if (addSubscriber(id, name)) {
-                std::cerr << oat::Warn("Invalid component: " + id + " " + name)
-                          << "\n";
-                continue;
+        // Heartbeats carry the component's latest sample count
+        auto s = subscriptions_.find(id);
+        if (s != subscriptions_.end()) {
+            s->second.last_seen = Clock::now();
+            if (msg.size() == 4)
+                s->second.sample = std::strtoull(msg[3].c_str(), nullptr, 10);
+        }
+
+    } else if ((what == CTRL_STATS || what == CTRL_SAMPLE) && msg.size() == 4) {
+
+        // Replies to a request
+        replies_[what][id] = msg[3];
+        if (what == CTRL_SAMPLE) {
+            auto s = subscriptions_.find(id);
+            if (s != subscriptions_.end())
+                s->second.sample = std::strtoull(msg[3].c_str(), nullptr, 10);
+        }
+
+    } else if (what == CTRL_BYE) {
+        subscriptions_.erase(id);
+    } else {
+        std::cerr << oat::Warn("Bad receive") << "\n";
+    }
+}
+
+void Controller::expire()
+{
+    const auto dead_after
+        = std::chrono::milliseconds(HEARTBEAT_INTERVAL_MS * HEARTBEAT_LIVENESS);
+    const auto now = Clock::now();
+
+    for (auto s = subscriptions_.begin(); s != subscriptions_.end();) {
+        if (now - s->second.last_seen > dead_after)
+            s = subscriptions_.erase(s);
+        else
+            ++s;
+    }
+}
+
+void Controller::interact()
+{
+    std::string input;
+    char buffer[256];
+
+    while (true) {
+
+        // stdin is read directly rather than through std::cin so that no
+        // input is hidden from poll in a stream buffer
+        zmq::pollitem_t p[] = {{router_, 0, ZMQ_POLLIN, 0},
+                               {nullptr, STDIN_FILENO, ZMQ_POLLIN, 0}};
+        zmq::poll(&p[0], 2, HEARTBEAT_INTERVAL_MS);
+
+        update(0);
+
+        if (p[1].revents & ZMQ_POLLIN) {
+
+            const auto n = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n <= 0)
+                return;
+            input.append(buffer, n);
+
+            size_t end;
+            while ((end = input.find('\n')) != std::string::npos) {
+                const auto line = input.substr(0, end);
+                input.erase(0, end + 1);
+                if (!execute(line))
+                    return;
             }
+        }
+    }
+}
 
-        } else if (retries_left-- == 0) {
-            break;
+bool Controller::execute(const std::string &line)
+{
+    std::istringstream words(line);
+    std::string target, command, at;
+    words >> target >> command >> at;
+
+    if (target.empty())
+        return true;
+
+    if (target == "exit")
+        return false;
+
+    if (target == "list") {
+        std::cout << list();
+        return true;
+    }
+
+    if (target == CTRL_STATS) {
+        std::cout << stats();
+        return true;
+    }
+
+    if (command.empty()) {
+        std::cerr << oat::Warn("Usage: ID|INDEX|* COMMAND [SAMPLE|+N], list, "
+                               "stats, or exit") << "\n";
+        return true;
+    }
+
+    if (target == "*" && command == CTRL_STATS) {
+        std::cout << stats();
+    } else if (target == "*") {
+        broadcast(command, at);
+    } else if (target[0] == 'O') {
+        send(command, target, at);
+    } else {
+        try {
+            send(command,
+                 static_cast<Subs::size_type>(std::stoul(target)),
+                 at);
+        } catch (const std::logic_error &) {
+            std::cerr << oat::Warn("Target is not available: " + target)
+                      << "\n";
         }
     }
+
+    return true;
 }
 
 std::string Controller::list() const
 {
     const char sep = ' ';
     const int idx_width = 8;
-    const int id_width = 22;
+    const int id_width = 32;
     const int name_width = 30;
-    const int type_width = 3;
+    const int type_width = 6;
+    const int sample_width = 12;
     int idx = 0;
 
     std::stringstream ss;
@@ -117,6 +408,7 @@ std::string Controller::list() const
     ss << std::left << std::setw(id_width) << std::setfill(sep) << "ID";
     ss << std::left << std::setw(name_width) << std::setfill(sep) << "Name";
     ss << std::left << std::setw(type_width) << std::setfill(sep) << "Type";
+    ss << std::left << std::setw(sample_width) << std::setfill(sep) << "Sample";
     ss << "\n";
 
     for (const auto &p : subscriptions_) {
@@ -126,12 +418,45 @@ std::string Controller::list() const
         ss << std::left << std::setw(id_width) << std::setfill(sep) << p.first;
         ss << std::left << std::setw(name_width) << std::setfill(sep) << sub.name;
         ss << std::left << std::setw(type_width) << std::setfill(sep) << (int)sub.type;
+        ss << std::left << std::setw(sample_width) << std::setfill(sep)
+           << (sub.counts_samples ? std::to_string(sub.sample) : "-");
         ss << "\n";
     }
 
     return ss.str();
 }
 
+std::string Controller::stats(const std::string &target_id)
+{
+    // Pick up components that registered since we last looked
+    update(0);
+
+    std::vector<Identity> asked;
+    for (const auto &s : subscriptions_) {
+        if (target_id.empty() || s.first == target_id)
+            asked.push_back(s.first);
+    }
+
+    const auto &replies = request(CTRL_STATS, asked);
+
+    std::stringstream ss;
+    const char *sep = "\n";
+    ss << "{";
+    for (const auto &id : asked) {
+
+        if (!replies.count(id)) {
+            std::cerr << oat::Warn("No stats from: " + id) << "\n";
+            continue;
+        }
+
+        ss << sep << "\"" << id << "\":" << replies.at(id);
+        sep = ",\n";
+    }
+    ss << "\n}\n";
+
+    return ss.str();
+}
+
 int Controller::addSubscriber(const std::string &id_string,
                               const std::string &data)
 {
@@ -157,23 +482,33 @@ int Controller::addSubscriber(const std::string &id_string,
     assert(sub_info["name"].IsString());
     auto name = std::string(sub_info["name"].GetString());
 
-    // Get description and format
-    assert(sub_info.HasMember("commands"));
-    const rapidjson::Value &desc = sub_info["commands"];
-    assert(desc.IsObject());
-
+    // Get description and format. Components without runtime commands of
+    // their own send none.
     oat::CommandDescription desc_map;
-    for (auto &d : desc.GetObject()) {
+    if (sub_info.HasMember("commands")) {
 
-        assert(d.value.IsString());
-        desc_map.emplace(d.name.GetString(), d.value.GetString());
+        const rapidjson::Value &desc = sub_info["commands"];
+        assert(desc.IsObject());
+
+        for (auto &d : desc.GetObject()) {
+
+            assert(d.value.IsString());
+            desc_map.emplace(d.name.GetString(), d.value.GetString());
+        }
     }
 
-    // Add if this component is not already in hash
-    if (!subscriptions_.count(id_string)) {
-        subscriptions_.emplace(std::piecewise_construct,
-                     std::make_tuple(id_string),
-                     std::make_tuple(ctype, name, desc_map));
+    // Components say hello again when they reconnect, replacing what we knew
+    subscriptions_.erase(id_string);
+    subscriptions_.emplace(std::piecewise_construct,
+                 std::make_tuple(id_string),
+                 std::make_tuple(ctype, name, desc_map));
+
+    // Sample count when the component said hello. Components without
+    // commands do not count samples, so send none.
+    if (sub_info.HasMember("sample") && sub_info["sample"].IsUint64()) {
+        auto &sub = subscriptions_.at(id_string);
+        sub.counts_samples = true;
+        sub.sample = sub_info["sample"].GetUint64();
     }
 
     return 0;
@@ -186,6 +521,7 @@ void Controller::help(const std::string &target_id) const
         auto cmds = subscriptions_.at(target_id).commands;
         cmds.emplace("help", "Print this message.");
         cmds.emplace("quit", "Exit the program..");
+        cmds.emplace(CTRL_STATS, "Print runtime statistics as JSON.");
 
         size_t max_len = 7; // For "COMMAND"
         std::vector<std::string> keys;
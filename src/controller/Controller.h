@@ -17,32 +17,41 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //****************************************************************************
 
-#ifndef OAT_CONFIGURABLE_H
-#define OAT_CONFIGURABLE_H
+#ifndef OAT_CONTROLLER_H
+#define OAT_CONTROLLER_H
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rapidjson/document.h"
 #include "zmq.hpp"
 
-#include "../../lib/base/ControllableComponent.h"
+#include "../../lib/base/Component.h"
 
 namespace oat {
 
 class Controller {
 
+    using Clock = std::chrono::steady_clock;
+
     struct Subscriber {
         Subscriber(const oat::ComponentType type,
                    const std::string &name,
                    const oat::CommandDescription &commands)
         : type(type)
         , name(name)
-        , commands(commands) { }
+        , commands(commands)
+        , last_seen(Clock::now()) { }
 
         const oat::ComponentType type;
         const std::string name;
         const oat::CommandDescription commands;
+        Clock::time_point last_seen;
+        bool counts_samples {false}; //!< Reports its sample count
+        uint64_t sample {0}; //!< Last sample count the component reported
     };
 
 public:
@@ -53,17 +62,61 @@ public:
     Controller(const char *endpoint);
 
     /**
-     * @brief Find out which clients are available on the socket. Update
-     * subscriptions_ hash.
+     * @brief Wait for components to register. They say hello as soon as they
+     * connect to the endpoint, which they retry about every 100 ms while no
+     * controller is bound to it.
+     * @param target_id Return as soon as this component has registered. If
+     * empty, return once no new component has registered for a while.
+     */
+    void discover(const std::string &target_id = "");
+
+    /**
+     * @brief Handle registrations, heartbeats and goodbyes, waiting up to
+     * timeout_ms for the first, and drop components that have stopped
+     * sending heartbeats.
+     * @param timeout_ms Longest time to wait. 0 only handles messages that
+     * have already arrived.
+     * @return Number of messages handled.
+     */
+    int update(const long timeout_ms);
+
+    /**
+     * @brief Keep the registry up to date while executing commands read from
+     * standard input, one per line, until 'exit' or the end of input.
      */
-    void scan();
+    void interact();
 
-    void send(const std::string &cmd, const std::string &target_id);
-    void send(const std::string &cmd, const Subs::size_type idx);
-    void send(const std::string &cmd);
+    /**
+     * @brief Send a command to one or all components.
+     * @param cmd Command.
+     * @param target_id / idx Component to send to. All if omitted.
+     * @param at Sample at which components apply the command: a sample
+     * count, '+N' for N samples after the latest current count of the
+     * components sent to, which are asked for it first, or empty for their
+     * next sample.
+     */
+    void send(const std::string &cmd,
+              const std::string &target_id,
+              const std::string &at = "");
+    void send(const std::string &cmd,
+              const Subs::size_type idx,
+              const std::string &at = "");
+    void broadcast(const std::string &cmd, const std::string &at = "");
 
     std::string list(void) const;
 
+    /**
+     * @brief Ask components for a snapshot of their runtime statistics:
+     * samples processed, processing rate, process() latency percentiles,
+     * time spent waiting on nodes, overruns, dropped samples and resident
+     * memory. Components answer from their control thread, whatever their
+     * processing loop is doing.
+     * @param target_id Component to ask. All if empty.
+     * @return JSON object mapping the ID of each component that answered to
+     * its statistics.
+     */
+    std::string stats(const std::string &target_id = "");
+
     int addSubscriber(const std::string &identity,
                       const std::string &name);
 
@@ -72,6 +125,41 @@ private:
     void help(const std::string &target_id) const;
     //void printHelp(const oat::CommandDescription &cmds) const;
 
+    // Resolve a send() 'at' argument against the latest current sample
+    // count of the components sent to. False if it is malformed.
+    bool resolveSample(const std::string &at,
+                       const std::vector<Identity> &targets,
+                       std::string &sample);
+
+    // Ask components for their current sample count and return the latest.
+    // Components that do not answer in time count from the last count they
+    // reported. Components without commands do not count samples, so are
+    // skipped.
+    uint64_t latestSample(const std::vector<Identity> &targets);
+
+    // Send a request to components and wait until they have all replied or
+    // the reply timeout has passed. Returns the replies that arrived, by
+    // component.
+    const std::map<Identity, std::string> &
+    request(const std::string &what, const std::vector<Identity> &targets);
+
+    // Send a command, tagged with a sample if not empty
+    void dispatch(const std::string &target_id,
+                  const std::string &cmd,
+                  const std::string &sample);
+
+    // Handle a message from a component
+    void receive(const std::vector<std::string> &msg);
+
+    // Drop components that have missed HEARTBEAT_LIVENESS heartbeats
+    void expire(void);
+
+    // Execute an interactive command line. Returns false to exit.
+    bool execute(const std::string &line);
+
+    // Replies to the last request of each type
+    std::map<std::string, std::map<Identity, std::string>> replies_;
+
     // Hashed subscriptions
     Subs subscriptions_;
 
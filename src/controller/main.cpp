@@ -19,7 +19,9 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include <boost/program_options.hpp>
 #include <zmq.hpp>
@@ -34,6 +36,8 @@ void printUsage(po::options_description options) {
     std::cout << "Usage: control [INFO]\n"
               << "   or: control ENDPOINT [INFO]\n"
               << "   or: control ENDPOINT ID COMMAND\n"
+              << "   or: control ENDPOINT --interactive\n"
+              << "   or: control ENDPOINT --stats [PERIOD]\n"
               << "   or: control\n"
               << "Control running oat components.\n\n"
               << options << "\n";
@@ -52,6 +56,28 @@ int main(int argc, char *argv[]) {
             ("version,v", "Print version information.")
             ("list,l", "Print a list of controllable components, along with IDs " 
              "and valid commands, for the specified endpoint.")
+            ("interactive,i", "Keep track of the components at the specified "
+             "endpoint and send them commands read from standard input, one "
+             "per line: 'ID COMMAND', 'INDEX COMMAND', '* COMMAND' to send to "
+             "all components, 'list', 'stats', or 'exit'. Commands are sent as "
+             "soon as they are entered. Each COMMAND may be followed by a "
+             "sample, as for --at.")
+            ("stats,s", po::value<double>()->implicit_value(0),
+             "Print a JSON snapshot of the runtime statistics of every "
+             "component at the specified endpoint: samples processed, "
+             "processing rate, process() latency percentiles, time spent "
+             "waiting on SOURCEs and SINKs, overruns, dropped samples and "
+             "resident memory. If PERIOD is given, print one every PERIOD "
+             "seconds until interrupted. Rates and latencies cover the time "
+             "since the previous snapshot. Latency percentiles are the upper "
+             "edges of the power of two buckets that they fall in, so may "
+             "overstate them by up to 2x. Maxima are exact.")
+            ("at", po::value<std::string>(),
+             "Sample at which the component applies COMMAND: a sample count, "
+             "or '+N' for N samples after the component's current count, "
+             "which it is asked for first. Components that read the same "
+             "stream apply a command sent for the same sample at that very "
+             "sample. Defaults to the component's next sample.")
             ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -110,6 +136,38 @@ int main(int argc, char *argv[]) {
             std::cout << "Interpreter not implemented." << std::endl;
             return 0;
 
+        } else if ((variable_map.count("endpoint")
+                  && variable_map.count("interactive")
+                  && !variable_map.count("id")
+                  && !variable_map.count("command"))) {
+
+            auto endpoint = variable_map["endpoint"].as<std::string>();
+
+            oat::Controller ctrl(endpoint.c_str());
+            ctrl.discover();
+            std::cout << ctrl.list();
+            ctrl.interact();
+
+        } else if ((variable_map.count("endpoint")
+                  && variable_map.count("stats")
+                  && !variable_map.count("id")
+                  && !variable_map.count("command"))) {
+
+            auto endpoint = variable_map["endpoint"].as<std::string>();
+            auto period = variable_map["stats"].as<double>();
+            if (period < 0)
+                throw std::runtime_error("Stats period must be positive.");
+
+            oat::Controller ctrl(endpoint.c_str());
+            ctrl.discover();
+            std::cout << ctrl.stats() << std::flush;
+
+            while (period > 0) {
+                std::this_thread::sleep_for(
+                    std::chrono::duration<double>(period));
+                std::cout << ctrl.stats() << std::flush;
+            }
+
         } else if ((variable_map.count("endpoint") 
                   && !variable_map.count("id")
                   && !variable_map.count("command"))) {
@@ -117,7 +175,7 @@ int main(int argc, char *argv[]) {
             auto endpoint = variable_map["endpoint"].as<std::string>();
 
             oat::Controller ctrl(endpoint.c_str());
-            ctrl.scan();
+            ctrl.discover();
             std::cout << ctrl.list();
 
         } else if ((variable_map.count("endpoint") 
@@ -127,14 +185,21 @@ int main(int argc, char *argv[]) {
             auto endpoint = variable_map["endpoint"].as<std::string>();
             auto id = variable_map["id"].as<std::string>();
             auto command = variable_map["command"].as<std::string>();
-            
+            std::string at;
+            if (variable_map.count("at"))
+                at = variable_map["at"].as<std::string>();
+
             oat::Controller ctrl(endpoint.c_str());
-            ctrl.scan();
 
-            if (id[0] == 'O')
-                ctrl.send(command, id);
-            else
-                ctrl.send(command, std::stoi(id));
+            // Send as soon as the target has registered. Indices are only
+            // meaningful once every component has.
+            if (id[0] == 'O') {
+                ctrl.discover(id);
+                ctrl.send(command, id, at);
+            } else {
+                ctrl.discover();
+                ctrl.send(command, std::stoi(id), at);
+            }
 
         } else {
 
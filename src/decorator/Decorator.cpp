@@ -77,8 +77,7 @@ void Decorator::applyConfiguration(const po::variables_map &vm,
         if (!p_source_addrs.empty()) {
             for (auto &addr : p_source_addrs) {
 
-                oat::Position2D pos(addr);
-                positions_.push_back(std::move(pos));
+                positions_.push_back(oat::Position2D());
                 position_sources_.push_back(
                     oat::NamedSource<oat::Position2D>(
                         addr,
@@ -137,15 +136,30 @@ bool Decorator::connectToNode()
     oat::Source<oat::Frame>::FrameParams param =
             frame_source_.parameters();
 
-    // Bind to sink sink node and create a shared frame
-    frame_sink_.bind(frame_sink_address_, param.bytes);
-    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type, param.color);
+    // Bind to sink sink node and create a shared frame. Leave room for the
+    // largest frame the source can publish in case it is reshaped.
+    frame_sink_.bind(frame_sink_address_, frame_source_.capacity());
+    shared_frame_ = frame_sink_.retrieve(
+        param.rows, param.cols, param.type, param.color, param.step);
     all_ts.push_back(shared_frame_.sample_period_sec());
 
     if (!oat::checkSamplePeriods(all_ts, sample_rate_hz)) {
         std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz));
     }
 
+    // If we are drawing positions, get ready for that
+    if (decorate_position_) {
+        previous_positions_.push_back(oat::Point2D(0,0));
+        positions_found_.push_back(false);
+    }
+
+    setFrameGeometry(param);
+
+    return true;
+}
+
+void Decorator::setFrameGeometry(const oat::FrameParams &param)
+{
     // Set drawing parameters based on frame dimensions
     const size_t min_size = (param.rows < param.cols) ? param.rows : param.cols;
     position_circle_radius_ = std::ceil(symbol_scale_ * min_size);
@@ -153,19 +167,18 @@ bool Decorator::connectToNode()
     encode_bit_size_  =
         std::ceil(param.cols / 3 / sizeof(internal_frame_.sample_count()) / 8);
 
-    // If we are drawing positions, get ready for that
-    if (decorate_position_) {
-        previous_positions_.push_back(oat::Point2D(0,0));
-        positions_found_.push_back(false);
-        history_frame_ = cv::Mat::zeros(shared_frame_.size(), shared_frame_.type());
-    }
+    if (decorate_position_)
+        history_frame_ = cv::Mat::zeros(param.rows, param.cols, param.type);
 
-    return true;
+    frame_generation_ = param.generation;
 }
 
 int Decorator::process()
 {
     // 1. Get frame
+    // Decorate straight into the sink's back buffer. This does not block.
+    internal_frame_ = frame_sink_.acquireWriteBuffer();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
@@ -173,7 +186,15 @@ int Decorator::process()
     if (frame_source_.wait() == oat::NodeState::END)
         return 1;
 
-    // Clone the shared frame
+    // Follow the source if its frame geometry changed
+    auto param = frame_source_.parameters();
+    if (param.generation != frame_generation_) {
+        internal_frame_ = frame_sink_.reshape(
+            param.rows, param.cols, param.type, param.color, param.step);
+        setFrameGeometry(param);
+    }
+
+    // Copy the shared frame into the back buffer
     frame_source_.copyTo(internal_frame_);
 
     // Tell sink it can continue
@@ -197,27 +218,120 @@ int Decorator::process()
         //  END CRITICAL SECTION  //
     }
 
+    applyCommands(internal_frame_.sample_count());
+
     // Decorate frame
     drawOnFrame();
 
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sources to read
-    frame_sink_.wait();
+    // Wait for sources to read and publish the back buffer
+    frame_sink_.publish();
 
-    internal_frame_.copyTo(shared_frame_);
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // None of the sink's were at the END state
+    return 0;
+}
+
+bool Decorator::preparePipeline(const size_t depth)
+{
+    // Preallocate each slot to the SOURCE's current geometry
+    const auto param = frame_source_.parameters();
+    slots_ = std::vector<Slot>(depth);
+    for (auto &s : slots_) {
+        s.frame.create(param.rows, param.cols, param.type);
+        s.positions = positions_;
+    }
+
+    return true;
+}
 
-    // Tell sources there is new data
-    frame_sink_.post();
+int Decorator::readStage(const size_t slot)
+{
+    auto &s = slots_[slot];
+
+    // 1. Get frame
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sink to write to node
+    if (frame_source_.wait() == oat::NodeState::END)
+        return 1;
+
+    // Copy the shared frame
+    s.param = frame_source_.parameters();
+    frame_source_.copyTo(s.frame);
+
+    // Tell sink it can continue
+    frame_source_.post();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // None of the sink's were at the END state
+    // 2. Get positions
+    for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+        if (position_sources_[i].source->wait() == oat::NodeState::END)
+            return 1;
+
+        s.positions[i] = position_sources_[i].source->clone();
+
+        position_sources_[i].source->post();
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
     return 0;
 }
 
+void Decorator::computeStage(const size_t slot)
+{
+    auto &s = slots_[slot];
+
+    // Drawing state follows the source's frame geometry on this thread
+    s.reshape = s.param.generation != frame_generation_;
+    if (s.reshape)
+        setFrameGeometry(s.param);
+
+    // Commands change drawing state, which lives on this thread
+    applyCommands(s.frame.sample_count());
+
+    // Decorate frame
+    internal_frame_ = s.frame;
+    positions_ = s.positions;
+    drawOnFrame();
+}
+
+void Decorator::writeStage(const size_t slot)
+{
+    const auto &s = slots_[slot];
+
+    shared_frame_ = frame_sink_.acquireWriteBuffer();
+    if (s.reshape) {
+        shared_frame_ = frame_sink_.reshape(s.param.rows,
+                                            s.param.cols,
+                                            s.param.type,
+                                            s.param.color,
+                                            s.param.step);
+    }
+
+    s.frame.copyTo(shared_frame_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read and publish the back buffer
+    frame_sink_.publish();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+}
+
 oat::CommandDescription Decorator::commands() 
 {
     const oat::CommandDescription commands{
@@ -229,8 +343,7 @@ oat::CommandDescription Decorator::commands()
 
 void Decorator::applyCommand(const std::string &command)
 {
-    const auto cmds = commands();
-    if (cmds.at(command) == "clear") {
+    if (command == "clear") {
         history_frame_ = cv::Scalar::all(0);
     }
 }
@@ -255,22 +368,23 @@ void Decorator::drawOnFrame()
         encodeSampleNumber();
 }
 
-void Decorator::invertHomography(oat::Position2D &p)
+void Decorator::invertHomography(oat::Position2D &p,
+                                 const cv::Matx33d &homography)
 {
     if (p.position_valid) {
 
-        cv::Matx33d inv_homo = p.homography().inv();
+        cv::Matx33d inv_homo = homography.inv();
 
-        std::vector<oat::Point2D> in_positions;
-        std::vector<oat::Point2D> out_positions;
+        std::vector<cv::Point2d> in_positions;
+        std::vector<cv::Point2d> out_positions;
         in_positions.push_back(p.position);
         cv::perspectiveTransform(in_positions, out_positions, inv_homo);
         p.position = out_positions[0];
 
         if (p.velocity_valid) {
 
-            std::vector<oat::Velocity2D> in_velocities;
-            std::vector<oat::Velocity2D> out_velocities;
+            std::vector<cv::Point2d> in_velocities;
+            std::vector<cv::Point2d> out_velocities;
             cv::Matx33d vel_inv_homo = inv_homo;
             vel_inv_homo(0, 2) = 0.0; // offsets do not apply to velocity
             vel_inv_homo(1, 2) = 0.0; // offsets do not apply to velocity
@@ -281,8 +395,8 @@ void Decorator::invertHomography(oat::Position2D &p)
 
         if (p.heading_valid) {
 
-            std::vector<oat::UnitVector2D> in_heading;
-            std::vector<oat::UnitVector2D> out_heading;
+            std::vector<cv::Point2d> in_heading;
+            std::vector<cv::Point2d> out_heading;
             cv::Matx33d head_inv_homo = inv_homo;
             head_inv_homo(0, 2) = 0.0; // offsets do not apply to heading
             head_inv_homo(1, 2) = 0.0; // offsets do not apply to heading
@@ -303,8 +417,9 @@ void Decorator::drawPosition()
 
     for (auto &p : positions_) {
 
-        if (p.unit_of_length() == oat::DistanceUnit::WORLD)
-            invertHomography(p);
+        if (p.unit == oat::DistanceUnit::WORLD)
+            invertHomography(
+                p, position_sources_[i].source->metadata().homography());
 
         if (p.position_valid) {
 
@@ -64,6 +64,10 @@ private:
     // Implement ControllableComponent interface
     virtual bool connectToNode(void) override;
     int process(void) override;
+    bool preparePipeline(const size_t depth) override;
+    int readStage(const size_t slot) override;
+    void computeStage(const size_t slot) override;
+    void writeStage(const size_t slot) override;
     void applyCommand(const std::string &command) override;
     oat::CommandDescription commands(void) override;
 
@@ -77,7 +81,7 @@ private:
     // Decorator name
     std::string name_;
 
-    // Internal frame copy
+    // Frame being decorated. Refers to the sink's back buffer.
     oat::Frame internal_frame_;
 
     // Mat client object for receiving frames
@@ -134,12 +138,34 @@ private:
     // Sample number encoding
     int encode_bit_size_ {5};
 
+    // Generation of the source's frame parameters that drawing follows
+    uint32_t frame_generation_ {0};
+
+    // Frames and positions in flight when stage-pipelined. Each carries the
+    // parameters of the SOURCE frame it was read from.
+    struct Slot {
+        oat::Frame frame;
+        oat::FrameParams param;
+        std::vector<oat::Position2D> positions;
+        bool reshape {false};
+    };
+    std::vector<Slot> slots_;
+
+    /**
+     * Set the sizes of drawn symbols and the sample number encoding to suit
+     * a frame geometry.
+     * @param param Frame parameters.
+     */
+    void setFrameGeometry(const oat::FrameParams &param);
+
     /**
      * Project Positions into oat::PIXEL coordinates.
-     * @param pos Position with unit_of_length != oat::PIXEL to be converted to
-     * unit_of_length == oat::PIXEL.
+     * @param pos Position with unit != oat::PIXEL to be converted to
+     * unit == oat::PIXEL.
+     * @param homography Homography that took pos out of pixel coordinates,
+     * from its SOURCE's metadata.
      */
-    void invertHomography(oat::Position2D &pos);
+    void invertHomography(oat::Position2D &pos, const cv::Matx33d &homography);
 
     // Frame mutating subroutines
     void drawPosition(void);
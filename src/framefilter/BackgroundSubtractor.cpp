@@ -96,7 +96,24 @@ void BackgroundSubtractor::filter(cv::Mat &frame)
        background_frame_f_.convertTo(background_frame_, CV_8U);
     }
 
-    frame = frame - background_frame_;
+    cv::subtract(frame, background_frame_, frame);
+}
+
+void BackgroundSubtractor::filterBand(const oat::Frame &,
+                                      oat::Frame &out,
+                                      const cv::Range &rows)
+{
+    cv::Mat band = out.rowRange(rows);
+    cv::Mat background = background_frame_.rowRange(rows);
+
+    // Each band updates its own rows of the background
+    if (alpha_ > 0.0) {
+       cv::Mat background_f = background_frame_f_.rowRange(rows);
+       cv::accumulateWeighted(band, background_f, alpha_);
+       background_f.convertTo(background, CV_8U);
+    }
+
+    cv::subtract(band, background, band);
 }
 
 } /* namespace oat */
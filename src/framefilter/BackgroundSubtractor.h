@@ -61,6 +61,15 @@ private:
      */
     void filter(cv::Mat &frame) override;
 
+    // The first frame sets the background, so is not split into bands
+    BandMode bandMode(void) const override
+    {
+        return background_set_ ? BandMode::IN_PLACE : BandMode::NONE;
+    }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
     // Set the background frame
     void setBackgroundImage(const cv::Mat&);
 };
@@ -45,7 +45,11 @@ po::options_description ColorConvert::options() const
          "Values:\n"
          "  GREY: \t 8-bit Greyscale image.\n"
          "  BRG: \t8-bit, 3-chanel, BGR Color image.\n"
-         "  HSV: \t8-bit, 3-chanel, HSV Color image.\n")
+         "  HSV: \t8-bit, 3-chanel, HSV Color image.\n"
+         "  GREY16: \t16-bit Greyscale image.\n"
+         "Frames in a raw sensor format (BAYER_RGGB, BAYER_BGGR, BAYER_GRBG, "
+         "BAYER_GBRG, GREY16 or YUV422) can be converted to any of these. "
+         "Bayer frames are demosaiced using bilinear interpolation.\n")
         ;
 
     return local_opts;
@@ -62,48 +66,46 @@ void ColorConvert::applyConfiguration(const po::variables_map &vm,
     }
 }
 
-bool ColorConvert::connectToNode()
+oat::FrameParams ColorConvert::outputParameters(const oat::FrameParams &input)
 {
-    // Establish our a slot in the source node
-    frame_source_.touch(frame_source_address_);
-
-    // Wait for synchronous start with sink when it binds its node
-    if (frame_source_.connect() != SourceState::CONNECTED)
-        return false;
-
-    // Get frame meta data to format sink
-    auto frame_parameters = frame_source_.parameters();
-
-    // Get the color conversion code
-    conversion_code_ = oat::color_conv_code(frame_parameters.color, color_);
+    // Throws if the conversion is not possible
+    input_color_ = input.color;
 
     // If there is no conversion being done, throw
-    if (conversion_code_ == -1) {
-        throw std::runtime_error("Nothing to be done for " + color_str(frame_parameters.color)
+    if (oat::color_conv_code(input_color_, color_) == oat::COLOR_CONV_NONE) {
+        throw std::runtime_error("Nothing to be done for " + color_str(input.color)
                                  + " to "
                                  + color_str(color_)
                                  + " conversion.");
     }
 
-    // Bind to sink node and create a shared frame
     // Because this changes the color, it might change the size and type of
-    // frame
-    size_t bytes = frame_parameters.rows * frame_parameters.cols
-                   * oat::color_bytes(color_);
-    frame_sink_.bind(frame_sink_address_, bytes);
-    shared_frame_ = frame_sink_.retrieve(frame_parameters.rows,
-                                         frame_parameters.cols,
-                                         oat::cv_type(color_),
-                                         color_);
-    return true;
+    // frame. Rows are padded if the input's were.
+    oat::FrameParams output = input;
+    output.type = oat::cv_type(color_);
+    output.color = color_;
+    output.step = input.cols * oat::color_bytes(color_);
+    if (input.step != input.cols * CV_ELEM_SIZE(input.type))
+        output.step = oat::paddedStep(input.cols, output.type);
+    output.bytes = input.rows * output.step;
+
+    return output;
 }
 
 void ColorConvert::filter(cv::Mat &frame)
 {
     cv::Mat out; // Might change underlying element type
-    cv::cvtColor(frame, out, conversion_code_);
+    oat::convertColor(frame, out, input_color_, color_);
     frame = out;
     static_cast<oat::Frame &>(frame).set_color(color_);
 }
 
+void ColorConvert::filterBand(const oat::Frame &in,
+                              oat::Frame &out,
+                              const cv::Range &rows)
+{
+    cv::Mat band = out.rowRange(rows);
+    oat::convertColorBand(in, band, input_color_, color_, rows);
+}
+
 } /* namespace oat */
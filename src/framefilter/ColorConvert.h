@@ -40,14 +40,18 @@ public:
                  const std::string &frame_sink_address);
 
 private:
-    bool connectToNode(void) override;
     po::options_description options() const override;
     void applyConfiguration(const po::variables_map &vm,
                             const config::OptionTable &config_table) override;
 
     void filter(cv::Mat &frame) override;
+    BandMode bandMode(void) const override { return BandMode::OUT_OF_PLACE; }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+    oat::FrameParams outputParameters(const oat::FrameParams &input) override;
 
-    int conversion_code_;
+    oat::PixelColor input_color_;
     oat::PixelColor color_;
 };
 
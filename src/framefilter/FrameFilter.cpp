@@ -19,6 +19,7 @@
 
 #include "FrameFilter.h"
 
+#include <algorithm>
 #include <string>
 
 namespace oat {
@@ -44,21 +45,37 @@ bool FrameFilter::connectToNode()
         return false;
 
     // Get frame meta data to format sink
-    auto frame_parameters = frame_source_.parameters();
+    auto input = frame_source_.parameters();
+    auto output = outputParameters(input);
+    source_generation_ = input.generation;
+    output_ = output;
+
+    // Split frames into bands if we have several threads
+    if (oat::runDefaults().threads > 1)
+        pool_.reset(new oat::ThreadPool(oat::runDefaults().threads));
+
+    // Leave room for the largest frame the SOURCE can publish so that the
+    // SINK can follow it if it is reshaped
+    const size_t bytes = std::max(output.bytes,
+                                  frame_source_.capacity()
+                                  / CV_ELEM_SIZE(input.type)
+                                  * CV_ELEM_SIZE(output.type));
 
     // Bind to sink node and create a shared frame
-    frame_sink_.bind(frame_sink_address_, frame_parameters.bytes);
-    shared_frame_ = frame_sink_.retrieve(frame_parameters.rows,
-                                         frame_parameters.cols,
-                                         frame_parameters.type,
-                                         frame_parameters.color);
+    frame_sink_.bind(frame_sink_address_, bytes);
+    shared_frame_ = frame_sink_.retrieve(output.rows,
+                                         output.cols,
+                                         output.type,
+                                         output.color,
+                                         output.step);
 
     return true;
 }
 
 int FrameFilter::process()
 {
-    oat::Frame internal_frame;
+    // Render straight into the sink's back buffer. This does not block.
+    shared_frame_ = frame_sink_.acquireWriteBuffer();
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -67,34 +84,182 @@ int FrameFilter::process()
     if (frame_source_.wait() == oat::NodeState::END)
         return 1;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame);
+    // Follow the SOURCE if its frame geometry changed
+    auto input = frame_source_.parameters();
+    if (input.generation != source_generation_) {
+        auto output = outputParameters(input);
+        output_ = output;
+        shared_frame_ = frame_sink_.reshape(output.rows,
+                                            output.cols,
+                                            output.type,
+                                            output.color,
+                                            output.step);
+        source_generation_ = input.generation;
+    }
 
-    // Tell sink it can continue
-    frame_source_.post();
+    // Filters whose bands need the whole input read the SOURCE's frame in
+    // place and write straight into the back buffer
+    const BandMode mode = pool_ ? bandMode() : BandMode::NONE;
+    if (mode == BandMode::OUT_OF_PLACE) {
+
+        auto frame = frame_source_.lease();
+        shared_frame_.set_sample(frame->sample());
+        filterBands(*frame, shared_frame_);
+
+        // Tell sink it can continue
+        frame.release();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+
+    } else {
+
+        // Filters that do not change the frame's format work in place on the
+        // back buffer. Others get a private copy.
+        oat::Frame frame;
+        if (input.type == shared_frame_.type())
+            frame = shared_frame_;
+
+        // Copy the shared frame
+        frame_source_.copyTo(frame);
+
+        // Tell sink it can continue
+        frame_source_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+
+        // Filter frame
+        if (mode == BandMode::IN_PLACE)
+            filterBands(frame, frame);
+        else
+            filter(frame);
+
+        // The filter produced a new matrix rather than working in place
+        if (frame.data != shared_frame_.data)
+            frame.copyTo(shared_frame_);
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read and publish the back buffer
+    frame_sink_.publish();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Filter internal frame
-    filter(internal_frame);
+    // Sink was not at END state
+    return 0;
+}
+
+const oat::Frame &FrameFilter::applyFilter(oat::Frame &frame,
+                                           oat::Frame &filtered)
+{
+    const BandMode mode = pool_ ? bandMode() : BandMode::NONE;
+    if (mode == BandMode::NONE) {
+        filter(frame);
+        return frame;
+    }
+
+    if (mode == BandMode::IN_PLACE) {
+        filterBands(frame, frame);
+        return frame;
+    }
 
+    // Filters that need the whole input write to the slot's filtered frame,
+    // which is only reallocated when the output geometry changes. It carries
+    // the frame's sample on to the SINK.
+    filtered.create(output_.rows, output_.cols, output_.type);
+    filtered.set_color(output_.color);
+    filtered.set_sample(frame.sample());
+    filterBands(frame, filtered);
+
+    return filtered;
+}
+
+void FrameFilter::filterBands(const oat::Frame &in, oat::Frame &out)
+{
+    const size_t bands = pool_->size();
+    pool_->parallelFor(bands, [&](size_t i) {
+        auto b = oat::band(in.rows, bands, i, 2);
+        if (b.first < b.second)
+            filterBand(in, out, cv::Range(b.first, b.second));
+    });
+}
+
+bool FrameFilter::preparePipeline(const size_t depth)
+{
+    // Preallocate each slot to the SOURCE's current geometry
+    const auto input = frame_source_.parameters();
+    slots_ = std::vector<Slot>(depth);
+    for (auto &s : slots_)
+        s.frame.create(input.rows, input.cols, input.type);
+    compute_generation_ = source_generation_;
+
+    return true;
+}
+
+int FrameFilter::readStage(const size_t slot)
+{
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sources to read
-    frame_sink_.wait();
+    // Wait for sink to write to node
+    if (frame_source_.wait() == oat::NodeState::END)
+        return 1;
 
-    internal_frame.copyTo(shared_frame_);
+    // Copy the shared frame
+    slots_[slot].input = frame_source_.parameters();
+    frame_source_.copyTo(slots_[slot].frame);
 
-    // Tell sources there is new data
-    frame_sink_.post();
+    // Tell sink it can continue
+    frame_source_.post();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Sink was not at END state
     return 0;
 }
 
-} /* namespace oat */
+void FrameFilter::computeStage(const size_t slot)
+{
+    // Filters may keep state that depends on the frame format, so they must
+    // see a geometry change on this thread, before the first frame it affects
+    auto &s = slots_[slot];
+    s.reshape = s.input.generation != compute_generation_;
+    if (s.reshape) {
+        s.output = outputParameters(s.input);
+        output_ = s.output;
+        compute_generation_ = s.input.generation;
+    }
+
+    s.result = &applyFilter(s.frame, s.filtered);
+}
+
+void FrameFilter::writeStage(const size_t slot)
+{
+    const auto &s = slots_[slot];
+
+    // Render into the sink's back buffer, following the SOURCE if its frame
+    // geometry changed
+    shared_frame_ = frame_sink_.acquireWriteBuffer();
+    if (s.reshape) {
+        shared_frame_ = frame_sink_.reshape(s.output.rows,
+                                            s.output.cols,
+                                            s.output.type,
+                                            s.output.color,
+                                            s.output.step);
+    }
+
+    s.result->copyTo(shared_frame_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read and publish the back buffer
+    frame_sink_.publish();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+}
@@ -20,23 +20,23 @@
 #ifndef OAT_FRAMEFILT_H
 #define	OAT_FRAMEFILT_H
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "../../lib/base/Configurable.h"
 #include "../../lib/base/ControllableComponent.h"
+#include "../../lib/base/ThreadPool.h"
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
 
 namespace oat {
 
-class ColorConvert; // Forward decl.
 namespace po = boost::program_options;
 
 class FrameFilter : public Component, public Configurable<false> {
 
-friend ColorConvert;
-
 public:
     /**
      * @brief Abstract frame filter.
@@ -63,10 +63,68 @@ protected:
      */
     virtual void filter(cv::Mat &frame) = 0;
 
+    /**
+     * How filtering can be split into horizontal bands of rows that are
+     * filtered concurrently by filterBand() when there are several --threads.
+     */
+    enum class BandMode {
+        NONE, //!< It cannot. filter() is used.
+        IN_PLACE, //!< Each output row depends only on the same input row
+        OUT_OF_PLACE //!< Output rows may depend on any input rows
+    };
+
+    /**
+     * Get how filtering can be split into bands. Called for each frame, on
+     * the thread that filters it. Override in derived classes that
+     * implement filterBand().
+     * @return Band mode
+     */
+    virtual BandMode bandMode(void) const { return BandMode::NONE; }
+
+    /**
+     * Filter a band of rows. Called concurrently for disjoint bands that
+     * together cover the frame, so it must only write those rows of out, or
+     * of state that is kept per pixel. Bands start on even rows.
+     * @param in Whole frame to be filtered. For IN_PLACE filters, this is the
+     * same frame as out.
+     * @param out Whole filtered frame, with the output parameters.
+     * @param rows Rows of out to fill.
+     */
+    virtual void filterBand(const oat::Frame &in,
+                            oat::Frame &out,
+                            const cv::Range &rows)
+    {
+        (void)in; (void)out; (void)rows;
+    }
+
+    /**
+     * Get the parameters of filtered frames. Called when connecting and
+     * whenever the SOURCE's frame geometry changes. Override in derived
+     * classes that change the frame format.
+     * @param input Parameters of frames read from the SOURCE
+     * @return Parameters of frames written to the SINK
+     */
+    virtual oat::FrameParams outputParameters(const oat::FrameParams &input)
+    {
+        return input;
+    }
+
 private:
     // Component Interface
     virtual bool connectToNode(void) override;
     int process(void) override;
+    bool preparePipeline(const size_t depth) override;
+    int readStage(const size_t slot) override;
+    void computeStage(const size_t slot) override;
+    void writeStage(const size_t slot) override;
+
+    // Filter a pipeline slot's frame, split into bands if possible. Bands
+    // that need the whole input are written to filtered, whose buffer is kept
+    // between frames. Returns the frame holding the result.
+    const oat::Frame &applyFilter(oat::Frame &frame, oat::Frame &filtered);
+
+    // Filter in into out, split into a band per pool thread
+    void filterBands(const oat::Frame &in, oat::Frame &out);
 
     // Frame source
     const std::string frame_source_address_;
@@ -78,6 +136,29 @@ private:
 
     // Currently acquired, shared frame
     oat::Frame shared_frame_;
+
+    // Generation of the SOURCE's frame parameters that the SINK follows
+    uint32_t source_generation_ {0};
+
+    // Parameters of filtered frames, as of the frame being filtered
+    oat::FrameParams output_;
+
+    // Threads that split each frame into bands, if there are several
+    std::unique_ptr<oat::ThreadPool> pool_;
+
+    // Frames in flight when stage-pipelined. Each carries the parameters of
+    // the SOURCE frame it was read from and, if the SOURCE's geometry changed,
+    // the new parameters of the SINK.
+    struct Slot {
+        oat::Frame frame;
+        oat::Frame filtered;
+        const oat::Frame *result {nullptr};
+        oat::FrameParams input;
+        oat::FrameParams output;
+        bool reshape {false};
+    };
+    std::vector<Slot> slots_;
+    uint32_t compute_generation_ {0};
 };
 
 }      /* namespace oat */
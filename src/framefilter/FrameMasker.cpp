@@ -74,4 +74,12 @@ void FrameMasker::filter(cv::Mat &frame)
         frame.setTo(0, roi_mask_ == 0);
 }
 
+void FrameMasker::filterBand(const oat::Frame &,
+                             oat::Frame &out,
+                             const cv::Range &rows)
+{
+    cv::Mat band = out.rowRange(rows);
+    band.setTo(0, roi_mask_.rowRange(rows) == 0);
+}
+
 } /* namespace oat */
@@ -46,6 +46,13 @@ private:
                             const config::OptionTable &config_table) override;
 
     void filter(cv::Mat& frame) override;
+    BandMode bandMode(void) const override
+    {
+        return mask_set_ ? BandMode::IN_PLACE : BandMode::NONE;
+    }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
 
     // Mask frames with an arbitrary ROI
     bool mask_set_ = false;
@@ -68,16 +68,34 @@ void Threshold::filter(cv::Mat &frame)
 {
     cv::Mat grey_frame, thresh_frame;
 
-    auto conversion_code = oat::color_conv_code(
-        static_cast<oat::Frame &>(frame).color(), oat::PIX_GREY);
-
-    if (conversion_code >= 0)
-        cv::cvtColor(frame, grey_frame, conversion_code);
-    else
-        grey_frame = frame;
+    oat::convertColor(frame, grey_frame,
+                      static_cast<oat::Frame &>(frame).color(), oat::PIX_GREY);
 
     cv::inRange(grey_frame, i_min_, i_max_, thresh_frame);
     frame.setTo(cv::Scalar(0, 0, 0), thresh_frame == 0);
 }
 
+void Threshold::filterBand(const oat::Frame &in,
+                           oat::Frame &out,
+                           const cv::Range &rows)
+{
+    cv::Mat band = out.rowRange(rows);
+    cv::Mat grey_band, thresh_band;
+
+    oat::convertColorBand(in, grey_band, input_color_, oat::PIX_GREY, rows);
+
+    // Out of place, the band starts as a copy of the input
+    if (out.data != in.data)
+        in.rowRange(rows).copyTo(band);
+
+    cv::inRange(grey_band, i_min_, i_max_, thresh_band);
+    band.setTo(cv::Scalar(0, 0, 0), thresh_band == 0);
+}
+
+oat::FrameParams Threshold::outputParameters(const oat::FrameParams &input)
+{
+    input_color_ = input.color;
+    return input;
+}
+
 } /* namespace oat */
@@ -44,6 +44,18 @@ private:
                             const config::OptionTable &config_table) override;
 
     void filter(cv::Mat &frame) override;
+    BandMode bandMode(void) const override
+    {
+        // Converting a Bayer mosaic to GREY reads neighbouring rows
+        return oat::is_bayer(input_color_) ? BandMode::OUT_OF_PLACE
+                                           : BandMode::IN_PLACE;
+    }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+    oat::FrameParams outputParameters(const oat::FrameParams &input) override;
+
+    oat::PixelColor input_color_ {oat::PIX_BGR};
 
     // Intensity threshold boundaries
     int i_min_ {0};
@@ -80,11 +80,35 @@ void Undistorter::applyConfiguration(const po::variables_map &vm,
     }
 }
 
+oat::FrameParams Undistorter::outputParameters(const oat::FrameParams &input)
+{
+    // The maps only depend on the frame size, so are computed once rather
+    // than by cv::undistort() for every frame
+    cv::initUndistortRectifyMap(camera_matrix_,
+                                dist_coeff_,
+                                cv::noArray(),
+                                camera_matrix_,
+                                cv::Size(input.cols, input.rows),
+                                CV_16SC2,
+                                map1_,
+                                map2_);
+
+    return input;
+}
+
 void Undistorter::filter(cv::Mat &frame)
 {
     cv::Mat temp = frame.clone();
-    // TODO: too slow -- GPU implementation.
-    cv::undistort(temp, frame, camera_matrix_, dist_coeff_);
+    cv::remap(temp, frame, map1_, map2_, cv::INTER_LINEAR);
+}
+
+void Undistorter::filterBand(const oat::Frame &in,
+                             oat::Frame &out,
+                             const cv::Range &rows)
+{
+    cv::Mat band = out.rowRange(rows);
+    cv::remap(in, band, map1_.rowRange(rows), map2_.rowRange(rows),
+              cv::INTER_LINEAR);
 }
 
 } /* namespace oat */
@@ -53,6 +53,15 @@ private:
      * @return Filtered frame
      */
     void filter(cv::Mat &frame) override;
+    BandMode bandMode(void) const override { return BandMode::OUT_OF_PLACE; }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+    oat::FrameParams outputParameters(const oat::FrameParams &input) override;
+
+    // Undistortion maps for the current frame size, from output pixels to
+    // input pixels
+    cv::Mat map1_, map2_;
 
     cv::Matx33d camera_matrix_ {cv::Matx33d::eye()};
     std::vector<double> dist_coeff_;
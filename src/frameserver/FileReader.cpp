@@ -17,9 +17,14 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
+#include <iostream>
 #include <thread>
 
+#include <opencv2/core/version.hpp>
+
 #include <cpptoml.h>
+#include "../../lib/base/Scheduling.h"
 #include "../../lib/utility/TOMLSanitize.h"
 #include "../../lib/utility/IOFormat.h"
 
@@ -34,6 +39,18 @@ FileReader::FileReader(const std::string &sink_address)
     tick_ = clock_.now();
 }
 
+FileReader::~FileReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        decode_stop_ = true;
+    }
+    frame_served_.notify_one();
+
+    if (decode_thread_.joinable())
+        decode_thread_.join();
+}
+
 po::options_description FileReader::options() const
 {
     // Update CLI options
@@ -48,6 +65,13 @@ po::options_description FileReader::options() const
          "defining a rectangular region of interest. Origin"
          "is upper left corner. ROI must fit within acquired"
          "frame size. Defaults to full video size.")
+        ("prefetch", po::value<size_t>(),
+         "Number of frames decoded ahead of serving them, on a thread of "
+         "their own, so that decoding does not add to the latency of each "
+         "frame. The decoder uses --threads threads where the video backend "
+         "supports it. Decode throughput is reported separately from serve "
+         "throughput in the 'decode' member of oat-control stats. 0 decodes "
+         "each frame just before serving it. Defaults to 4.")
         ;
 
     return local_opts;
@@ -59,7 +83,21 @@ void FileReader::applyConfiguration(const po::variables_map &vm,
     // Video file
     std::string file_name;
     oat::config::getValue(vm, config_table, "video-file", file_name, true);
+
+    // Threads within the decoder, which otherwise picks its own number
+    const int threads = static_cast<int>(oat::runDefaults().threads);
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    if (threads > 1)
+        file_reader_.open(
+            file_name, cv::CAP_ANY, {cv::CAP_PROP_N_THREADS, threads});
+    else
+        file_reader_.open(file_name);
+#else
+    if (threads > 1)
+        std::cerr << oat::Warn("Setting the number of decoder threads "
+                               "requires OpenCV 4.6. Ignoring --threads.\n");
     file_reader_.open(file_name);
+#endif
 
     // Frame rate
     if (oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0))
@@ -75,6 +113,10 @@ void FileReader::applyConfiguration(const po::variables_map &vm,
         region_of_interest_.width  = roi[2];
         region_of_interest_.height = roi[3];
     }
+
+    // Prefetch
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "prefetch", prefetch_depth_, 0, MAX_PREFETCH);
 }
 
 bool FileReader::connectToNode()
@@ -82,6 +124,11 @@ bool FileReader::connectToNode()
     cv::Mat example_frame;
     file_reader_ >> example_frame;
 
+    // Decode whole frames ahead into buffers that are allocated once, here,
+    // and reused by the decoder
+    for (size_t i = 0; i < prefetch_depth_; i++)
+        prefetch_.emplace_back(example_frame.size(), example_frame.type());
+
     if (use_roi_)
         example_frame = example_frame(region_of_interest_);
 
@@ -97,29 +144,25 @@ bool FileReader::connectToNode()
     // Put the sample rate in the shared frame
     shared_frame_.set_rate_hz(1.0 / frame_period_in_sec_.count());
 
+    if (prefetch_depth_ > 0)
+        decode_thread_ = oat::startHelper([this] { decodeAhead(); });
+
     return true;
 }
 
 int FileReader::process()
 {
-    cv::Mat frame;
-    if (!file_reader_.read(frame)) 
+    // Fill the sink's back buffer. This does not block.
+    shared_frame_ = frame_sink_.acquireWriteBuffer();
+    if (!(prefetch_depth_ > 0 ? takeFrame() : readFrame()))
         return 1;
-
-    if (use_roi_ )
-        frame = frame(region_of_interest_);
+    shared_frame_.incrementSampleCount();
 
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sources to read
-    frame_sink_.wait();
-
-    frame.copyTo(shared_frame_);
-    shared_frame_.incrementSampleCount();
-
-    // Tell sources there is new data
-    frame_sink_.post();
+    // Wait for sources to read and publish the back buffer
+    frame_sink_.publish();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
@@ -130,6 +173,150 @@ int FileReader::process()
     return 0;
 }
 
+bool FileReader::readFrame()
+{
+    // Decode straight into the sink's back buffer unless we need an ROI
+    cv::Mat frame;
+    if (!use_roi_)
+        frame = shared_frame_;
+
+    if (!file_reader_.read(frame))
+        return false;
+
+    if (use_roi_ )
+        frame = frame(region_of_interest_);
+
+    // The decoder allocated a new matrix or we are using an ROI
+    if (frame.data != shared_frame_.data)
+        frame.copyTo(shared_frame_);
+
+    return true;
+}
+
+bool FileReader::takeFrame()
+{
+    {
+        // Wake now and then to check for quit
+        std::unique_lock<std::mutex> lock(prefetch_mutex_);
+        while (served_ == decoded_ && !decode_done_ && !quit)
+            frame_decoded_.wait_for(lock, std::chrono::milliseconds(10));
+
+        if (decode_ex_)
+            std::rethrow_exception(decode_ex_);
+        if (served_ == decoded_)
+            return false;
+    }
+
+    // The decoder does not touch this buffer until we count it as served
+    const cv::Mat &frame = prefetch_[served_ % prefetch_depth_];
+    if (use_roi_)
+        frame(region_of_interest_).copyTo(shared_frame_);
+    else
+        frame.copyTo(shared_frame_);
+
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        served_++;
+    }
+    frame_served_.notify_one();
+
+    return true;
+}
+
+void FileReader::decodeAhead()
+{
+    decode_start_ns_.store(steadyNanoseconds(), std::memory_order_relaxed);
+
+    try {
+
+        for (uint64_t n = 0; ; n++) {
+
+            // Wait for a free buffer
+            {
+                std::unique_lock<std::mutex> lock(prefetch_mutex_);
+                frame_served_.wait(lock, [this, n] {
+                    return decode_stop_ || n - served_ < prefetch_depth_;
+                });
+                if (decode_stop_)
+                    return;
+            }
+
+            // The processing thread does not touch this buffer until we
+            // count it as decoded
+            const uint64_t start_ns = steadyNanoseconds();
+            const bool ok = file_reader_.read(prefetch_[n % prefetch_depth_]);
+            if (ok) {
+                const uint64_t ns = steadyNanoseconds() - start_ns;
+                decode_ns_.record(ns);
+                raiseMax(decode_max_ns_, ns);
+                bump(decode_frames_);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(prefetch_mutex_);
+                if (ok)
+                    decoded_++;
+                else
+                    decode_done_ = true;
+            }
+            frame_decoded_.notify_one();
+
+            if (!ok)
+                return;
+        }
+
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(prefetch_mutex_);
+            decode_ex_ = std::current_exception();
+            decode_done_ = true;
+        }
+        frame_decoded_.notify_one();
+    }
+}
+
+void FileReader::appendStats(std::ostream &stats)
+{
+    if (prefetch_depth_ == 0)
+        return;
+
+    const uint64_t now = steadyNanoseconds();
+    const uint64_t start = decode_start_ns_.load(std::memory_order_relaxed);
+    const uint64_t frames = decode_frames_.load(std::memory_order_relaxed);
+
+    // Decode times of the frames decoded since the last snapshot
+    const auto counts = decode_ns_.counts();
+    LatencyHistogram::Counts recent;
+    for (size_t i = 0; i < recent.size(); i++)
+        recent[i] = counts[i] - last_decode_counts_[i];
+
+    const uint64_t since = std::max(start, last_decode_ns_);
+    const double rate_hz = start && now > since
+        ? (frames - last_decode_frames_) * 1e9 / (now - since) : 0.0;
+
+    last_decode_ns_ = now;
+    last_decode_frames_ = frames;
+    last_decode_counts_ = counts;
+
+    uint64_t queued;
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        queued = decoded_ - served_;
+    }
+
+    stats << ",\"decode\":{";
+    stats << "\"frames\":" << frames << ",";
+    stats << "\"rate_hz\":" << rate_hz << ",";
+    stats << "\"decode_ns\":{";
+    stats << "\"p50\":" << LatencyHistogram::quantile(recent, 0.5) << ",";
+    stats << "\"p90\":" << LatencyHistogram::quantile(recent, 0.9) << ",";
+    stats << "\"p99\":" << LatencyHistogram::quantile(recent, 0.99) << ",";
+    stats << "\"max\":"
+          << decode_max_ns_.exchange(0, std::memory_order_relaxed) << "},";
+    stats << "\"queued\":" << queued;
+    stats << "}";
+}
+
 void FileReader::calculateFramePeriod()
 {
     // Copy assignment provides automatic unit conversion
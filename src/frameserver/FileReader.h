@@ -20,13 +20,20 @@
 #ifndef OAT_FILEREADER_H
 #define	OAT_FILEREADER_H
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <limits>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <opencv2/videoio.hpp>
 
 #include "FrameServer.h"
+#include "../../lib/shmemdf/Telemetry.h"
 
 namespace oat {
 
@@ -34,11 +41,13 @@ class FileReader : public FrameServer {
 public:
 
     FileReader(const std::string &sink_name);
+    ~FileReader();
 
 private:
     // Component Interface
     bool connectToNode(void) override;
     int process(void) override;
+    void appendStats(std::ostream &stats) override;
     
     // Configurable Interface
     po::options_description options() const override;
@@ -55,6 +64,46 @@ private:
     // Region of interest
     cv::Rect_<size_t> region_of_interest_;
 
+    // Frames decoded ahead of the processing thread by the decode thread.
+    // 0 decodes on the processing thread.
+    static constexpr size_t MAX_PREFETCH {256};
+    size_t prefetch_depth_ {4};
+    std::vector<cv::Mat> prefetch_;
+    std::thread decode_thread_;
+
+    // Frames decoded into and served from the ring, guarded by
+    // prefetch_mutex_. Frame n lives in prefetch_[n % prefetch_depth_].
+    std::mutex prefetch_mutex_;
+    std::condition_variable frame_decoded_;
+    std::condition_variable frame_served_;
+    uint64_t decoded_ {0};
+    uint64_t served_ {0};
+    bool decode_done_ {false}; //!< End of file or decode error
+    bool decode_stop_ {false};
+    std::exception_ptr decode_ex_;
+
+    // Decode the next frame into the sink's back buffer. False at the end
+    // of the file.
+    bool readFrame(void);
+
+    // Copy the next frame decoded ahead into the sink's back buffer. False
+    // at the end of the file.
+    bool takeFrame(void);
+
+    // Decode ahead until the end of the file or decode_stop_. Runs on
+    // decode_thread_.
+    void decodeAhead(void);
+
+    // Decode statistics. Written by the decode thread, read by the control
+    // thread, which also owns the last_ members.
+    std::atomic<uint64_t> decode_start_ns_ {0};
+    std::atomic<uint64_t> decode_frames_ {0};
+    LatencyHistogram decode_ns_;
+    std::atomic<uint64_t> decode_max_ns_ {0}; //!< Since the last snapshot
+    uint64_t last_decode_ns_ {0};
+    uint64_t last_decode_frames_ {0};
+    LatencyHistogram::Counts last_decode_counts_ {};
+
     // Frame generation clock
     std::chrono::high_resolution_clock clock_;
     std::chrono::duration<double> frame_period_in_sec_;
@@ -47,7 +47,19 @@ const typename PointGreyCam<T>::PixelMap PointGreyCam<T>::pix_map_ =
     {PIX_GREY,
         std::make_tuple(pg::PIXEL_FORMAT_MONO8, pg::PIXEL_FORMAT_MONO8, CV_8UC1)},
     {PIX_BGR,
-        std::make_tuple(pg::PIXEL_FORMAT_RAW8, pg::PIXEL_FORMAT_BGR, CV_8UC3)}
+        std::make_tuple(pg::PIXEL_FORMAT_RAW8, pg::PIXEL_FORMAT_BGR, CV_8UC3)},
+    {PIX_BAYER_RGGB,
+        std::make_tuple(pg::PIXEL_FORMAT_RAW8, pg::PIXEL_FORMAT_RAW8, CV_8UC1)},
+    {PIX_BAYER_BGGR,
+        std::make_tuple(pg::PIXEL_FORMAT_RAW8, pg::PIXEL_FORMAT_RAW8, CV_8UC1)},
+    {PIX_BAYER_GRBG,
+        std::make_tuple(pg::PIXEL_FORMAT_RAW8, pg::PIXEL_FORMAT_RAW8, CV_8UC1)},
+    {PIX_BAYER_GBRG,
+        std::make_tuple(pg::PIXEL_FORMAT_RAW8, pg::PIXEL_FORMAT_RAW8, CV_8UC1)},
+    {PIX_GREY16,
+        std::make_tuple(pg::PIXEL_FORMAT_MONO16, pg::PIXEL_FORMAT_MONO16, CV_16UC1)},
+    {PIX_YUV422,
+        std::make_tuple(pg::PIXEL_FORMAT_422YUV8, pg::PIXEL_FORMAT_422YUV8, CV_8UC2)}
 };
 
 template <typename T>
@@ -91,7 +103,14 @@ po::options_description PointGreyCam<T>::options() const
          "Pixel color format. Defaults to BRG.\n"
          "Values:\n"
          "  GREY: \t 8-bit Greyscale image.\n"
-         "  BRG: \t8-bit, 3-chanel, BGR Color image.\n")
+         "  BRG: \t8-bit, 3-chanel, BGR Color image.\n"
+         "  BAYER_RGGB, BAYER_BGGR, BAYER_GRBG, BAYER_GBRG: \t8-bit raw sensor "
+         "mosaic. Use the tile that matches the sensor. Published without "
+         "demosaicing, at a third the size of BGR.\n"
+         "  GREY16: \t16-bit Greyscale image.\n"
+         "  YUV422: \t8-bit, 2-chanel, UYVY image.\n"
+         "Raw formats can be expanded by the components that need color "
+         "using oat-framefilt col.\n")
         ("gain,g", po::value<double>(),
          "Sensor gain value, specified in dB. Defaults to auto.")
         ("strobe-pin,S", po::value<size_t>(),
@@ -354,7 +373,7 @@ void PointGreyCam<T>::setupWhiteBalance(int bal_red, int bal_blue, bool is_on, b
     }
 
     // Mono pixels do not support white balance
-    if (pix_col_ == PIX_GREY) {
+    if (pix_col_ == PIX_GREY || pix_col_ == PIX_GREY16) {
         std::cerr << oat::Warn(
             "You cannot adjust the white balance for mono frames.");
         return;
@@ -725,6 +744,11 @@ int PointGreyCam<T>::process()
         // Wait for sources to read
         frame_sink_.wait();
 
+        // Point shmem_image_ at the next buffer in the node
+        shared_frame_ = frame_sink_.retrieve();
+        if (shmem_image_->GetData() != shared_frame_.data)
+            shmem_image_->SetData(shared_frame_.data, shmem_image_->GetDataSize());
+
         if (color_conversion_required_)
             raw_image.Convert(std::get<PG_TO>(pix_map_.at(pix_col_)), shmem_image_.get());
         else
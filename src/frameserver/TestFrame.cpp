@@ -80,19 +80,16 @@ void TestFrame::applyConfiguration(const po::variables_map &vm,
 
 bool TestFrame::connectToNode() {
 
-    auto mat = cv::imread(file_name_, oat::imread_code(color_));
+    image_ = cv::imread(file_name_, oat::imread_code(color_));
 
-    if (mat.data == NULL)
+    if (image_.data == NULL)
         throw (std::runtime_error("File \"" + file_name_ + "\" could not be read."));
 
     frame_sink_.bind(frame_sink_address_,
-            mat.total() * mat.elemSize());
+            image_.total() * image_.elemSize());
 
     shared_frame_ = frame_sink_.retrieve(
-            mat.rows, mat.cols, mat.type(), color_);
-
-    // Static image, never changes
-    mat.copyTo(shared_frame_);
+            image_.rows, image_.cols, image_.type(), color_);
 
     // Put the sample rate in the shared frame
     shared_frame_.set_rate_hz(1.0 / frame_period_in_sec_.count());
@@ -109,8 +106,13 @@ int TestFrame::process()
 
         // Wait for sources to read
         frame_sink_.wait();
+        shared_frame_ = frame_sink_.retrieve();
+
+        // Static image, never changes. Zero frame copy once each buffer in
+        // the node has been written.
+        if (shared_frame_.sample_count() < frame_sink_.depth())
+            image_.copyTo(shared_frame_);
 
-        // Zero frame copy
         shared_frame_.incrementSampleCount();
 
         // Tell sources there is new data
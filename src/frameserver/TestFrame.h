@@ -48,6 +48,7 @@ private:
 
     // Image file
     std::string file_name_;
+    cv::Mat image_;
 
     // Frame speed
     double frames_per_second_;
@@ -109,23 +109,26 @@ bool WebCam::connectToNode()
 int WebCam::process()
 {
     // Frame decoding (if compression was performed) can be
-    // computationally expensive. So do this outside the critical section
+    // computationally expensive. So do this outside the critical section,
+    // straight into the sink's back buffer unless we need an ROI.
+    shared_frame_ = frame_sink_.acquireWriteBuffer();
     cv::Mat mat;
+    if (!use_roi_)
+        mat = shared_frame_;
+
     if (!cv_camera_->read(mat)) 
         return 1;
 
     if (use_roi_ )
         mat = mat(region_of_interest_);
 
+    // The camera allocated a new matrix or we are using an ROI
+    if (mat.data != shared_frame_.data)
+        mat.copyTo(shared_frame_);
+
     if (first_frame_) 
         start_ = clock_.now();
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
-    
-    // Wait for sources to read
-    frame_sink_.wait();
-
     // Pure SINKs increment sample count
     // NOTE: webcams have poorly controlled sample period, so it must be
     // calculated. This operation is very inexpensive
@@ -138,10 +141,11 @@ int WebCam::process()
         shared_frame_.incrementSampleCount(time_since_start);
     }
 
-    mat.copyTo(shared_frame_);
-
-    // Tell sources there is new data
-    frame_sink_.post();
+    // START CRITICAL SECTION //
+    ////////////////////////////
+    
+    // Wait for sources to read and publish the back buffer
+    frame_sink_.publish();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
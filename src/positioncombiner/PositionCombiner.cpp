@@ -50,8 +50,7 @@ void PositionCombiner::resolvePositionSources(const po::variables_map &vm)
 
     for (auto &addr : sources) {
 
-        oat::Position2D pos(addr);
-        positions_.push_back(std::move(pos));
+        positions_.push_back(oat::Position2D());
         position_sources_.push_back(
             oat::NamedSource<oat::Position2D>(
                 addr,
@@ -81,8 +80,13 @@ bool PositionCombiner::connectToNode()
     if (!oat::checkSamplePeriods(all_ts, sample_rate_hz))
         std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz));
 
+    // Combined positions are in the coordinate system of the first SOURCE
+    auto metadata = position_sources_[0].source->metadata();
+    metadata.set_label(position_sink_address_);
+
     // Bind to sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
+    position_sink_.set_metadata(metadata);
+    position_sink_.bind(position_sink_address_);
     shared_position_ = position_sink_.retrieve();
 
     return true;
@@ -111,6 +115,7 @@ int PositionCombiner::process()
 
     // Wait for sources to read
     position_sink_.wait();
+    shared_position_ = position_sink_.retrieve();
 
     *shared_position_ = internal_position_;
 
@@ -86,7 +86,7 @@ private:
     oat::NamedSourceList<oat::Position2D> position_sources_;
 
     // Combined position
-    oat::Position2D internal_position_ {"internal"};
+    oat::Position2D internal_position_;
 
     // Position SINK object for publishing combined position
     oat::Position2D * shared_position_ {nullptr};
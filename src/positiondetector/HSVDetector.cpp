@@ -139,7 +139,7 @@ void HSVDetector::applyConfiguration(const po::variables_map &vm,
     oat::config::getValue<bool>(vm, config_table, "tune", tuning_on_);
 }
 
-void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position)
+void HSVDetector::detectPosition(const cv::Mat &frame, oat::Position2D &position)
 {
     // Threshold HSV channels
     // (Very expensive operation)
@@ -157,8 +157,10 @@ void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position)
 
     // Threshold frame will be destroyed by the transform below, so we need to use
     // it to form the frame that will be shown in the tuning window here
-    if (tuning_on_)
-        frame.setTo(0, threshold_frame_ == 0).clone();
+    if (tuning_on_) {
+        tune_frame_ = frame.clone();
+        tune_frame_.setTo(0, threshold_frame_ == 0);
+    }
 
     // Find the largest contour in the threshold image
     siftContours(threshold_frame_,
@@ -169,7 +171,7 @@ void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position)
 
     // Use the GUI tuner if requested
     if (tuning_on_)
-        tune(frame, position);
+        tune(tune_frame_, position);
 }
 
 void HSVDetector::tune(cv::Mat &frame, const oat::Position2D &position)
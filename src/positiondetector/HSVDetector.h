@@ -71,7 +71,7 @@ private:
      * @param Frame to look for object within.
      * @param position Detected object position.
      */
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     // Erode and dilate kernels
     int erode_px_ {0}, dilate_px_ {10};
@@ -81,6 +81,7 @@ private:
 
     // Internal matricies
     cv::Mat threshold_frame_, erode_element_, dilate_element_;
+    cv::Mat tune_frame_;
 
     // HSV threshold values
     int h_min_ {0}, h_max_ {256};
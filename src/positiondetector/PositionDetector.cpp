@@ -47,7 +47,9 @@ bool PositionDetector::connectToNode()
         return false;
 
     // Bind to sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
+    position_sink_.set_metadata(
+        oat::Metadata<oat::Position2D>(position_sink_address_));
+    position_sink_.bind(position_sink_address_);
     shared_position_ = position_sink_.retrieve();
 
     // TODO: check that the pixel color is correct.
@@ -57,8 +59,7 @@ bool PositionDetector::connectToNode()
 
 int PositionDetector::process()
 {
-    oat::Frame internal_frame;
-    oat::Position2D internal_pos("");
+    oat::Position2D internal_pos;
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -67,24 +68,25 @@ int PositionDetector::process()
     if (frame_source_.wait() == oat::NodeState::END)
         return 1;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame);
+    {
+        // Detect directly on the shared frame. The lease tells the sink it
+        // can continue when it goes out of scope.
+        auto frame = frame_source_.lease();
 
-    // Tell sink it can continue
-    frame_source_.post();
+        // Propagate sample info and detect position
+        internal_pos.set_sample(frame->sample());
+        detectPosition(*frame, internal_pos);
+    }
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Propagate sample info and detect position
-    internal_pos.set_sample(internal_frame.sample());
-    detectPosition(internal_frame, internal_pos);
-
     // START CRITICAL SECTION //
     ////////////////////////////
 
     // Wait for sources to read
     position_sink_.wait();
+    shared_position_ = position_sink_.retrieve();
 
     *shared_position_ = internal_pos;
 
@@ -98,4 +100,62 @@ int PositionDetector::process()
     return 0;
 }
 
+bool PositionDetector::preparePipeline(const size_t depth)
+{
+    // Preallocate each slot to the SOURCE's current geometry
+    const auto input = frame_source_.parameters();
+    slots_ = std::vector<Slot>(depth);
+    for (auto &s : slots_)
+        s.frame.create(input.rows, input.cols, input.type);
+
+    return true;
+}
+
+int PositionDetector::readStage(const size_t slot)
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sink to write to node
+    if (frame_source_.wait() == oat::NodeState::END)
+        return 1;
+
+    // Detection happens after the sink continues, so it needs a copy
+    frame_source_.copyTo(slots_[slot].frame);
+
+    // Tell sink it can continue
+    frame_source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return 0;
+}
+
+void PositionDetector::computeStage(const size_t slot)
+{
+    auto &s = slots_[slot];
+    s.position = oat::Position2D();
+    s.position.set_sample(s.frame.sample());
+    detectPosition(s.frame, s.position);
+}
+
+void PositionDetector::writeStage(const size_t slot)
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    position_sink_.wait();
+    shared_position_ = position_sink_.retrieve();
+
+    *shared_position_ = slots_[slot].position;
+
+    // Tell sources there is new data
+    position_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+}
+
 } /* namespace oat */
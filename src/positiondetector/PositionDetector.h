@@ -23,6 +23,7 @@
 #define OAT_POSIDET_MAX_OBJ_AREA_PIX 100000
 
 #include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
@@ -59,10 +60,11 @@ public:
 protected:
     /**
      * Perform object position detection.
-     * @param Frame to look for object within.
+     * @param Frame to look for object within. This refers directly to shared
+     * memory and must not be modified.
      * @param position Detected object position.
      */
-    virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
+    virtual void detectPosition(const cv::Mat &frame, oat::Position2D &position) = 0;
 
     // Detector name
     const std::string name_;
@@ -77,6 +79,10 @@ private:
     // Component Interface
     virtual bool connectToNode(void) override;
     int process(void) override;
+    bool preparePipeline(const size_t depth) override;
+    int readStage(const size_t slot) override;
+    void computeStage(const size_t slot) override;
+    void writeStage(const size_t slot) override;
 
     // Current frame
     oat::Position2D * shared_position_;
@@ -88,6 +94,14 @@ private:
     // Position sink
     const std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
+
+    // Frames in flight when stage-pipelined and the positions detected in
+    // them
+    struct Slot {
+        oat::Frame frame;
+        oat::Position2D position;
+    };
+    std::vector<Slot> slots_;
 };
 
 }      /* namespace oat */
@@ -58,7 +58,7 @@ private:
     void applyConfiguration(const po::variables_map &vm,
                             const config::OptionTable &config_table) override;
 
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     // Intermediate variables
     cv::Mat threshold_frame_;
@@ -93,7 +93,7 @@ private:
     // Processing functions
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame);
 };
 
 }       /* namespace oat */
@@ -67,8 +67,8 @@ void HomographyTransform2D::filter(oat::Position2D& position) {
 
     // Position transform
     if (position.position_valid) {
-        std::vector<oat::Point2D> in_positions;
-        std::vector<oat::Point2D> out_positions;
+        std::vector<cv::Point2d> in_positions;
+        std::vector<cv::Point2d> out_positions;
         in_positions.push_back(position.position);
         cv::perspectiveTransform(in_positions, out_positions, homography_);
         position.position = out_positions[0];
@@ -76,8 +76,8 @@ void HomographyTransform2D::filter(oat::Position2D& position) {
 
     // Velocity transform
     if (position.velocity_valid) {
-        std::vector<oat::Velocity2D> in_velocities;
-        std::vector<oat::Velocity2D> out_velocities;
+        std::vector<cv::Point2d> in_velocities;
+        std::vector<cv::Point2d> out_velocities;
         cv::Matx33d vel_homo = homography_;
         vel_homo(0, 2) = 0.0; // offsets do not apply to velocity
         vel_homo(1, 2) = 0.0; // offsets do not apply to velocity
@@ -88,8 +88,8 @@ void HomographyTransform2D::filter(oat::Position2D& position) {
 
     // Heading transform
     if (position.heading_valid) {
-        std::vector<oat::UnitVector2D> in_heading;
-        std::vector<oat::UnitVector2D> out_heading;
+        std::vector<cv::Point2d> in_heading;
+        std::vector<cv::Point2d> out_heading;
         cv::Matx33d head_homo = homography_;
         head_homo(0, 2) = 0.0; // offsets do not apply to heading
         head_homo(1, 2) = 0.0; // offsets do not apply to heading
@@ -100,9 +100,15 @@ void HomographyTransform2D::filter(oat::Position2D& position) {
     }
 
     // Update outgoing position's coordinate system
-    position.setCoordSystem(oat::DistanceUnit::WORLD, homography_);
+    position.unit = oat::DistanceUnit::WORLD;
 
     //}
 }
 
+void HomographyTransform2D::filterMetadata(
+    oat::Metadata<oat::Position2D> &metadata)
+{
+    metadata.set_homography(homography_ * metadata.homography());
+}
+
 } /* namespace oat */
@@ -52,6 +52,13 @@ private:
      * @param Position to be projected
      */
     void filter(oat::Position2D& position) override;
+
+    /**
+     * Compose our homography with any that the un-filtered positions were
+     * already transformed by.
+     * @param metadata Metadata of un-filtered positions
+     */
+    void filterMetadata(oat::Metadata<oat::Position2D> &metadata) override;
 };
 
 }      /* namespace oat */
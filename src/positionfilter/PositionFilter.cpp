@@ -41,8 +41,15 @@ bool PositionFilter::connectToNode()
     if (position_source_.connect() != SourceState::CONNECTED)
         return false;
 
+    // Filtered positions keep the label of our SINK and, unless the filter
+    // changes it, the coordinate system of our SOURCE
+    auto metadata = position_source_.metadata();
+    metadata.set_label(position_sink_address_);
+    filterMetadata(metadata);
+
     // Bind to sink sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
+    position_sink_.set_metadata(metadata);
+    position_sink_.bind(position_sink_address_);
     shared_position_ = position_sink_.retrieve();
 
     return true;
@@ -74,6 +81,7 @@ int PositionFilter::process()
 
     // Wait for sources to read
     position_sink_.wait();
+    shared_position_ = position_sink_.retrieve();
 
     *shared_position_ = internal_position_;
 
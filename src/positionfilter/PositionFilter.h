@@ -58,6 +58,13 @@ protected:
      */
     virtual void filter(oat::Position2D &position) = 0;
 
+    /**
+     * Describe filtered positions. Called once, before the SINK is bound.
+     * By default, positions keep their coordinate system.
+     * @param metadata Metadata of the un-filtered positions to be modified.
+     */
+    virtual void filterMetadata(oat::Metadata<oat::Position2D> &metadata) { }
+
 private:
     // Component Interface
     virtual bool connectToNode(void) override;
@@ -71,7 +78,7 @@ private:
     oat::Source<oat::Position2D> position_source_;
 
     // Internal, mutable position
-    oat::Position2D internal_position_ {"internal"};
+    oat::Position2D internal_position_;
 
     // Shared position
     oat::Position2D * shared_position_;
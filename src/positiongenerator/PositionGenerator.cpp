@@ -59,7 +59,9 @@ po::options_description PositionGenerator::baseOptions(void) const
 bool PositionGenerator::connectToNode()
 {
     // Bind to sink sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
+    position_sink_.set_metadata(
+        oat::Metadata<oat::Position2D>(position_sink_address_));
+    position_sink_.bind(position_sink_address_);
     shared_position_ = position_sink_.retrieve();
 
     // Setup sample rate info on internal copy
@@ -78,6 +80,7 @@ int PositionGenerator::process()
 
     // Wait for sources to read
     position_sink_.wait();
+    shared_position_ = position_sink_.retrieve();
 
     if (first_pos_) {
         first_pos_ = false;
@@ -97,7 +97,7 @@ private:
     std::string name_;
 
     // Internally generated position
-    oat::Position2D internal_position_ {"internal"};
+    oat::Position2D internal_position_;
 
     // Shared position
     oat::Position2D * shared_position_;
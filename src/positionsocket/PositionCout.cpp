@@ -40,12 +40,16 @@ po::options_description PositionCout::options() const
          "If true, print formated positions to the command line.")
         ;
 
+    local_opts.add(sourceOptions());
+
     return local_opts; 
 }
 
 void PositionCout::applyConfiguration(const po::variables_map &vm,
                                       const config::OptionTable &config_table)
 {
+    applySourceConfiguration(vm, config_table);
+
     // Format output
     oat::config::getValue<bool>(vm, config_table, "pretty-print", pretty_);
 }
@@ -66,4 +70,20 @@ void PositionCout::sendPosition(const oat::Position2D &position)
     std::cout << buffer.GetString() << std::flush;
 }
 
+void PositionCout::sendPositions(const oat::PositionList &positions)
+{
+    // Serialize the current positions
+    rapidjson::StringBuffer buffer;
+
+    if (pretty_) {
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        oat::serializePosition(positions, writer);
+    } else {
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        oat::serializePosition(positions, writer);
+    }
+
+    std::cout << buffer.GetString() << std::flush;
+}
+
 } /* namespace oat */
@@ -43,6 +43,7 @@ class PositionCout : public PositionSocket {
     bool pretty_ {false};
 
     void sendPosition(const oat::Position2D &position) override;
+    void sendPositions(const oat::PositionList &positions) override;
 };
 
 }      /* namespace oat */
@@ -49,12 +49,16 @@ po::options_description PositionPublisher::options() const
          "'ipc:///tmp/test.pipe'.");
         ;
 
+    local_opts.add(sourceOptions());
+
     return local_opts;
 }
 
 void PositionPublisher::applyConfiguration(
     const po::variables_map &vm, const config::OptionTable &config_table)
 {
+    applySourceConfiguration(vm, config_table);
+
     // Endpoint
     std::string endpoint;
     oat::config::getValue<std::string>(
@@ -75,4 +79,17 @@ void PositionPublisher::sendPosition(const oat::Position2D &position)
     publisher_.send(zmsg);
 }
 
+void PositionPublisher::sendPositions(const oat::PositionList &positions)
+{
+    // Serialize the current positions
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    oat::serializePosition(positions, writer);
+
+    // Publish update
+    zmq::message_t zmsg(buffer.GetSize());
+    memcpy((void *)zmsg.data(), buffer.GetString(), buffer.GetSize());
+    publisher_.send(zmsg);
+}
+
 } /* namespace oat */
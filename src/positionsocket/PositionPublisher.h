@@ -45,6 +45,7 @@ private:
     zmq::socket_t publisher_;
 
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList& positions) override;
 };
 
 }      /* namespace oat */
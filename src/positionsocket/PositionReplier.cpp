@@ -49,12 +49,16 @@ po::options_description PositionReplier::options() const
          "'ipc:///tmp/test.pipe'.");
         ;
 
+    local_opts.add(sourceOptions());
+
     return local_opts;
 }
 
 void PositionReplier::applyConfiguration(
     const po::variables_map &vm, const config::OptionTable &config_table)
 {
+    applySourceConfiguration(vm, config_table);
+
     // Endpoint
     std::string endpoint;
     oat::config::getValue<std::string>(vm, config_table, "endpoint", endpoint, true);
@@ -79,4 +83,21 @@ void PositionReplier::sendPosition(const oat::Position2D& position)
     replier_.send(zmsg);
 }
 
+void PositionReplier::sendPositions(const oat::PositionList& positions)
+{
+    // Serialize the current positions
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    oat::serializePosition(positions, writer);
+
+    //  Wait for next request from client
+    zmq::message_t request;
+    replier_.recv(&request);
+
+    // Publish update
+    zmq::message_t zmsg(buffer.GetSize());
+    memcpy((void *)zmsg.data(), buffer.GetString(), buffer.GetSize());
+    replier_.send(zmsg);
+}
+
 } /* namespace oat */
@@ -46,6 +46,7 @@ private:
     zmq::socket_t replier_;
 
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList& positions) override;
 };
 
 }      /* namespace oat */
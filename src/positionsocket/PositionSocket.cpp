@@ -24,6 +24,7 @@
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
+#include "../../lib/utility/TOMLSanitize.h"
 
 namespace oat {
 
@@ -37,17 +38,53 @@ PositionSocket::PositionSocket(const std::string &position_source_address)
 bool PositionSocket::connectToNode()
 {
     // Establish our a slot in the node 
-    position_source_.touch(position_source_address_);
+    if (position_list_)
+        position_list_source_.touch(position_source_address_, source_mode_);
+    else
+        position_source_.touch(position_source_address_, source_mode_);
 
     // Wait for synchronous start with sink when it binds its node
-    if (position_source_.connect() != SourceState::CONNECTED)
+    auto state = position_list_ ? position_list_source_.connect()
+                                : position_source_.connect();
+    if (state != SourceState::CONNECTED)
         return false;
 
     return true;
 }
 
+po::options_description PositionSocket::sourceOptions() const
+{
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("latest-only,l",
+         "Only send the newest position. Positions produced while a send is "
+         "in progress are skipped rather than holding up upstream "
+         "components.")
+        ("list",
+         "SOURCE holds a list of positions, e.g. from a multi-target "
+         "detector, rather than a single position. Each sample is sent as a "
+         "single message holding every position in the list.")
+        ;
+
+    return local_opts;
+}
+
+void PositionSocket::applySourceConfiguration(
+    const po::variables_map &vm, const config::OptionTable &config_table)
+{
+    bool latest_only = false;
+    oat::config::getValue<bool>(vm, config_table, "latest-only", latest_only);
+    if (latest_only)
+        source_mode_ = oat::SourceMode::LATEST;
+
+    oat::config::getValue<bool>(vm, config_table, "list", position_list_);
+}
+
 int PositionSocket::process()
 {
+    if (position_list_)
+        return processList();
+
     // START CRITICAL SECTION //
     ////////////////////////////
     node_state_ = position_source_.wait();
@@ -70,4 +107,28 @@ int PositionSocket::process()
     return 0;
 }
 
+int PositionSocket::processList()
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+    node_state_ = position_list_source_.wait();
+    if (node_state_ == oat::NodeState::END)
+        return 1;
+
+    // Clone the shared list, copying only its valid positions
+    internal_position_list_ = position_list_source_.clone();
+
+    // Tell sink it can continue
+    position_list_source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Send the newly acquired positions
+    sendPositions(internal_position_list_);
+
+    // Sink was not at END state
+    return 0;
+}
+
 } /* namespace oat */
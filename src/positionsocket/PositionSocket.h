@@ -28,6 +28,7 @@
 #include "../../lib/base/Component.h"
 #include "../../lib/base/Configurable.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
 
@@ -56,10 +57,28 @@ protected:
      */
     virtual void sendPosition(const oat::Position2D &position) = 0;
 
+    /**
+     * Send a list of positions via specified IO protocol.
+     * @param List of positions to serve.
+     */
+    virtual void sendPositions(const oat::PositionList &positions) = 0;
+
+    /**
+     * @brief Options that are common to all position sockets. Concrete
+     * sockets add these to their own options().
+     * @return Common position socket options.
+     */
+    po::options_description sourceOptions(void) const;
+
+    // Apply the options described by sourceOptions()
+    void applySourceConfiguration(const po::variables_map &vm,
+                                  const config::OptionTable &config_table);
+
 private:
     // Component Interface
     bool connectToNode(void) override;
     int process(void) override;
+    int processList(void);
 
     // Position Socket name
     const std::string name_;
@@ -68,9 +87,15 @@ private:
     std::string position_source_address_;
     oat::NodeState node_state_ {oat::NodeState::UNDEFINED};
     oat::Source<oat::Position2D> position_source_;
+    oat::Source<oat::PositionList> position_list_source_;
+    oat::SourceMode source_mode_ {oat::SourceMode::BLOCKING};
+
+    // SOURCE holds a list of positions rather than a single position
+    bool position_list_ {false};
 
-    // The current, internally allocated position
-    oat::Position2D internal_position_ {"internal"};
+    // The current, internally allocated position(s)
+    oat::Position2D internal_position_;
+    oat::PositionList internal_position_list_;
 };
 
 }      /* namespace oat */
@@ -49,12 +49,16 @@ po::options_description UDPPositionClient::options() const
          "instance, 5555.")
         ;
 
+    local_opts.add(sourceOptions());
+
     return local_opts;
 }
 
 void UDPPositionClient::applyConfiguration(
     const po::variables_map &vm, const config::OptionTable &config_table)
 {
+    applySourceConfiguration(vm, config_table);
+
     // Host
     std::string host;
     oat::config::getValue<std::string>(
@@ -89,4 +93,16 @@ void UDPPositionClient::sendPosition(const oat::Position2D &current_position)
     udp_stream_->Flush();
 }
 
+void UDPPositionClient::sendPositions(const oat::PositionList &positions)
+{
+    rapidjson::Writer < rapidjson::SocketWriteStream
+                      < UDPSocket, UDPEndpoint > > udp_writer_ {*udp_stream_};
+
+    oat::serializePosition(positions, udp_writer_);
+
+    // Flush after each list so that each UDP packet corresponds to a single
+    // sample
+    udp_stream_->Flush();
+}
+
 } /* namespace oat */
@@ -59,6 +59,7 @@ private:
     std::unique_ptr<SocketWriter> udp_stream_;
 
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList& positions) override;
 };
 
 }      /* namespace oat */
@@ -83,8 +83,16 @@ void FrameWriter::initialize(const std::string &path)
 void FrameWriter::write(void)
 {
     cv::Mat mat;
-    while (buffer_.pop(mat))
+    while (buffer_.pop(mat)) {
+
+        // Video writers only take 8-bit pixels. Bayer mosaics are kept as
+        // GREY so they can still be demosaiced later.
+        if (frame_params_.color == oat::PIX_GREY16
+            || frame_params_.color == oat::PIX_YUV422)
+            oat::convertColor(mat, mat, frame_params_.color, oat::PIX_BGR);
+
         video_writer_.write(mat);
+    }
 }
 
 void FrameWriter::push(void )
@@ -44,6 +44,10 @@ public:
     {
         return source_.retrieve()->sample_period_sec();
     }
+    uint64_t sample_count() override
+    {
+        return source_.retrieve()->sample_count();
+    }
     oat::NodeState wait() override { return source_.wait(); }
     void post(void) override { source_.post(); }
 
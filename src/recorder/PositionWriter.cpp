@@ -27,7 +27,8 @@
 
 namespace oat {
 
-PositionWriter::~PositionWriter()
+template <typename T>
+PositionWriter<T>::~PositionWriter()
 {
     if (use_binary_ && fd_ != nullptr) {
         auto n = std::to_string(completed_writes_);
@@ -40,8 +41,9 @@ PositionWriter::~PositionWriter()
     }
 }
 
-void PositionWriter::configure(const oat::config::OptionTable &t,
-                               const po::variables_map &vm)
+template <typename T>
+void PositionWriter<T>::configure(const oat::config::OptionTable &t,
+                                  const po::variables_map &vm)
 {
     // File overwrite
     oat::config::getValue(vm, t, "allow-overwrite", allow_overwrite_);
@@ -53,7 +55,8 @@ void PositionWriter::configure(const oat::config::OptionTable &t,
     oat::config::getValue(vm, t, "concise-file", concise_file_);
 }
 
-void PositionWriter::initialize(const std::string &path) 
+template <typename T>
+void PositionWriter<T>::initialize(const std::string &path) 
 {
     if (use_binary_)
         initializeBinary(path);
@@ -61,7 +64,8 @@ void PositionWriter::initialize(const std::string &path)
         initializeJSON(path);
 }
 
-void PositionWriter::initializeBinary(const std::string &path)
+template <typename T>
+void PositionWriter<T>::initializeBinary(const std::string &path)
 {
     auto path_ =  path + ".npy";
 
@@ -78,11 +82,12 @@ void PositionWriter::initializeBinary(const std::string &path)
     assert(fd_);
 
     // Write header
-    auto header = getNumpyHeader(oat::Position2D::NPY_DTYPE);
+    auto header = getNumpyHeader(T::NPY_DTYPE);
     fwrite(header.data(), 1, header.size(), fd_);
 }
 
-void PositionWriter::initializeJSON(const std::string &path)
+template <typename T>
+void PositionWriter<T>::initializeJSON(const std::string &path)
 {
     auto path_ =  path + ".json";
 
@@ -137,16 +142,16 @@ void PositionWriter::initializeJSON(const std::string &path)
     json_writer_.StartArray();
 }
 
-void PositionWriter::write() {
+template <typename T>
+void PositionWriter<T>::write() {
 
-    oat::Position2D p("");
+    T p;
 
     while (buffer_.pop(p)) {
 
         if (use_binary_) {
-            //std::cout << "Dummy write.\n";
-            auto pack = oat::packPosition(p);
-            fwrite(pack.data(), 1, pack.size(), fd_);
+            // Records are laid out in memory as T::NPY_DTYPE describes
+            fwrite(&p, sizeof(T), 1, fd_);
         } else {
             oat::serializePosition(p, json_writer_, !concise_file_);
         }
@@ -155,10 +160,15 @@ void PositionWriter::write() {
     }
 }
 
-void PositionWriter::push() {
+template <typename T>
+void PositionWriter<T>::push() {
 
     if (!buffer_.push(source_.clone()))
         throw std::runtime_error(OVERRUN_MSG);
 }
 
+// Explicit instantiations
+template class PositionWriter<oat::Position2D>;
+template class PositionWriter<oat::PositionList>;
+
 } /* namespace oat */
@@ -27,11 +27,18 @@
 #include <rapidjson/prettywriter.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList.h"
 #include "../../lib/utility/FileFormat.h"
 
 namespace oat {
 namespace blf = boost::lockfree;
 
+/**
+ * @brief Writes position tokens of type T, either a single position
+ * (oat::Position2D) or a list of positions (oat::PositionList), to JSON or
+ * numpy files.
+ */
+template <typename T>
 class PositionWriter : public Writer{
 public:
     using Writer::Writer;
@@ -46,6 +53,10 @@ public:
     {
         return source_.retrieve()->sample_period_sec();
     }
+    uint64_t sample_count() override
+    {
+        return source_.retrieve()->sample_count();
+    }
 
     oat::NodeState wait() override { return source_.wait(); }
     void post(void) override { source_.post(); }
@@ -60,7 +71,7 @@ public:
     }
 
 private:
-    using SPSCBuffer = boost::lockfree::spsc_queue<oat::Position2D,
+    using SPSCBuffer = boost::lockfree::spsc_queue<T,
                                                    blf::capacity<BUFFER_SIZE>>;
     /**
      * @brief Determines if indeterminate position data fields should be
@@ -92,7 +103,7 @@ private:
     static constexpr int header_prefix_size_ {10};
     static constexpr int shape_end_byte_ {10};
 
-    oat::Source<Position2D> source_;
+    oat::Source<T> source_;
 };
 
 }      /* namespace oat */
@@ -30,6 +30,7 @@
 #include <string>
 #include <vector>
 
+#include "../../lib/base/Scheduling.h"
 #include "../../lib/utility/FileFormat.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/make_unique.h"
@@ -62,6 +63,9 @@ po::options_description Recorder::options() const
         ("position-sources,p", po::value< std::vector<std::string> >()->multitoken(),
         "The names of the POSITION SOURCES that supply object positions "
         "to be recorded.")
+        ("position-list-sources,L", po::value< std::vector<std::string> >()->multitoken(),
+        "The names of the POSITION LIST SOURCES that supply the positions of "
+        "multiple objects to be recorded.")
         ("filename,n", po::value<std::string>(),
         "The base file name. If not specified, defaults to the SOURCE "
         "name.")
@@ -123,7 +127,20 @@ void Recorder::applyConfiguration(const po::variables_map &vm,
         oat::config::checkForDuplicateSources(addrs);
 
         for (auto &a : addrs)
-            writers_.emplace_back(oat::make_unique<PositionWriter>(a));
+            writers_.emplace_back(
+                oat::make_unique<PositionWriter<oat::Position2D>>(a));
+    }
+
+    if (vm.count("position-list-sources")) {
+
+        auto addrs = vm["position-list-sources"].as<
+            std::vector<std::string> >();
+
+        oat::config::checkForDuplicateSources(addrs);
+
+        for (auto &a : addrs)
+            writers_.emplace_back(
+                oat::make_unique<PositionWriter<oat::PositionList>>(a));
     }
 
     if (writers_.size() == 0)
@@ -147,7 +164,7 @@ void Recorder::applyConfiguration(const po::variables_map &vm,
         w->configure(config_table, vm);
 
     // Start the recording thread
-    writer_thread_ = std::thread( [this] { writeLoop(); } );
+    writer_thread_ = oat::startHelper([this] { writeLoop(); });
 }
 
 bool Recorder::connectToNode()
@@ -184,6 +201,10 @@ int Recorder::process()
         ////////////////////////////
         source_eof |= w->wait() == oat::NodeState::END;
 
+        // Start and pause at the same sample on every source
+        if (w == writers_.front() && !source_eof)
+            applyCommands(w->sample_count());
+
         if (record_on_ && !source_eof) {
            w->push();
            files_have_data_ = true;
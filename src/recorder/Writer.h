@@ -20,6 +20,7 @@
 #ifndef OAT_WRITER_H
 #define OAT_WRITER_H
 
+#include <cstdint>
 #include <string>
 
 #include <boost/lockfree/spsc_queue.hpp>
@@ -62,6 +63,11 @@ public:
     virtual void post(void) = 0;
     virtual double sample_period_sec(void) = 0;
 
+    /**
+     * @brief Count of the sample held between wait() and post().
+     */
+    virtual uint64_t sample_count(void) = 0;
+
     /**
      * @brief Create and initialize recording file. Must be called
      * before writeStreams.
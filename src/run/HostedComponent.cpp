@@ -0,0 +1,290 @@
+//******************************************************************************
+//* File:   HostedComponent.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "HostedComponent.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../lib/utility/in_place.h"
+
+#include "../bridge/BridgeReceiver.h"
+#include "../bridge/BridgeSender.h"
+#include "../buffer/FrameBuffer.h"
+#include "../buffer/TokenBuffer.h"
+#include "../decorator/Decorator.h"
+#include "../framefilter/BackgroundSubtractor.h"
+#include "../framefilter/BackgroundSubtractorMOG.h"
+#include "../framefilter/ColorConvert.h"
+#include "../framefilter/FrameMasker.h"
+#include "../framefilter/Threshold.h"
+#include "../framefilter/Undistorter.h"
+#include "../frameserver/FileReader.h"
+#include "../frameserver/TestFrame.h"
+#include "../frameserver/WebCam.h"
+#include "../positioncombiner/MeanPosition.h"
+#include "../positiondetector/DifferenceDetector.h"
+#include "../positiondetector/HSVDetector.h"
+#include "../positiondetector/SimpleThreshold.h"
+#include "../positionfilter/HomographyTransform2D.h"
+#include "../positionfilter/KalmanFilter2D.h"
+#include "../positionfilter/RegionFilter2D.h"
+#include "../positiongenerator/RandomAccel2D.h"
+#include "../positionsocket/PositionCout.h"
+#include "../positionsocket/PositionPublisher.h"
+#include "../positionsocket/PositionReplier.h"
+#include "../positionsocket/UDPPositionClient.h"
+#include "../recorder/Recorder.h"
+#include "../viewer/FrameViewer.h"
+#include "../viewer/ViewerBase.h"
+
+namespace oat {
+
+namespace {
+
+// Positional arguments of each command that can be hosted, in order. These
+// must match the command's own main().
+struct Layout {
+    std::vector<std::string> positional;
+    std::string variadic; //!< Trailing positional arguments, if any
+};
+
+const std::map<std::string, Layout> &layouts()
+{
+    static const std::map<std::string, Layout> l {
+        {"bridge",     {{"type", "source", "sink"}, ""}},
+        {"buffer",     {{"type", "source", "sink"}, ""}},
+        {"decorate",   {{"source", "sink"}, ""}},
+        {"framefilt",  {{"type", "source", "sink"}, ""}},
+        {"frameserve", {{"type", "sink"}, ""}},
+        {"posicom",    {{"type"}, "sources-and-sink"}},
+        {"posidet",    {{"type", "source", "sink"}, ""}},
+        {"posifilt",   {{"type", "source", "sink"}, ""}},
+        {"posigen",    {{"type", "sink"}, ""}},
+        {"posisock",   {{"type", "source"}, ""}},
+        {"record",     {{}, ""}},
+        {"view",       {{"type", "source"}, ""}},
+    };
+
+    return l;
+}
+
+} /* namespace */
+
+HostedComponent::HostedComponent(const std::string &command,
+                                 const std::vector<std::string> &args)
+: command_(command)
+{
+    auto it = layouts().find(command);
+    if (it == layouts().end())
+        throw std::runtime_error("'" + command + "' cannot be run in a "
+                                 "pipeline.");
+    const auto &layout = it->second;
+
+    // Required positional arguments and type-specific configuration
+    po::options_description options("POSITIONAL");
+    po::positional_options_description positional_options;
+    for (const auto &p : layout.positional) {
+        options.add_options()(p.c_str(), po::value<std::string>(), "");
+        positional_options.add(p.c_str(), 1);
+    }
+
+    options.add_options()
+        ("type-args", po::value<std::vector<std::string> >(), "");
+    positional_options.add("type-args", -1);
+
+    if (!layout.variadic.empty())
+        options.add_options()(layout.variadic.c_str(),
+                              po::value<std::vector<std::string> >(), "");
+
+    // Parse options, including unrecognized options which may be
+    // type-specific
+    auto parsed_opt = po::command_line_parser(args)
+        .options(options)
+        .positional(positional_options)
+        .allow_unregistered()
+        .run();
+
+    po::store(parsed_opt, option_map_);
+    po::notify(option_map_);
+
+    for (const auto &p : layout.positional) {
+        if (!option_map_.count(p)) {
+            std::string upper(p);
+            std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+            throw std::runtime_error(command + ": A " + upper
+                                     + " must be specified.");
+        }
+    }
+
+    make(option_map_.count("type") ? option_map_["type"].as<std::string>()
+                                   : "");
+
+    // Specialize program options for the selected TYPE
+    po::options_description detail_opts {"CONFIGURATION"};
+    append_options_(detail_opts);
+    options.add(detail_opts);
+
+    // Reparse specialized component options
+    auto special_opt =
+        po::collect_unrecognized(parsed_opt.options, po::include_positional);
+    special_opt.erase(special_opt.begin(),
+                      special_opt.begin() + layout.positional.size());
+
+    po::positional_options_description detail_pos_opts;
+    if (!layout.variadic.empty())
+        detail_pos_opts.add(layout.variadic.c_str(), -1);
+
+    po::store(po::command_line_parser(special_opt)
+             .options(options)
+             .positional(detail_pos_opts)
+             .run(), option_map_);
+    po::notify(option_map_);
+}
+
+void HostedComponent::run()
+{
+    configure_(option_map_);
+    run_();
+}
+
+template <typename T>
+void HostedComponent::host(const std::shared_ptr<T> &component)
+{
+    append_options_ = [component](po::options_description &opts) {
+        component->appendOptions(opts);
+    };
+    configure_ = [component](const po::variables_map &vm) {
+        component->configure(vm);
+    };
+    run_ = [component] { component->run(); };
+    name_ = [component] { return component->name(); };
+}
+
+template <typename T>
+void HostedComponent::hostUnconfigurable(const std::shared_ptr<T> &component)
+{
+    append_options_ = [](po::options_description &) { };
+    configure_ = [](const po::variables_map &) { };
+    run_ = [component] { component->run(); };
+    name_ = [component] { return component->name(); };
+}
+
+void HostedComponent::make(const std::string &type)
+{
+    auto arg = [this](const char *key) {
+        return option_map_[key].as<std::string>();
+    };
+
+    // Refine component type. Types match those of each command's main().
+    if (command_ == "bridge") {
+        // An endpoint SOURCE means this is the receiving side
+        const bool receive = Bridge::isEndpoint(arg("source"));
+        if (type == "frame" && receive)
+            host(std::make_shared<BridgeReceiver<Frame>>(arg("source"), arg("sink")));
+        else if (type == "frame")
+            host(std::make_shared<BridgeSender<Frame>>(arg("source"), arg("sink")));
+        else if (type == "pos2D" && receive)
+            host(std::make_shared<BridgeReceiver<Position2D>>(arg("source"), arg("sink")));
+        else if (type == "pos2D")
+            host(std::make_shared<BridgeSender<Position2D>>(arg("source"), arg("sink")));
+        else if (type == "poslist" && receive)
+            host(std::make_shared<BridgeReceiver<PositionList>>(arg("source"), arg("sink")));
+        else if (type == "poslist")
+            host(std::make_shared<BridgeSender<PositionList>>(arg("source"), arg("sink")));
+    } else if (command_ == "buffer") {
+        if (type == "frame")
+            hostUnconfigurable(
+                std::make_shared<FrameBuffer>(arg("source"), arg("sink")));
+        else if (type == "pos2D")
+            hostUnconfigurable(std::make_shared<TokenBuffer<Position2D>>(
+                arg("source"), arg("sink")));
+        else if (type == "poslist")
+            hostUnconfigurable(std::make_shared<TokenBuffer<PositionList>>(
+                arg("source"), arg("sink")));
+    } else if (command_ == "decorate") {
+        host(std::make_shared<Decorator>(arg("source"), arg("sink")));
+    } else if (command_ == "framefilt") {
+        if (type == "bsub")
+            host(std::make_shared<BackgroundSubtractor>(arg("source"), arg("sink")));
+        else if (type == "mask")
+            host(std::make_shared<FrameMasker>(arg("source"), arg("sink")));
+        else if (type == "mog")
+            host(std::make_shared<BackgroundSubtractorMOG>(arg("source"), arg("sink")));
+        else if (type == "undistort")
+            host(std::make_shared<Undistorter>(arg("source"), arg("sink")));
+        else if (type == "col")
+            host(std::make_shared<ColorConvert>(arg("source"), arg("sink")));
+        else if (type == "thresh")
+            host(std::make_shared<Threshold>(arg("source"), arg("sink")));
+    } else if (command_ == "frameserve") {
+        // Point Grey cameras are left to oat-frameserve
+        if (type == "wcam")
+            host(std::make_shared<WebCam>(arg("sink")));
+        else if (type == "file")
+            host(std::make_shared<FileReader>(arg("sink")));
+        else if (type == "test")
+            host(std::make_shared<TestFrame>(arg("sink")));
+    } else if (command_ == "posicom") {
+        if (type == "mean")
+            host(std::make_shared<MeanPosition>());
+    } else if (command_ == "posidet") {
+        if (type == "diff")
+            host(std::make_shared<DifferenceDetector>(arg("source"), arg("sink")));
+        else if (type == "hsv")
+            host(std::make_shared<HSVDetector>(arg("source"), arg("sink")));
+        else if (type == "thresh")
+            host(std::make_shared<SimpleThreshold>(arg("source"), arg("sink")));
+    } else if (command_ == "posifilt") {
+        if (type == "kalman")
+            host(std::make_shared<KalmanFilter2D>(arg("source"), arg("sink")));
+        else if (type == "homography")
+            host(std::make_shared<HomographyTransform2D>(arg("source"), arg("sink")));
+        else if (type == "region")
+            host(std::make_shared<RegionFilter2D>(arg("source"), arg("sink")));
+    } else if (command_ == "posigen") {
+        if (type == "rand2D")
+            host(std::make_shared<RandomAccel2D>(arg("sink")));
+    } else if (command_ == "posisock") {
+        if (type == "pub")
+            host(std::make_shared<PositionPublisher>(arg("source")));
+        else if (type == "rep")
+            host(std::make_shared<PositionReplier>(arg("source")));
+        else if (type == "udp")
+            host(std::make_shared<UDPPositionClient>(arg("source")));
+        else if (type == "std")
+            host(std::make_shared<PositionCout>(arg("source")));
+    } else if (command_ == "record") {
+        host(std::make_shared<Recorder>());
+    } else if (command_ == "view") {
+        if (type == "frame")
+            host(std::make_shared<ViewerBase>(in_place<FrameViewer>(),
+                                              arg("source")));
+    }
+
+    if (!run_)
+        throw std::runtime_error(command_ + ": Invalid TYPE '" + type
+                                 + "' specified.");
+}
+
+} /* namespace oat */
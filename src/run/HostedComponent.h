@@ -0,0 +1,80 @@
+//******************************************************************************
+//* File:   HostedComponent.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_HOSTEDCOMPONENT_H
+#define OAT_HOSTEDCOMPONENT_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+namespace oat {
+
+/**
+ * @brief A component that runs on a thread of oat-run rather than in its own
+ * process. It is specified by the command and arguments that would be used
+ * to run it on its own, e.g. 'posifilt' and {'kalman', 'pos', 'filt'}.
+ */
+class HostedComponent {
+
+public:
+    /**
+     * @brief Create the component and parse its arguments.
+     * @param command Component command, e.g. 'framefilt'.
+     * @param args Arguments, exactly as they would be given to the command.
+     */
+    HostedComponent(const std::string &command,
+                    const std::vector<std::string> &args);
+
+    /**
+     * @brief Configure the component and run its processing loop until the
+     * end of the stream or until oat::quit is set. Must be called on the
+     * thread that will host the component, because node defaults set during
+     * configuration apply to the calling thread.
+     */
+    void run();
+
+    std::string name(void) const { return name_(); }
+    std::string command(void) const { return command_; }
+
+private:
+    std::string command_;
+    po::variables_map option_map_;
+
+    // Type erased component interface
+    std::function<void(po::options_description &)> append_options_;
+    std::function<void(const po::variables_map &)> configure_;
+    std::function<void(void)> run_;
+    std::function<std::string(void)> name_;
+
+    template <typename T>
+    void host(const std::shared_ptr<T> &component);
+    template <typename T>
+    void hostUnconfigurable(const std::shared_ptr<T> &component);
+
+    void make(const std::string &type);
+};
+
+}      /* namespace oat */
+#endif /* OAT_HOSTEDCOMPONENT_H */
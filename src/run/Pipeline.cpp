@@ -0,0 +1,118 @@
+//******************************************************************************
+//* File:   Pipeline.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Pipeline.h"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <cpptoml.h>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/shmemdf/Segment.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+namespace oat {
+
+Pipeline::Pipeline(const std::string &file)
+{
+    // Will throw if file contains bad syntax
+    auto config = cpptoml::parse_file(file);
+    oat::config::checkKeys({"publish", "component"}, config);
+
+    if (config->contains("publish")) {
+        auto publish = config->get_array_of<std::string>("publish");
+        if (!publish)
+            throw std::runtime_error("'publish' in '" + file + "' must be an "
+                                     "array of node addresses.");
+        published_ = *publish;
+    }
+
+    auto tables = config->get_table_array("component");
+    if (!tables)
+        throw std::runtime_error("'" + file + "' must hold at least one "
+                                 "[[component]] table.");
+
+    for (const auto &t : *tables) {
+
+        oat::config::checkKeys({"command", "args"}, t);
+
+        auto command = t->get_as<std::string>("command");
+        if (!command)
+            throw std::runtime_error("Each [[component]] in '" + file
+                                     + "' needs a 'command'.");
+
+        std::vector<std::string> args;
+        if (t->contains("args")) {
+            auto a = t->get_array_of<std::string>("args");
+            if (!a)
+                throw std::runtime_error("'args' of '" + *command + "' in '"
+                                         + file + "' must be an array of "
+                                         "strings.");
+            args = *a;
+        }
+
+        components_.emplace_back(new HostedComponent(*command, args));
+    }
+
+    // Nodes between the components live in this process's memory
+    oat::localNodes().set_local_by_default(true);
+    for (const auto &p : published_)
+        oat::localNodes().publish(p);
+}
+
+int Pipeline::run()
+{
+    std::atomic<int> failures {0};
+    std::vector<std::thread> threads;
+
+    for (auto &c : components_) {
+
+        auto component = c.get();
+        threads.emplace_back([component, &failures] {
+
+            try {
+                component->run();
+            } catch (const std::exception &ex) {
+                std::cerr << oat::whoError(component->name(), ex.what())
+                          << std::endl;
+                failures++;
+            } catch (...) {
+                std::cerr << oat::whoError(component->name(),
+                                           "Unknown exception.")
+                          << std::endl;
+                failures++;
+            }
+
+            // Components downstream of a failed one would wait forever
+            if (failures > 0)
+                quit = 1;
+        });
+    }
+
+    for (auto &t : threads)
+        t.join();
+
+    return failures;
+}
+
+} /* namespace oat */
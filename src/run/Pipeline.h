@@ -0,0 +1,77 @@
+//******************************************************************************
+//* File:   Pipeline.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_PIPELINE_H
+#define OAT_PIPELINE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HostedComponent.h"
+
+namespace oat {
+
+/**
+ * @brief A set of components, described by a TOML file, that run as threads
+ * of a single process. Nodes between them are private to the process unless
+ * they are listed as published, in which case they are in shared memory
+ * where other processes can attach to them.
+ *
+ * The file holds an optional 'publish' array of node addresses and an array
+ * of 'component' tables, each with a 'command' and its 'args', e.g.
+ *
+ *     publish = ["pos"]
+ *
+ *     [[component]]
+ *     command = "frameserve"
+ *     args = ["test", "raw", "-c", "config.toml", "test"]
+ */
+class Pipeline {
+
+public:
+    /**
+     * @brief Create the pipeline's components and make the nodes between
+     * them private to this process. Must be called before any other SINK or
+     * SOURCE in this process binds or touches a node.
+     * @param file Path to the pipeline's TOML file.
+     */
+    explicit Pipeline(const std::string &file);
+
+    /**
+     * @brief Run each component on its own thread until they have all
+     * exited. If one of them fails, the others are told to quit.
+     * @return Number of components that failed.
+     */
+    int run();
+
+    const std::vector<std::unique_ptr<HostedComponent>> &components() const
+    {
+        return components_;
+    }
+
+    const std::vector<std::string> &published() const { return published_; }
+
+private:
+    std::vector<std::unique_ptr<HostedComponent>> components_;
+    std::vector<std::string> published_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_PIPELINE_H */
@@ -0,0 +1,139 @@
+//******************************************************************************
+//* File:   oat run main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <iostream>
+#include <string>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/program_options.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+
+#include "Pipeline.h"
+
+namespace po = boost::program_options;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: run [INFO]\n"
+              << "   or: run PIPELINE\n"
+              << "Run the components described by the TOML file PIPELINE as "
+                 "threads of a single\nprocess. Nodes between them are kept "
+                 "in this process's memory instead of\nshared memory, unless "
+                 "they are listed in PIPELINE's 'publish' array so that\n"
+                 "other processes can attach to them.\n\n"
+              << options << "\n"
+              << "PIPELINE:\n"
+              << "  A TOML file holding an optional 'publish' array of node "
+                 "addresses and one\n  [[component]] table per component. "
+                 "Each table has a 'command', e.g.\n  'framefilt', and "
+                 "'args', the arguments that would be given to that\n"
+                 "  command on its own.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::string file;
+    po::options_description visible_options("INFO");
+
+    try {
+
+        visible_options.add_options()
+            ("help", "Produce help message.")
+            ("version,v", "Print version information.")
+            ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+            ("pipeline", po::value<std::string>(&file),
+            "Path to the pipeline's TOML file.")
+            ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("pipeline", 1);
+
+        po::options_description all_options("ALL");
+        all_options.add(visible_options).add(hidden);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Run version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("pipeline")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A PIPELINE must be specified.\n");
+            return -1;
+        }
+
+        oat::Pipeline pipeline(file);
+
+        // Tell user
+        for (const auto &c : pipeline.components())
+            std::cout << oat::whoMessage(c->name(), "Hosted by this process.\n");
+        for (const auto &p : pipeline.published())
+            std::cout << oat::whoMessage("run",
+                         "Publishing " + oat::sinkText(p) + ".\n");
+        std::cout << oat::whoMessage("run", "Press CTRL+C to exit.\n");
+
+        // Blocks until every component has exited
+        const int failures = pipeline.run();
+
+        // Tell user
+        std::cout << oat::whoMessage("run", "Exiting.") << std::endl;
+
+        return failures == 0 ? 0 : -1;
+
+    } catch (const po::error &ex) {
+        printUsage(visible_options);
+        std::cerr << oat::whoError("run", ex.what()) << std::endl;
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError("run(TOML) ", ex.what()) << std::endl;
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        std::cerr << oat::whoError("run(SHMEM) ", ex.what()) << std::endl;
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError("run", ex.what()) << std::endl;
+    } catch (...) {
+        std::cerr << oat::whoError("run", "Unknown exception.") << std::endl;
+    }
+
+    // Exit failure
+    return -1;
+}
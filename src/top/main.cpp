@@ -0,0 +1,377 @@
+//******************************************************************************
+//* File:   oat top main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/program_options.hpp>
+
+#include "../../lib/shmemdf/Node.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace po = boost::program_options;
+namespace bip = boost::interprocess;
+namespace bfs = boost::filesystem;
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+// Where POSIX shared memory segments appear on Linux
+static const char *SHMEM_DIR = "/dev/shm";
+static const std::string NODE_SUFFIX = "_node";
+
+// A node that is being monitored and its counters at the last refresh
+struct Watched {
+    bip::managed_shared_memory shmem;
+    const oat::Node *node {nullptr};
+    uint64_t writes {0};
+    uint64_t overruns {0};
+    uint64_t time_ns {0};
+    uint64_t sources {0};
+    oat::LatencyHistogram::Counts wait {};
+    std::array<oat::LatencyHistogram::Counts, oat::Node::NUM_SLOTS> hold {};
+    std::array<uint64_t, oat::Node::NUM_SLOTS> reads {};
+};
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: top [INFO]\n"
+              << "   or: top [NAMES] [CONFIGURATION]\n"
+              << "Monitor the throughput and back-pressure of the nodes at "
+                 "NAMES, or of all\nnodes if none are given. Nodes are only "
+                 "read, so this has no effect on the\ncomponents using them.\n\n"
+              << options << "\n";
+}
+
+// Duration in ns to a short human readable string
+std::string formatDuration(const uint64_t ns)
+{
+    char buf[32];
+    if (ns < 1000)
+        std::snprintf(buf, sizeof(buf), "%lu ns", static_cast<unsigned long>(ns));
+    else if (ns < 1000000)
+        std::snprintf(buf, sizeof(buf), "%.1f us", ns / 1e3);
+    else if (ns < 1000000000)
+        std::snprintf(buf, sizeof(buf), "%.1f ms", ns / 1e6);
+    else
+        std::snprintf(buf, sizeof(buf), "%.1f s", ns / 1e9);
+    return buf;
+}
+
+// Time since a timestamp or '-' if there is none
+std::string formatAge(const uint64_t ts_ns, const uint64_t now_ns)
+{
+    if (ts_ns == 0)
+        return "-";
+    return formatDuration(now_ns > ts_ns ? now_ns - ts_ns : 0);
+}
+
+oat::LatencyHistogram::Counts difference(const oat::LatencyHistogram::Counts &a,
+                                         const oat::LatencyHistogram::Counts &b)
+{
+    oat::LatencyHistogram::Counts d;
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = a[i] >= b[i] ? a[i] - b[i] : a[i];
+    return d;
+}
+
+// Names of all node segments, or only those requested, that currently exist
+std::vector<std::string> findNodes(const std::vector<std::string> &names)
+{
+    std::vector<std::string> nodes;
+
+    if (!names.empty()) {
+        for (const auto &n : names)
+            if (bfs::exists(bfs::path(SHMEM_DIR) / (n + NODE_SUFFIX)))
+                nodes.push_back(n);
+        return nodes;
+    }
+
+    boost::system::error_code ec;
+    for (bfs::directory_iterator it(SHMEM_DIR, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        const std::string f = it->path().filename().string();
+        if (f.size() > NODE_SUFFIX.size()
+            && f.compare(f.size() - NODE_SUFFIX.size(),
+                         NODE_SUFFIX.size(),
+                         NODE_SUFFIX) == 0)
+            nodes.push_back(f.substr(0, f.size() - NODE_SUFFIX.size()));
+    }
+
+    return nodes;
+}
+
+// Map a node's segment read-only. Returns nullptr if it is not ready.
+std::unique_ptr<Watched> watch(const std::string &name)
+{
+    std::unique_ptr<Watched> w(new Watched);
+
+    try {
+        w->shmem = bip::managed_shared_memory(bip::open_read_only,
+                                              (name + NODE_SUFFIX).c_str());
+    } catch (const bip::interprocess_exception &) {
+        return nullptr;
+    }
+
+    // The segment is read-only, so its index cannot be locked
+    w->node = oat::findNode(w->shmem);
+    if (w->node == nullptr)
+        return nullptr;
+
+    w->time_ns = oat::steadyNanoseconds();
+    w->writes = w->node->write_number();
+    w->overruns = w->node->overruns();
+    w->sources = w->node->source_slot_mask();
+    w->wait = w->node->sink_wait().counts();
+    for (size_t i = 0; i < oat::Node::NUM_SLOTS; i++) {
+        w->hold[i] = w->node->read_hold(i).counts();
+        w->reads[i] = w->node->read_count(i);
+    }
+
+    return w;
+}
+
+std::string stateString(const oat::NodeState state)
+{
+    switch (state) {
+        case oat::NodeState::SINK_BOUND: return "BOUND";
+        case oat::NodeState::END: return "END";
+        case oat::NodeState::ERROR: return "ERROR";
+        default: return "WAITING";
+    }
+}
+
+// Print one node and update its counters
+void report(const std::string &name, Watched &w)
+{
+    const oat::Node &node = *w.node;
+    const uint64_t now = oat::steadyNanoseconds();
+    const double dt = (now - w.time_ns) / 1e9;
+
+    const uint64_t writes = node.write_number();
+    const uint64_t overruns = node.overruns();
+    const auto wait_now = node.sink_wait().counts();
+    const auto wait = difference(wait_now, w.wait);
+    const uint64_t dw = writes - w.writes;
+
+    std::printf("%-20s %-8s %5zu %7zu %10.1f %8.1f %10s %10s %10s\n",
+                name.c_str(),
+                stateString(node.sink_state()).c_str(),
+                node.source_ref_count(),
+                node.depth(),
+                dt > 0 ? dw / dt : 0.0,
+                dw > 0 ? 100.0 * (overruns - w.overruns) / dw : 0.0,
+                formatDuration(oat::LatencyHistogram::quantile(wait, 0.5)).c_str(),
+                formatDuration(oat::LatencyHistogram::quantile(wait, 0.99)).c_str(),
+                formatAge(node.last_write_ns(), now).c_str());
+
+    const uint64_t mask = node.source_slot_mask();
+    for (size_t i = 0; i < oat::Node::NUM_SLOTS; i++) {
+
+        const auto hold_now = node.read_hold(i).counts();
+        const auto hold = difference(hold_now, w.hold[i]);
+        w.hold[i] = hold_now;
+
+        if (!(mask & (uint64_t(1) << i)))
+            continue;
+
+        // The SOURCE may leave while we look at it
+        uint64_t cursor;
+        try {
+            cursor = node.read_number(i);
+        } catch (const std::runtime_error &) {
+            continue;
+        }
+
+        // Not yet joined, or dropping and waiting for the next sample
+        if (cursor > writes)
+            cursor = writes;
+
+        // Rates start once the SOURCE has been seen for an interval. SOURCEs
+        // that skip samples read fewer than the SINK writes.
+        const uint64_t reads = node.read_count(i);
+        const bool seen = w.sources & (uint64_t(1) << i);
+        const uint64_t dr = seen && reads >= w.reads[i] ? reads - w.reads[i] : 0;
+        w.reads[i] = reads;
+
+        std::printf("  %-18zu %-8s %5s %7lu %10.1f %8s %10s %10s %10s\n",
+                    i,
+                    "",
+                    "",
+                    static_cast<unsigned long>(writes > cursor ? writes - cursor : 0),
+                    dt > 0 ? dr / dt : 0.0,
+                    "",
+                    formatDuration(oat::LatencyHistogram::quantile(hold, 0.5)).c_str(),
+                    formatDuration(oat::LatencyHistogram::quantile(hold, 0.99)).c_str(),
+                    formatAge(node.last_read_ns(i), now).c_str());
+    }
+
+    w.time_ns = now;
+    w.writes = writes;
+    w.overruns = overruns;
+    w.sources = mask;
+    w.wait = wait_now;
+}
+
+void sigHandler(int) {
+    oat::quit = 1;
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+    std::signal(SIGTERM, sigHandler);
+
+    std::vector<std::string> names;
+    double interval {1.0};
+    bool batch = false;
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+            ("help", "Produce help message.")
+            ("version,v", "Print version information.")
+            ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+            ("interval,i", po::value<double>(&interval),
+             "Seconds between refreshes. Defaults to 1.")
+            ("batch,b", "Batch mode. Append each refresh to the output "
+             "instead of redrawing the terminal, e.g. for logging to a file.")
+            ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+            ("names", po::value< std::vector<std::string> >(),
+            "The names of the nodes to monitor.")
+            ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("names", -1);
+
+        po::options_description all_options("ALL");
+        all_options.add(options).add(config).add(hidden);
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Top version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (interval <= 0)
+            throw std::runtime_error("Refresh interval must be positive.");
+
+        if (variable_map.count("batch"))
+            batch = true;
+
+        if (variable_map.count("names"))
+            names = variable_map["names"].as< std::vector<std::string> >();
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    std::map<std::string, std::unique_ptr<Watched>> watched;
+
+    while (!oat::quit) {
+
+        // Track nodes as they come and go
+        auto found = findNodes(names);
+        std::map<std::string, std::unique_ptr<Watched>> current;
+        for (const auto &n : found) {
+            auto it = watched.find(n);
+            if (it != watched.end())
+                current[n] = std::move(it->second);
+            else if (auto w = watch(n))
+                current[n] = std::move(w);
+        }
+        watched.swap(current);
+
+        // Counters need one interval to produce rates
+        auto wake = std::chrono::steady_clock::now()
+                    + std::chrono::duration<double>(interval);
+        while (!oat::quit && std::chrono::steady_clock::now() < wake)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (oat::quit)
+            break;
+
+        if (!batch)
+            std::cout << "\x1B[2J\x1B[H";
+
+        std::printf("%-20s %-8s %5s %7s %10s %8s %10s %10s %10s\n",
+                    "NODE", "STATE", "SRCS", "DEPTH", "RATE (Hz)", "FULL (%)",
+                    "WAIT p50", "WAIT p99", "WRITTEN");
+        std::printf("  %-18s %-8s %5s %7s %10s %8s %10s %10s %10s\n",
+                    "SOURCE", "", "", "LAG", "RATE (Hz)", "",
+                    "HOLD p50", "HOLD p99", "READ");
+
+        for (auto &w : watched)
+            report(w.first, *w.second);
+
+        if (watched.empty())
+            std::printf("No nodes found.\n");
+
+        if (batch)
+            std::printf("\n");
+
+        std::fflush(stdout);
+    }
+
+    // Exit
+    return 0;
+}
@@ -0,0 +1,401 @@
+//******************************************************************************
+//* File:   oat trace main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/program_options.hpp>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/rapidjson.h>
+#include <rapidjson/writer.h>
+
+#include "../../lib/shmemdf/Node.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace po = boost::program_options;
+namespace bip = boost::interprocess;
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+static const std::string NODE_SUFFIX = "_node";
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: trace [INFO]\n"
+              << "   or: trace NAME [CONFIGURATION]\n"
+              << "Collect the latency traces of the samples that arrive at the "
+                 "node NAME and write\nthem as Chrome trace JSON, which can be "
+                 "opened in chrome://tracing or Perfetto.\nEach trace shows, for "
+                 "every component the sample passed through since it was\n"
+                 "acquired, when the component read it and when it published "
+                 "its result. A\nsummary of where the time went is also "
+                 "printed. The node is only read, so\nthis has no effect on the "
+                 "components using it.\n\n"
+              << options << "\n";
+}
+
+void sigHandler(int) {
+    oat::quit = 1;
+}
+
+// Map a node's segment read-only. Returns nullptr if it is not ready.
+const oat::Node *watch(const std::string &name, bip::managed_shared_memory &shmem)
+{
+    try {
+        shmem = bip::managed_shared_memory(bip::open_read_only,
+                                           (name + NODE_SUFFIX).c_str());
+    } catch (const bip::interprocess_exception &) {
+        return nullptr;
+    }
+
+    // The segment is read-only, so its index cannot be locked
+    return oat::findNode(shmem);
+}
+
+// Copy the trace of write number n. False if it was overwritten first.
+bool copyTrace(const oat::Node &node, const uint64_t n, oat::Trace &t)
+{
+    const size_t depth = node.depth();
+    const size_t i = n % depth;
+
+    // A finished overwrite bumps the write number past n + depth, and one in
+    // progress is caught like a torn read of the latest sample
+    uint32_t seq = node.beginLatestRead(i);
+    t = node.trace(i);
+    return node.endLatestRead(i, seq) && node.write_number() <= n + depth;
+}
+
+// Process name of a PID, or the PID if the process has gone
+std::string processName(const uint32_t pid)
+{
+    std::ifstream comm("/proc/" + std::to_string(pid) + "/comm");
+    std::string name;
+    if (std::getline(comm, name) && !name.empty())
+        return name + " (" + std::to_string(pid) + ")";
+    return std::to_string(pid);
+}
+
+double quantile(std::vector<uint64_t> v, const double q)
+{
+    if (v.empty())
+        return 0;
+
+    std::sort(v.begin(), v.end());
+    return v[static_cast<size_t>(q * (v.size() - 1))] / 1e3;
+}
+
+void writeChromeTrace(const std::vector<oat::Trace> &traces, FILE *fd)
+{
+    char buffer[65536];
+    rapidjson::FileWriteStream stream(fd, buffer, sizeof(buffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> w(stream);
+
+    // Chrome traces are in microseconds from an arbitrary origin
+    uint64_t t0 = traces.front().acquired_ns;
+    for (const auto &t : traces)
+        t0 = std::min(t0, t.acquired_ns);
+    auto us = [t0](const uint64_t ns) { return (ns - t0) / 1e3; };
+
+    std::set<uint32_t> pids;
+    std::set<std::pair<uint32_t, uint32_t>> threads;
+
+    w.StartObject();
+    w.String("displayTimeUnit");
+    w.String("ms");
+    w.String("traceEvents");
+    w.StartArray();
+
+    for (const auto &t : traces) {
+
+        const auto &last = t.stage[t.stages - 1];
+
+        // End to end, on a row of its own
+        w.StartObject();
+        w.String("name"); w.String(("sample " + std::to_string(t.sample)).c_str());
+        w.String("cat"); w.String("sample");
+        w.String("ph"); w.String("X");
+        w.String("ts"); w.Double(us(t.acquired_ns));
+        w.String("dur"); w.Double((last.exit_ns - t.acquired_ns) / 1e3);
+        w.String("pid"); w.Uint(0);
+        w.String("tid"); w.Uint(0);
+        w.EndObject();
+
+        // One slice per component, on the row of the thread that ran it
+        for (uint32_t i = 0; i < t.stages; i++) {
+
+            const auto &s = t.stage[i];
+            pids.insert(s.pid);
+            threads.insert({s.pid, s.tid});
+
+            w.StartObject();
+            w.String("name"); w.String(s.node);
+            w.String("cat"); w.String("stage");
+            w.String("ph"); w.String("X");
+            w.String("ts"); w.Double(us(s.enter_ns));
+            w.String("dur"); w.Double((s.exit_ns - s.enter_ns) / 1e3);
+            w.String("pid"); w.Uint(s.pid);
+            w.String("tid"); w.Uint(s.tid);
+            w.String("args");
+            w.StartObject();
+            w.String("sample"); w.Uint64(t.sample);
+            w.EndObject();
+            w.EndObject();
+        }
+    }
+
+    // Row names
+    auto name = [&w](const char *what, uint32_t pid, uint32_t tid,
+                     const std::string &value) {
+        w.StartObject();
+        w.String("name"); w.String(what);
+        w.String("ph"); w.String("M");
+        w.String("pid"); w.Uint(pid);
+        w.String("tid"); w.Uint(tid);
+        w.String("args");
+        w.StartObject();
+        w.String("name"); w.String(value.c_str());
+        w.EndObject();
+        w.EndObject();
+    };
+
+    name("process_name", 0, 0, "end to end");
+    for (auto pid : pids)
+        name("process_name", pid, 0, processName(pid));
+    for (auto &t : traces)
+        for (uint32_t i = 0; i < t.stages; i++)
+            if (threads.erase({t.stage[i].pid, t.stage[i].tid}))
+                name("thread_name", t.stage[i].pid, t.stage[i].tid,
+                     "writes " + std::string(t.stage[i].node));
+
+    w.EndArray();
+    w.EndObject();
+    stream.Flush();
+}
+
+// Where the time went, stage by stage
+void printSummary(const std::vector<oat::Trace> &traces, std::ostream &out)
+{
+    // Stages are keyed by the node they publish to, in chain order
+    std::vector<std::string> order;
+    std::map<std::string, std::vector<uint64_t>> busy, queued;
+    std::vector<uint64_t> total;
+    uint64_t dropped = 0;
+
+    for (const auto &t : traces) {
+
+        uint64_t prev = t.acquired_ns;
+        for (uint32_t i = 0; i < t.stages; i++) {
+
+            const auto &s = t.stage[i];
+            if (!busy.count(s.node))
+                order.push_back(s.node);
+
+            busy[s.node].push_back(s.exit_ns - s.enter_ns);
+            queued[s.node].push_back(s.enter_ns > prev ? s.enter_ns - prev : 0);
+            prev = s.exit_ns;
+        }
+
+        total.push_back(prev - t.acquired_ns);
+        dropped += t.dropped;
+    }
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-24s %8s %12s %12s %12s %12s\n",
+                  "STAGE", "SAMPLES", "QUEUED p50", "QUEUED p99", "BUSY p50",
+                  "BUSY p99");
+    out << line;
+
+    for (const auto &n : order) {
+        std::snprintf(line, sizeof(line),
+                      "%-24s %8zu %9.1f us %9.1f us %9.1f us %9.1f us\n",
+                      n.c_str(), busy[n].size(),
+                      quantile(queued[n], 0.5), quantile(queued[n], 0.99),
+                      quantile(busy[n], 0.5), quantile(busy[n], 0.99));
+        out << line;
+    }
+
+    std::snprintf(line, sizeof(line),
+                  "%-24s %8zu %12s %12s %9.1f us %9.1f us\n",
+                  "END TO END", total.size(), "", "",
+                  quantile(total, 0.5), quantile(total, 0.99));
+    out << line;
+
+    if (dropped > 0)
+        out << dropped << " stages did not fit in their trace and are "
+               "missing.\n";
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+    std::signal(SIGTERM, sigHandler);
+
+    std::string name;
+    size_t samples {100};
+    std::string output;
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+            ("help", "Produce help message.")
+            ("version,v", "Print version information.")
+            ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+            ("samples,n", po::value<size_t>(&samples),
+             "Number of samples to trace. Defaults to 100.")
+            ("output,o", po::value<std::string>(&output),
+             "File to write the Chrome trace to. Defaults to standard output, "
+             "in which case the summary is written to standard error.")
+            ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+            ("name", po::value<std::string>(&name),
+            "The name of the node to trace.")
+            ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("name", 1);
+
+        po::options_description all_options("ALL");
+        all_options.add(options).add(config).add(hidden);
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Trace version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("name")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A node NAME must be specified.\n");
+            return -1;
+        }
+
+        if (samples == 0)
+            throw std::runtime_error("At least one sample must be traced.");
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    // Wait for the node to appear
+    bip::managed_shared_memory shmem;
+    const oat::Node *node = nullptr;
+    while (!oat::quit && (node = watch(name, shmem)) == nullptr)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Only samples published from now on are traced
+    std::vector<oat::Trace> traces;
+    traces.reserve(samples);
+    uint64_t next = node ? node->write_number() : 0;
+    uint64_t missed = 0;
+
+    while (!oat::quit && traces.size() < samples
+           && node->sink_state() != oat::NodeState::END) {
+
+        const uint64_t written = node->write_number();
+        if (written == next) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            continue;
+        }
+
+        // Samples that were overwritten before we got to them are missed
+        const uint64_t depth = node->depth();
+        if (written - next > depth) {
+            missed += written - next - depth;
+            next = written - depth;
+        }
+
+        for (; next < written && traces.size() < samples; next++) {
+            oat::Trace t;
+            if (copyTrace(*node, next, t) && t.stages > 0
+                && t.stages <= oat::Trace::MAX_STAGES)
+                traces.push_back(t);
+            else
+                missed++;
+        }
+    }
+
+    if (traces.empty()) {
+        std::cerr << oat::Error("No samples were traced.\n");
+        return -1;
+    }
+
+    FILE *fd = stdout;
+    if (!output.empty() && (fd = std::fopen(output.c_str(), "wb")) == nullptr) {
+        std::cerr << oat::Error("Could not open " + output + ".\n");
+        return -1;
+    }
+
+    writeChromeTrace(traces, fd);
+
+    if (fd != stdout)
+        std::fclose(fd);
+
+    std::ostream &out = fd == stdout ? std::cerr : std::cout;
+    printSummary(traces, out);
+    if (missed > 0)
+        out << missed << " samples were published too quickly to be traced.\n";
+
+    // Exit
+    return 0;
+}
@@ -56,6 +56,9 @@ po::options_description FrameViewer::options(void) const
          "If a folder is designated, the base file name will be SOURCE. "
          "The time stamp of the snapshot will be prepended to the file name. "
          "Defaults to the current directory.")
+        ("latest-only,l",
+         "Only display the newest frame. Frames produced while the viewer is "
+         "busy are skipped rather than holding up upstream components.")
         ;
 
     return local_opts;
@@ -93,6 +96,12 @@ void FrameViewer::applyConfiguration(const po::variables_map &vm,
         min_max_defined_ = true;
     }
 
+    // Source mode
+    bool latest_only = false;
+    oat::config::getValue<bool>(vm, config_table, "latest-only", latest_only);
+    if (latest_only)
+        source_mode_ = oat::SourceMode::LATEST;
+
     // Snapshot save path
     std::string snapshot_path = "./";
     oat::config::getValue(vm, config_table, "snapshot-path", snapshot_path);
@@ -122,10 +131,15 @@ void FrameViewer::display(const oat::Frame &frame)
     if (frame.rows == 0 || frame.cols == 0)
         return;
 
+    // Raw sensor formats are only expanded for display
+    cv::Mat image = frame;
+    if (oat::is_raw(frame.color()))
+        oat::convertColor(frame, image, frame.color(), oat::PIX_BGR);
+
     if (min_max_defined_)
-        cv::LUT(frame, lut_, frame);
+        cv::LUT(image, lut_, image);
 
-    cv::imshow(name_, frame);
+    cv::imshow(name_, image);
     char command = cv::waitKey(1);
 
     if (command == 's') {
@@ -141,7 +155,7 @@ void FrameViewer::display(const oat::Frame &frame)
                 true);
 
         if (!err) {
-            cv::imwrite(fid, frame);
+            cv::imwrite(fid, image);
             std::cout << "Snapshot saved to " << fid << "\n";
         } else {
             std::cerr << oat::Error("Snapshot file creation exited "
@@ -35,9 +35,6 @@ Viewer<T>::Viewer(const std::string &source_address)
 {
     // Initialize GUI update timer
     tock_ = Clock::now();
-
-    // Start display thread
-    display_thread_ = std::thread( [this] {processAsync();} );
 }
 
 template <typename T>
@@ -45,19 +42,24 @@ Viewer<T>::~Viewer()
 {
     running_ = false;
     display_cv_.notify_one();
-    display_thread_.join();
+    if (display_thread_.joinable())
+        display_thread_.join();
 }
 
 template <typename T>
 bool Viewer<T>::connectToNode()
 {
     // Establish our a slot in the node
-    source_.touch(source_address_);
+    source_.touch(source_address_, source_mode_);
 
     // Wait for synchronous start with sink when it binds the node
     if (source_.connect() != SourceState::CONNECTED)
         return false;
 
+    // Start display thread, once configured so that it gets our helper
+    // scheduling
+    display_thread_ = oat::startHelper([this] { processAsync(); });
+
     return true;
 }
 
@@ -30,6 +30,7 @@
 
 #include "../../lib/base/Component.h"
 #include "../../lib/base/Configurable.h"
+#include "../../lib/base/Scheduling.h"
 #include "../../lib/shmemdf/Source.h"
 
 namespace po = boost::program_options;
@@ -67,6 +68,9 @@ protected:
     using Milliseconds = std::chrono::milliseconds;
     Milliseconds min_update_period_ms {33};
 
+    // LATEST to read only the newest sample without holding up the SINK
+    oat::SourceMode source_mode_ {oat::SourceMode::BLOCKING};
+
     /**
      * @brief Perform sample display. Override to implement display operation
      * in derived classes.
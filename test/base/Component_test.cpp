@@ -0,0 +1,153 @@
+//******************************************************************************
+//* File:   Component_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../lib/base/Component.h"
+
+// Records the sample at which each command was applied
+class Mock : public oat::Component {
+public:
+    using oat::Component::applyCommands;
+    using oat::Component::control;
+
+    std::string name(void) const override { return "mock"; }
+    oat::ComponentType type(void) const override { return oat::mock; }
+
+    // Process sample n
+    void step(const uint64_t n)
+    {
+        sample_ = n;
+        applyCommands(n);
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> applied;
+
+protected:
+    bool connectToNode(void) override { return true; }
+    int process(void) override { return 1; }
+
+    void applyCommand(const std::string &command) override
+    {
+        applied.emplace_back(command, sample_);
+    }
+
+    oat::CommandDescription commands(void) override
+    {
+        return {{"start", "Start"}, {"stop", "Stop"}};
+    }
+
+private:
+    uint64_t sample_ {0};
+};
+
+SCENARIO ("Components apply commands at the sample they were sent for.",
+          "[Component]") {
+
+    GIVEN ("A component that has processed up to sample 10") {
+
+        Mock m;
+        m.step(10);
+
+        WHEN ("a command is sent for a later sample") {
+
+            REQUIRE (m.control("start", "13") == 0);
+
+            THEN ("it is applied at exactly that sample") {
+                m.step(11);
+                m.step(12);
+                REQUIRE (m.applied.empty());
+                m.step(13);
+                REQUIRE (m.applied.size() == 1);
+                REQUIRE (m.applied[0].first == "start");
+                REQUIRE (m.applied[0].second == 13);
+                m.step(14);
+                REQUIRE (m.applied.size() == 1);
+            }
+        }
+
+        WHEN ("a command is sent for a sample that has passed") {
+
+            REQUIRE (m.control("start", "5") == 0);
+
+            THEN ("it is applied late, at the next sample") {
+                m.step(11);
+                REQUIRE (m.applied.size() == 1);
+                REQUIRE (m.applied[0].second == 11);
+            }
+        }
+
+        WHEN ("a command is sent without a sample") {
+
+            REQUIRE (m.control("start", "") == 0);
+
+            THEN ("it is applied at the next sample") {
+                m.step(11);
+                REQUIRE (m.applied.size() == 1);
+                REQUIRE (m.applied[0].second == 11);
+            }
+        }
+
+        WHEN ("commands for several samples arrive out of order") {
+
+            m.control("stop", "14");
+            m.control("start", "12");
+            m.control("stop", "");
+            m.control("start", "12");
+
+            THEN ("each is applied at its sample, in the order they arrived") {
+                m.step(11);
+                REQUIRE (m.applied.size() == 1);
+                REQUIRE (m.applied[0] == std::make_pair(std::string("stop"), uint64_t(11)));
+                m.step(12);
+                REQUIRE (m.applied.size() == 3);
+                REQUIRE (m.applied[1] == std::make_pair(std::string("start"), uint64_t(12)));
+                REQUIRE (m.applied[2] == std::make_pair(std::string("start"), uint64_t(12)));
+                m.step(14);
+                REQUIRE (m.applied.size() == 4);
+                REQUIRE (m.applied[3] == std::make_pair(std::string("stop"), uint64_t(14)));
+            }
+        }
+
+        WHEN ("an unknown command, or one with an invalid sample, is sent") {
+
+            REQUIRE (m.control("jump", "") == 0);
+            REQUIRE (m.control("start", "soon") == 0);
+
+            THEN ("it is ignored") {
+                m.step(11);
+                REQUIRE (m.applied.empty());
+            }
+        }
+
+        WHEN ("quit is sent") {
+
+            THEN ("it is acted on at once rather than queued") {
+                REQUIRE (m.control("quit", "20") == 1);
+                m.step(20);
+                REQUIRE (m.applied.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,301 @@
+//******************************************************************************
+//* File:   StagePipeline_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/base/StagePipeline.h"
+
+using msec = std::chrono::milliseconds;
+
+// Stages that pass numbered samples through a pipeline's slots
+struct Stages {
+
+    explicit Stages(const size_t depth) : slots(depth, 0) { }
+
+    // Sample held by each slot
+    std::vector<uint64_t> slots;
+
+    uint64_t read_count {0};
+    std::vector<uint64_t> computed;
+    std::vector<uint64_t> written;
+
+    // Samples read but not yet written
+    std::atomic<size_t> in_flight {0};
+    size_t max_in_flight {0};
+
+    // Read returns 1 once this many samples have been read
+    uint64_t end {UINT64_MAX};
+
+    int read(const size_t slot)
+    {
+        if (read_count == end)
+            return 1;
+
+        slots[slot] = read_count++;
+        max_in_flight = std::max(max_in_flight, ++in_flight);
+        return 0;
+    }
+
+    void compute(const size_t slot) { computed.push_back(slots[slot]); }
+
+    void write(const size_t slot)
+    {
+        written.push_back(slots[slot]);
+        --in_flight;
+    }
+
+    void run(oat::StagePipeline &pipeline)
+    {
+        pipeline.run([this](size_t s) { return read(s); },
+                     [this](size_t s) { compute(s); },
+                     [this](size_t s) { write(s); });
+    }
+};
+
+// The samples 0 to n - 1, in order
+std::vector<uint64_t> sequence(const uint64_t n)
+{
+    std::vector<uint64_t> seq(n);
+    for (uint64_t i = 0; i < n; i++)
+        seq[i] = i;
+    return seq;
+}
+
+SCENARIO ("Stage pipelines need at least one slot.", "[StagePipeline]") {
+
+    GIVEN ("A depth of zero") {
+
+        THEN ("Constructing a pipeline shall throw") {
+            REQUIRE_THROWS( oat::StagePipeline pipeline(0); );
+        }
+    }
+}
+
+SCENARIO ("Stage pipelines pass every sample through each stage in order.",
+          "[StagePipeline]") {
+
+    GIVEN ("A pipeline three slots deep and a stream of 1000 samples") {
+
+        const size_t depth = 3;
+        oat::StagePipeline pipeline(depth);
+        Stages stages(depth);
+        stages.end = 1000;
+
+        WHEN ("The pipeline runs") {
+
+            stages.run(pipeline);
+
+            THEN ("Each sample shall be computed and written in the order it "
+                  "was read") {
+                REQUIRE (stages.computed == sequence(1000));
+                REQUIRE (stages.written == sequence(1000));
+                REQUIRE (stages.in_flight.load() == 0);
+            }
+        }
+    }
+
+    GIVEN ("A pipeline one slot deep") {
+
+        oat::StagePipeline pipeline(1);
+        Stages stages(1);
+        stages.end = 100;
+
+        WHEN ("The pipeline runs") {
+
+            stages.run(pipeline);
+
+            THEN ("It shall process one sample at a time") {
+                REQUIRE (stages.written == sequence(100));
+                REQUIRE (stages.max_in_flight == 1);
+            }
+        }
+    }
+}
+
+SCENARIO ("Stage pipelines hold no more samples than they have slots.",
+          "[StagePipeline]") {
+
+    GIVEN ("A pipeline four slots deep whose write stage is slow") {
+
+        const size_t depth = 4;
+        oat::StagePipeline pipeline(depth);
+        Stages stages(depth);
+        stages.end = 50;
+
+        WHEN ("The pipeline runs") {
+
+            pipeline.run([&](size_t s) { return stages.read(s); },
+                         [&](size_t s) { stages.compute(s); },
+                         [&](size_t s) {
+                             std::this_thread::sleep_for(msec(1));
+                             stages.write(s);
+                         });
+
+            THEN ("The read stage shall fill, but never overrun, the slots") {
+                REQUIRE (stages.max_in_flight == depth);
+                REQUIRE (stages.written == sequence(50));
+            }
+        }
+    }
+}
+
+SCENARIO ("Stage pipelines finish the samples in flight when the stream "
+          "ends.", "[StagePipeline]") {
+
+    GIVEN ("A pipeline whose compute stage is slow") {
+
+        const size_t depth = 3;
+        oat::StagePipeline pipeline(depth);
+        Stages stages(depth);
+        stages.end = 10;
+
+        size_t in_flight_at_end = 0;
+
+        WHEN ("The read stage reaches the end of the stream") {
+
+            pipeline.run(
+                [&](size_t s) {
+                    const int rc = stages.read(s);
+                    if (rc)
+                        in_flight_at_end = stages.in_flight;
+                    return rc;
+                },
+                [&](size_t s) {
+                    std::this_thread::sleep_for(msec(2));
+                    stages.compute(s);
+                },
+                [&](size_t s) { stages.write(s); });
+
+            THEN ("Samples already read shall still be computed and "
+                  "written") {
+                REQUIRE (in_flight_at_end > 0);
+                REQUIRE (stages.computed == sequence(10));
+                REQUIRE (stages.written == sequence(10));
+            }
+        }
+    }
+}
+
+SCENARIO ("Stage pipelines stop when quit is set.", "[StagePipeline]") {
+
+    GIVEN ("A pipeline reading an endless stream") {
+
+        const size_t depth = 3;
+        oat::StagePipeline pipeline(depth);
+        Stages stages(depth);
+
+        WHEN ("quit is set while writing sample 20") {
+
+            pipeline.run([&](size_t s) { return stages.read(s); },
+                         [&](size_t s) { stages.compute(s); },
+                         [&](size_t s) {
+                             if (stages.slots[s] == 20)
+                                 oat::quit = 1;
+                             stages.write(s);
+                         });
+            oat::quit = 0;
+
+            THEN ("The pipeline shall stop once the samples read are "
+                  "written") {
+                REQUIRE (stages.read_count > 20);
+                REQUIRE (stages.read_count <= 20 + depth + 1);
+                REQUIRE (stages.written == sequence(stages.read_count));
+            }
+        }
+    }
+}
+
+SCENARIO ("Stage pipelines stop and rethrow when a stage throws.",
+          "[StagePipeline]") {
+
+    GIVEN ("A pipeline reading an endless stream") {
+
+        const size_t depth = 3;
+        oat::StagePipeline pipeline(depth);
+        Stages stages(depth);
+
+        WHEN ("The compute stage throws at sample 20") {
+
+            auto run = [&] {
+                pipeline.run([&](size_t s) { return stages.read(s); },
+                             [&](size_t s) {
+                                 if (stages.slots[s] == 20)
+                                     throw std::runtime_error("compute");
+                                 stages.compute(s);
+                             },
+                             [&](size_t s) { stages.write(s); });
+            };
+
+            THEN ("run() shall rethrow it once the other stages stop") {
+                REQUIRE_THROWS_AS( run(), std::runtime_error );
+                REQUIRE (stages.computed == sequence(20));
+                REQUIRE (stages.written.size() <= 20);
+            }
+        }
+
+        WHEN ("The write stage throws at sample 20") {
+
+            auto run = [&] {
+                pipeline.run([&](size_t s) { return stages.read(s); },
+                             [&](size_t s) { stages.compute(s); },
+                             [&](size_t s) {
+                                 if (stages.slots[s] == 20)
+                                     throw std::runtime_error("write");
+                                 stages.write(s);
+                             });
+            };
+
+            THEN ("run() shall rethrow it once the other stages stop") {
+                REQUIRE_THROWS_AS( run(), std::runtime_error );
+                REQUIRE (stages.written == sequence(20));
+            }
+        }
+
+        WHEN ("The compute and write stages both throw") {
+
+            auto run = [&] {
+                pipeline.run([&](size_t s) { return stages.read(s); },
+                             [&](size_t s) {
+                                 if (stages.slots[s] == 20)
+                                     throw std::logic_error("compute");
+                                 stages.compute(s);
+                             },
+                             [&](size_t s) {
+                                 if (stages.slots[s] == 10)
+                                     throw std::runtime_error("write");
+                                 stages.write(s);
+                             });
+            };
+
+            THEN ("run() shall rethrow the first") {
+                REQUIRE_THROWS_AS( run(), std::runtime_error );
+            }
+        }
+    }
+}
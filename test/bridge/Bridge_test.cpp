@@ -0,0 +1,253 @@
+//******************************************************************************
+//* File:   Bridge_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/program_options.hpp>
+#include <opencv2/core.hpp>
+
+#include "../../lib/datatypes/Color.h"
+#include "../../lib/datatypes/Sample.h"
+#include "../../lib/shmemdf/Node.h"
+#include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+#include "../../src/bridge/BridgeReceiver.h"
+#include "../../src/bridge/BridgeSender.h"
+
+namespace bip = boost::interprocess;
+namespace po = boost::program_options;
+
+using msec = std::chrono::milliseconds;
+
+// A frame to publish upstream of the bridge
+struct Sent {
+    cv::Mat pixels;
+    oat::PixelColor color;
+    size_t step; // 0 for tightly packed rows
+    oat::Sample sample;
+};
+
+// A frame published downstream of the bridge. Frames are not stored
+// themselves since copies share the sample of the frame they copy.
+struct Received {
+    cv::Mat pixels;
+    oat::PixelColor color;
+    oat::Sample sample;
+};
+
+// BGR frames, then GREY frames of another size, then larger BGR frames with
+// padded rows. Counts skip and times are irregular, as with dropped frames
+// and an external clock.
+std::vector<Sent> makeFrames()
+{
+    struct Geometry { int rows, cols; oat::PixelColor color; bool padded; };
+    const std::vector<Geometry> geometry {
+        {48, 64, oat::PIX_BGR, false},
+        {48, 64, oat::PIX_BGR, false},
+        {48, 64, oat::PIX_BGR, false},
+        {30, 40, oat::PIX_GREY, false},
+        {30, 40, oat::PIX_GREY, false},
+        {60, 80, oat::PIX_BGR, true},
+        {60, 80, oat::PIX_BGR, true},
+    };
+
+    std::vector<Sent> frames;
+    oat::Sample sample(1.0 / 30.0);
+    for (size_t i = 0; i < geometry.size(); i++) {
+        const auto &g = geometry[i];
+        Sent f;
+        f.pixels = cv::Mat(g.rows, g.cols, oat::cv_type(g.color));
+        cv::randu(f.pixels, cv::Scalar::all(0), cv::Scalar::all(256));
+        f.color = g.color;
+        f.step = g.padded ? oat::paddedStep(g.cols, f.pixels.type()) : 0;
+        for (size_t j = 0; j <= i % 2; j++)
+            sample.incrementCount(oat::Sample::Microseconds(
+                1000 + 33367 * i + i * i));
+        f.sample = sample;
+        frames.push_back(f);
+    }
+
+    return frames;
+}
+
+// Bytes needed to hold the largest frame
+size_t capacity(const std::vector<Sent> &frames)
+{
+    size_t bytes = 0;
+    for (const auto &f : frames) {
+        const size_t row_bytes = f.pixels.cols * f.pixels.elemSize();
+        bytes = std::max(bytes, f.pixels.rows * (f.step ? f.step : row_bytes));
+    }
+    return bytes;
+}
+
+// Wait until a SOURCE has joined a node
+void waitForSource(const std::string &address)
+{
+    for (;;) {
+        try {
+            bip::managed_shared_memory shmem(bip::open_read_only,
+                                             (address + "_node").c_str());
+            const oat::Node *node = oat::findNode(shmem);
+            if (node != nullptr && node->source_ref_count() > 0)
+                return;
+        } catch (const bip::interprocess_exception &) {
+            // Not created yet
+        }
+        std::this_thread::sleep_for(msec(1));
+    }
+}
+
+void configure(oat::Bridge &bridge, const std::vector<std::string> &args)
+{
+    po::options_description options;
+    bridge.appendOptions(options);
+    po::variables_map vm;
+    po::store(po::command_line_parser(args).options(options).run(), vm);
+    po::notify(vm);
+    bridge.configure(vm);
+}
+
+// Publish frames to a bridge's sending side over loopback TCP, with any
+// extra sender arguments, and return the frames that its receiving side
+// publishes
+std::vector<Received> runBridge(const std::vector<Sent> &frames,
+                                const std::vector<std::string> &sender_args)
+{
+    static int run = 0;
+    const std::string in_addr = "bridge_test_in" + std::to_string(run);
+    const std::string out_addr = "bridge_test_out" + std::to_string(run);
+    const std::string endpoint
+        = "tcp://127.0.0.1:" + std::to_string(5570 + run);
+    run++;
+
+    std::unique_ptr<oat::Sink<oat::Frame>> sink(new oat::Sink<oat::Frame>);
+    sink->bind(in_addr, capacity(frames));
+    sink->retrieve(frames[0].pixels.rows, frames[0].pixels.cols,
+                   frames[0].pixels.type(), frames[0].color, frames[0].step);
+
+    auto sending = std::async(std::launch::async, [&] {
+        oat::BridgeSender<oat::Frame> sender(in_addr, endpoint);
+        configure(sender, sender_args);
+        sender.run();
+    });
+
+    auto receiving = std::async(std::launch::async, [&] {
+        oat::BridgeReceiver<oat::Frame> receiver(endpoint, out_addr);
+        configure(receiver, {});
+        receiver.run();
+    });
+
+    // The receiving side binds its SINK when the first frame arrives, so
+    // connect() returns once publishing has started
+    oat::Source<oat::Frame> source;
+    source.touch(out_addr);
+
+    auto publishing = std::async(std::launch::async, [&] {
+        // Frames published before the sending side joins are not sent
+        waitForSource(in_addr);
+
+        for (size_t i = 0; i < frames.size(); i++) {
+            const Sent &f = frames[i];
+            sink->wait();
+            oat::Frame shared = sink->retrieve();
+            if (i > 0 && (f.pixels.size() != frames[i - 1].pixels.size()
+                          || f.color != frames[i - 1].color
+                          || f.step != frames[i - 1].step))
+                shared = sink->reshape(f.pixels.rows, f.pixels.cols,
+                                       f.pixels.type(), f.color, f.step);
+            f.pixels.copyTo(shared);
+            shared.set_sample(f.sample);
+            sink->post();
+        }
+        sink.reset(); // END
+    });
+
+    std::vector<Received> received;
+    source.connect();
+    while (source.wait() != oat::NodeState::END) {
+        const oat::Frame f = source.clone();
+        received.push_back({f, f.color(), f.sample()});
+        source.post();
+    }
+
+    publishing.get();
+    sending.get();
+    receiving.get();
+
+    return received;
+}
+
+// Require that frames came across the bridge unchanged
+void requireSame(const std::vector<Received> &received,
+                 const std::vector<Sent> &sent)
+{
+    REQUIRE (received.size() == sent.size());
+    for (size_t i = 0; i < sent.size(); i++) {
+        INFO ("Frame " + std::to_string(i));
+        const Received &r = received[i];
+        REQUIRE (r.pixels.size() == sent[i].pixels.size());
+        REQUIRE (r.pixels.type() == sent[i].pixels.type());
+        REQUIRE (r.color == sent[i].color);
+        REQUIRE (cv::norm(r.pixels, sent[i].pixels, cv::NORM_INF) == 0);
+        REQUIRE (r.sample.count() == sent[i].sample.count());
+        REQUIRE (r.sample.microseconds() == sent[i].sample.microseconds());
+    }
+}
+
+SCENARIO ("Frame bridges carry frames between nodes over TCP.", "[Bridge]") {
+
+    GIVEN ("Frames whose geometry changes, with irregular sample numbers "
+           "and times") {
+
+        cv::theRNG().state = 0x0A7;
+        const auto frames = makeFrames();
+
+        WHEN ("they are sent as raw pixels") {
+
+            const auto received = runBridge(frames, {});
+
+            THEN ("the receiving side shall publish the same frames and "
+                  "samples, then END") {
+                requireSame(received, frames);
+            }
+        }
+
+        WHEN ("they are sent as PNGs") {
+
+            const auto received = runBridge(frames, {"--compress", "png"});
+
+            THEN ("the receiving side shall publish the same frames and "
+                  "samples, then END") {
+                requireSame(received, frames);
+            }
+        }
+    }
+}
@@ -0,0 +1,232 @@
+//******************************************************************************
+//* File:   FrameFilter_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/datatypes/Color.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+#include "../../src/framefilter/BackgroundSubtractor.h"
+#include "../../src/framefilter/ColorConvert.h"
+#include "../../src/framefilter/FrameMasker.h"
+#include "../../src/framefilter/Threshold.h"
+#include "../../src/framefilter/Undistorter.h"
+
+namespace po = boost::program_options;
+
+// Rows that do not split evenly into bands, and even for Bayer mosaics
+const int rows = 70;
+const int cols = 96;
+const size_t n_frames = 4;
+const size_t n_threads = 3;
+
+const std::string mask_path = "FrameFilter_test_mask.png";
+
+using Args = std::function<std::vector<std::string>(oat::PixelColor)>;
+
+std::unique_ptr<oat::FrameFilter> makeFilter(const std::string &type,
+                                             const std::string &source,
+                                             const std::string &sink)
+{
+    std::unique_ptr<oat::FrameFilter> filter;
+    if (type == "bsub")
+        filter.reset(new oat::BackgroundSubtractor(source, sink));
+    else if (type == "col")
+        filter.reset(new oat::ColorConvert(source, sink));
+    else if (type == "mask")
+        filter.reset(new oat::FrameMasker(source, sink));
+    else if (type == "thresh")
+        filter.reset(new oat::Threshold(source, sink));
+    else if (type == "undistort")
+        filter.reset(new oat::Undistorter(source, sink));
+
+    return filter;
+}
+
+std::vector<cv::Mat> randomFrames(const oat::PixelColor color)
+{
+    std::vector<cv::Mat> frames;
+    for (size_t i = 0; i < n_frames; i++) {
+        cv::Mat frame(rows, cols, oat::cv_type(color));
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+        frames.push_back(frame);
+    }
+
+    return frames;
+}
+
+// Publish frames to a filter of a type, run with a number of threads, and
+// return the frames it publishes
+std::vector<cv::Mat> runFilter(const std::string &type,
+                               std::vector<std::string> args,
+                               const std::vector<cv::Mat> &frames,
+                               const oat::PixelColor color,
+                               const size_t threads)
+{
+    static int run = 0;
+    const std::string source_addr = "ffilt_test_in" + std::to_string(run);
+    const std::string sink_addr = "ffilt_test_out" + std::to_string(run);
+    run++;
+
+    std::unique_ptr<oat::Sink<oat::Frame>> sink(new oat::Sink<oat::Frame>);
+    sink->bind(source_addr, frames[0].total() * frames[0].elemSize());
+    sink->retrieve(rows, cols, frames[0].type(), color);
+
+    // Run options apply to the thread that configures the component
+    args.push_back("--threads");
+    args.push_back(std::to_string(threads));
+    auto filtering = std::async(std::launch::async, [&] {
+        auto filter = makeFilter(type, source_addr, sink_addr);
+        po::options_description options;
+        filter->appendOptions(options);
+        po::variables_map vm;
+        po::store(po::command_line_parser(args).options(options).run(), vm);
+        po::notify(vm);
+        filter->configure(vm);
+        filter->run();
+    });
+
+    // The filter has joined our SINK by the time it binds its own, so it
+    // reads every frame published from here on
+    oat::Source<oat::Frame> source;
+    source.touch(sink_addr);
+    source.connect();
+
+    auto publishing = std::async(std::launch::async, [&] {
+        for (const auto &f : frames) {
+            auto shared = sink->acquireWriteBuffer();
+            f.copyTo(shared);
+            shared.incrementSampleCount();
+            sink->publish();
+        }
+        sink.reset(); // END
+    });
+
+    std::vector<cv::Mat> filtered;
+    while (source.wait() != oat::NodeState::END) {
+        filtered.push_back(source.clone());
+        source.post();
+    }
+
+    publishing.get();
+    filtering.get();
+
+    return filtered;
+}
+
+// Filter frames of each color with one thread, which calls filter(), and with
+// several, which split each frame into bands, and require the same frames
+void requireBandsMatch(const std::string &type, Args args)
+{
+    for (auto color : {oat::PIX_GREY, oat::PIX_BGR, oat::PIX_BAYER_RGGB}) {
+
+        INFO ("Filtering " + oat::color_str(color) + " frames");
+
+        const auto frames = randomFrames(color);
+        const auto whole = runFilter(type, args(color), frames, color, 1);
+        const auto banded
+            = runFilter(type, args(color), frames, color, n_threads);
+
+        REQUIRE (whole.size() == frames.size());
+        REQUIRE (banded.size() == whole.size());
+        for (size_t i = 0; i < whole.size(); i++) {
+            REQUIRE (banded[i].size() == whole[i].size());
+            REQUIRE (banded[i].type() == whole[i].type());
+            REQUIRE (cv::norm(banded[i], whole[i], cv::NORM_INF) == 0);
+        }
+    }
+}
+
+SCENARIO ("Frame filters split into bands produce the same frames as "
+          "filtering whole frames.", "[FrameFilter]") {
+
+    GIVEN ("Random GREY, BGR and Bayer frames") {
+
+        cv::theRNG().state = 0x0A7;
+
+        WHEN ("they are background subtracted") {
+
+            THEN ("bands shall match whole frames") {
+                requireBandsMatch("bsub", [](oat::PixelColor) {
+                    return std::vector<std::string>{"-a", "0.25"};
+                });
+            }
+        }
+
+        WHEN ("they are masked") {
+
+            cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+            cv::circle(mask, cv::Point(cols / 2, rows / 2), rows / 3,
+                       cv::Scalar(255), -1);
+            REQUIRE (cv::imwrite(mask_path, mask));
+
+            THEN ("bands shall match whole frames") {
+                requireBandsMatch("mask", [](oat::PixelColor) {
+                    return std::vector<std::string>{"-f", mask_path};
+                });
+            }
+
+            std::remove(mask_path.c_str());
+        }
+
+        WHEN ("they are thresholded") {
+
+            THEN ("bands shall match whole frames") {
+                requireBandsMatch("thresh", [](oat::PixelColor) {
+                    return std::vector<std::string>{"-I", "[60,180]"};
+                });
+            }
+        }
+
+        WHEN ("their color is converted") {
+
+            THEN ("bands shall match whole frames") {
+                requireBandsMatch("col", [](oat::PixelColor color) {
+                    const std::string to = color == oat::PIX_BGR ? "GREY"
+                                                                 : "BGR";
+                    return std::vector<std::string>{"-C", to};
+                });
+            }
+        }
+
+        WHEN ("they are undistorted") {
+
+            THEN ("bands shall match whole frames") {
+                requireBandsMatch("undistort", [](oat::PixelColor) {
+                    return std::vector<std::string>{
+                        "-k", "[60.0,0.0,48.0,0.0,60.0,35.0,0.0,0.0,1.0]",
+                        "-d", "[-0.3,0.1,0.001,0.001,0.0]"};
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+//******************************************************************************
+//* File:   Node_bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Measures the cost of the SINK publishing a sample and of each SOURCE
+// marking it read as the number of SOURCEs grows. Everything runs on one
+// thread so that only the node's bookkeeping is timed, not the scheduler.
+// Both columns should stay flat as SOURCEs are added.
+//
+// Usage: Node_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../../lib/shmemdf/Node.h"
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+int main(int argc, char *argv[])
+{
+    using Clock = std::chrono::steady_clock;
+    using NSec = std::chrono::duration<double, std::nano>;
+
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                       : 100000;
+
+    std::printf("%8s %16s %20s\n", "sources", "post (ns)", "read complete (ns)");
+
+    for (size_t n = 1; n <= oat::Node::NUM_SLOTS; n *= 2) {
+
+        oat::Node node;
+        std::vector<size_t> slots(n);
+        for (auto &s : slots)
+            node.acquireSlot(s);
+
+        NSec post {0}, read {0};
+        for (size_t i = 0; i < iterations; i++) {
+
+            auto t0 = Clock::now();
+            node.notifySinkWriteComplete();
+            auto t1 = Clock::now();
+            for (auto s : slots)
+                node.notifySourceReadComplete(s, node.lease(s));
+            auto t2 = Clock::now();
+
+            post += t1 - t0;
+            read += t2 - t1;
+        }
+
+        std::printf("%8zu %16.1f %20.1f\n",
+                    n,
+                    post.count() / iterations,
+                    read.count() / (iterations * n));
+    }
+
+    return 0;
+}
@@ -20,6 +20,13 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <chrono>
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "../../lib/shmemdf/Node.h"
 
 // Global via extern in Globals.h
@@ -54,11 +61,11 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
             }
         }
 
-        WHEN ("a negatively indexed read-barrier is read") {
+        WHEN ("a negatively indexed read cursor is read") {
 
             THEN ("The Node shall throw") {
                 REQUIRE_THROWS(
-                    boost::interprocess::interprocess_semaphore &s = node.read_barrier(-1);
+                    uint64_t n = node.read_number(-1);
                 );
             }
         }
@@ -68,11 +75,324 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
             size_t idx;
             node.acquireSlot(idx);
 
-            THEN ("reading a greater indexed read-barrier shall throw") {
+            THEN ("reading a greater indexed read cursor shall throw") {
                 REQUIRE_THROWS(
-                boost::interprocess::interprocess_semaphore &s = node.read_barrier(idx+1);
+                uint64_t n = node.read_number(idx+1);
                 );
             }
         }
     }
 }
+
+SCENARIO ("Nodes can hold up to Node::MAX_DEPTH samples.", "[Node]") {
+
+    GIVEN ("A fresh Node with a single source") {
+
+        oat::Node node;
+        size_t idx;
+        node.acquireSlot(idx);
+        REQUIRE (node.depth() == 1);
+
+        WHEN ("the depth is set out of range") {
+
+            THEN ("The Node shall throw") {
+                REQUIRE_THROWS(node.set_depth(0));
+                REQUIRE_THROWS(node.set_depth(oat::Node::MAX_DEPTH + 1));
+            }
+        }
+
+        WHEN ("the depth is set to 3 and the sink writes 3 times") {
+
+            node.set_depth(3);
+            for (size_t i = 0; i < 3; i++) {
+                REQUIRE (node.writeBufferFree());
+                REQUIRE (node.write_index() == i);
+                node.notifySinkWriteComplete();
+            }
+
+            THEN ("the sink cannot write again until the source reads") {
+                REQUIRE (!node.writeBufferFree());
+                REQUIRE (node.readBufferReady(idx));
+                REQUIRE (node.notifySourceReadComplete(idx, node.lease(idx)));
+                REQUIRE (node.writeBufferFree());
+            }
+
+            THEN ("the source reads each sample in order") {
+                for (size_t i = 0; i < 3; i++) {
+                    REQUIRE (node.readBufferReady(idx));
+                    REQUIRE (node.read_index(idx) == i);
+                    REQUIRE (node.notifySourceReadComplete(idx, node.lease(idx)));
+                }
+                REQUIRE (!node.readBufferReady(idx));
+            }
+
+            THEN ("releasing the source frees all 3 samples") {
+                REQUIRE (node.releaseSlot(idx) == 3);
+            }
+        }
+    }
+}
+
+SCENARIO ("Nodes keep telemetry on their SINK and SOURCEs.", "[Node]") {
+
+    GIVEN ("A fresh Node with a single source") {
+
+        oat::Node node;
+        size_t idx;
+        REQUIRE (node.acquireSlot(idx) == 0);
+        REQUIRE (node.source_slot_mask() == 1);
+        REQUIRE (node.sink_wait().total() == 0);
+        REQUIRE (node.last_write_ns() == 0);
+
+        WHEN ("the sink writes a sample and the source reads it") {
+
+            REQUIRE (node.waitWriteBufferFree(oat::quit));
+            node.notifySinkWriteComplete();
+            REQUIRE (node.waitReadBufferReady(idx, node.lease(idx), oat::quit));
+            node.notifySourceReadComplete(idx, node.lease(idx));
+
+            THEN ("the sink did not wait and both were timestamped") {
+                REQUIRE (node.sink_wait().count(0) == 1);
+                REQUIRE (node.overruns() == 0);
+                REQUIRE (node.last_write_ns() > 0);
+                REQUIRE (node.last_read_ns(idx) >= node.last_write_ns());
+                REQUIRE (node.read_hold(idx).total() == 1);
+            }
+        }
+
+        WHEN ("the sink must wait for the source to read") {
+
+            node.notifySinkWriteComplete();
+            REQUIRE (!node.writeBufferFree());
+
+            std::thread source([&node, idx] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                node.waitReadBufferReady(idx, node.lease(idx), oat::quit);
+                node.notifySourceReadComplete(idx, node.lease(idx));
+            });
+            REQUIRE (node.waitWriteBufferFree(oat::quit));
+            source.join();
+
+            THEN ("the wait is counted as an overrun and timed") {
+                REQUIRE (node.overruns() == 1);
+                REQUIRE (node.sink_wait().total() == 1);
+                REQUIRE (node.sink_wait().quantile(0.5) >= 10000000);
+            }
+        }
+
+        WHEN ("the source is replaced") {
+
+            REQUIRE (node.waitWriteBufferFree(oat::quit));
+            node.notifySinkWriteComplete();
+            REQUIRE (node.waitReadBufferReady(idx, node.lease(idx), oat::quit));
+            node.notifySourceReadComplete(idx, node.lease(idx));
+            node.releaseSlot(idx);
+            REQUIRE (node.acquireSlot(idx) == 0);
+
+            THEN ("the new source's telemetry starts empty") {
+                REQUIRE (node.read_hold(idx).total() == 0);
+                REQUIRE (node.last_read_ns(idx) == 0);
+            }
+        }
+    }
+}
+
+SCENARIO ("Sinks evict sources that can no longer read.", "[Node]") {
+
+    GIVEN ("A Node in memory shared with a child process") {
+
+        void *mem = mmap(nullptr, sizeof(oat::Node), PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        REQUIRE (mem != MAP_FAILED);
+        oat::Node *node = new (mem) oat::Node;
+
+        using clock = std::chrono::steady_clock;
+
+        WHEN ("a source in the child takes a slot and dies without releasing it") {
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                size_t i;
+                node->acquireSlot(i);
+                _exit(0);
+            }
+            waitpid(pid, nullptr, 0);
+            REQUIRE (node->source_ref_count() == 1);
+
+            node->notifySinkWriteComplete();
+            auto start = clock::now();
+            REQUIRE (node->waitWriteBufferFree(oat::quit));
+            auto waited = clock::now() - start;
+
+            THEN ("the sink evicts it and continues within a bounded time") {
+                REQUIRE (node->evictions() == 1);
+                REQUIRE (node->source_ref_count() == 0);
+                REQUIRE (waited < std::chrono::seconds(1));
+            }
+        }
+
+        WHEN ("a live source holds a sample past the node's source timeout") {
+
+            size_t idx;
+            node->acquireSlot(idx);
+            const uint64_t lease = node->lease(idx);
+            node->set_source_timeout(std::chrono::milliseconds(200));
+
+            node->notifySinkWriteComplete();
+            REQUIRE (node->waitReadBufferReady(idx, lease, oat::quit));
+            auto start = clock::now();
+            REQUIRE (node->waitWriteBufferFree(oat::quit));
+            auto waited = clock::now() - start;
+
+            THEN ("the sink evicts it after the timeout") {
+                REQUIRE (node->evictions() == 1);
+                REQUIRE (waited >= std::chrono::milliseconds(200));
+                REQUIRE (waited < std::chrono::seconds(1));
+            }
+
+            THEN ("the source no longer owns its slot and cannot release it") {
+                REQUIRE_FALSE (node->ownsSlot(idx, lease));
+                REQUIRE (node->releaseSlot(idx, lease) == -1);
+            }
+
+            THEN ("the source cannot finish its read or wait for another") {
+                REQUIRE (node->notifySourceReadComplete(idx, lease) == -1);
+                REQUIRE_FALSE (node->waitReadBufferReady(idx, lease, oat::quit));
+            }
+        }
+
+        WHEN ("a live source holds a sample and there is no source timeout") {
+
+            size_t idx;
+            node->acquireSlot(idx);
+            node->notifySinkWriteComplete();
+            REQUIRE (node->waitReadBufferReady(idx, node->lease(idx), oat::quit));
+
+            THEN ("it is not evicted") {
+                REQUIRE (node->evictStaleSources() == 0);
+                REQUIRE (node->ownsSlot(idx, node->lease(idx)));
+            }
+        }
+
+        node->~Node();
+        munmap(mem, sizeof(oat::Node));
+    }
+}
+
+SCENARIO ("Sources only hold up their SINK for the samples their policy "
+           "reads.", "[Node]") {
+
+    GIVEN ("A Node of depth 2 with a blocking source") {
+
+        oat::Node node;
+        node.set_depth(2);
+        size_t block;
+        REQUIRE (node.acquireSlot(block) == 0);
+
+        WHEN ("a source reading every 3rd sample is added") {
+
+            size_t every;
+            REQUIRE (node.acquireSlot(
+                every, oat::SourcePolicy(oat::SourcePolicy::EVERY, 3)) == 0);
+
+            THEN ("it is only required to read every 3rd sample") {
+                for (uint64_t n = 0; n < 12; n++) {
+                    REQUIRE (node.writeBufferFree());
+                    node.notifySinkWriteComplete();
+                    REQUIRE (node.notifySourceReadComplete(block, node.lease(block)) == (n % 3 != 0));
+                    if (n % 3 == 0) {
+                        REQUIRE (node.readBufferReady(every));
+                        REQUIRE (node.read_number(every) == n);
+                        REQUIRE (node.notifySourceReadComplete(every, node.lease(every)));
+                    }
+                    REQUIRE (!node.readBufferReady(every));
+                }
+                REQUIRE (node.read_count(block) == 12);
+                REQUIRE (node.read_count(every) == 4);
+            }
+        }
+
+        WHEN ("a dropping source is added and reads once") {
+
+            size_t drop;
+            REQUIRE (node.acquireSlot(
+                drop, oat::SourcePolicy(oat::SourcePolicy::DROP)) == 0);
+
+            node.notifySinkWriteComplete();
+            REQUIRE (node.readBufferReady(drop));
+            REQUIRE (node.read_number(drop) == 0);
+
+            THEN ("samples published while it holds the last are skipped") {
+                node.notifySourceReadComplete(block, node.lease(block));
+                REQUIRE (node.writeBufferFree());
+                node.notifySinkWriteComplete();
+                REQUIRE (node.notifySourceReadComplete(block, node.lease(block)));
+
+                // The ring wraps onto the sample the dropping source holds
+                REQUIRE (!node.writeBufferFree());
+                REQUIRE (node.notifySourceReadComplete(drop, node.lease(drop)));
+                REQUIRE (node.writeBufferFree());
+                REQUIRE (!node.readBufferReady(drop));
+
+                // It takes the next sample published after it released
+                node.notifySinkWriteComplete();
+                REQUIRE (node.readBufferReady(drop));
+                REQUIRE (node.read_number(drop) == 2);
+                REQUIRE (node.read_count(drop) == 1);
+            }
+
+            THEN ("releasing its slot frees the sample it held") {
+                node.notifySourceReadComplete(block, node.lease(block));
+                REQUIRE (node.releaseSlot(drop) == 1);
+                REQUIRE (node.writeBufferFree());
+            }
+        }
+    }
+
+    GIVEN ("Policies in program option form") {
+
+        THEN ("valid policies are parsed") {
+            REQUIRE (oat::sourcePolicy("block").kind == oat::SourcePolicy::BLOCK);
+            REQUIRE (oat::sourcePolicy("drop").kind == oat::SourcePolicy::DROP);
+            REQUIRE (oat::sourcePolicy("every-25").kind == oat::SourcePolicy::EVERY);
+            REQUIRE (oat::sourcePolicy("every-25").n == 25);
+        }
+
+        THEN ("invalid policies throw") {
+            REQUIRE_THROWS (oat::sourcePolicy("every-0"));
+            REQUIRE_THROWS (oat::sourcePolicy("every-"));
+            REQUIRE_THROWS (oat::sourcePolicy("every--1"));
+            REQUIRE_THROWS (oat::sourcePolicy("every-99999999999"));
+            REQUIRE_THROWS (oat::sourcePolicy("latest"));
+        }
+    }
+}
+
+SCENARIO ("LatencyHistograms bin durations by powers of two.", "[Node]") {
+
+    GIVEN ("An empty histogram") {
+
+        oat::LatencyHistogram h;
+        REQUIRE (h.total() == 0);
+        REQUIRE (h.quantile(0.5) == 0);
+
+        WHEN ("durations are recorded") {
+
+            h.record(0);
+            h.record(1);
+            h.record(1000);
+            h.record(~uint64_t(0));
+
+            THEN ("each lands in the bucket whose upper edge bounds it") {
+                REQUIRE (h.total() == 4);
+                REQUIRE (h.count(0) == 1);
+                REQUIRE (h.count(1) == 1);
+                REQUIRE (h.count(10) == 1);
+                REQUIRE (h.count(oat::LatencyHistogram::NUM_BUCKETS - 1) == 1);
+                REQUIRE (h.quantile(0) == 0);
+                REQUIRE (h.quantile(0.5) == 2);
+                REQUIRE (h.quantile(0.75) == 1024);
+            }
+        }
+    }
+}
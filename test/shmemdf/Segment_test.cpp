@@ -0,0 +1,190 @@
+//******************************************************************************
+//* File:   Segment_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <thread>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "../../lib/datatypes/Color.h"
+#include "../../lib/shmemdf/Segment.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+namespace bip = boost::interprocess;
+
+const std::string local_addr = "test_local";
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+// True if a named shared memory segment exists
+bool isShared(const std::string &name)
+{
+    try {
+        bip::shared_memory_object shm(bip::open_only, name.c_str(),
+                                      bip::read_only);
+        return true;
+    } catch (const bip::interprocess_exception &) {
+        return false;
+    }
+}
+
+SCENARIO ("Local nodes live in process memory.", "[Segment]") {
+
+    oat::localNodes().add(local_addr);
+
+    GIVEN ("A Sink<int> and Source<int> on a local node") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        sink.bind(local_addr);
+        source.touch(local_addr);
+
+        WHEN ("The source connects") {
+
+            REQUIRE(source.connect() == oat::SourceState::CONNECTED);
+
+            THEN ("No named shared memory is created") {
+                REQUIRE(oat::localNodes().contains(local_addr));
+                REQUIRE_FALSE(isShared(local_addr + "_node"));
+                REQUIRE_FALSE(isShared(local_addr + "_obj"));
+            }
+        }
+
+        WHEN ("The sink publishes samples from another thread") {
+
+            REQUIRE(source.connect() == oat::SourceState::CONNECTED);
+
+            std::thread writer([&sink] {
+                for (int i = 0; i < 100; i++) {
+                    sink.wait();
+                    *sink.retrieve() = i;
+                    sink.post();
+                }
+            });
+
+            bool in_order = true;
+            for (int i = 0; i < 100; i++) {
+                source.wait();
+                in_order &= source.clone() == i;
+                source.post();
+            }
+
+            writer.join();
+
+            THEN ("The source receives every sample in order") {
+                REQUIRE(in_order);
+            }
+        }
+    }
+
+    GIVEN ("A Sink<Frame> and Source<Frame> on a local node") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(local_addr, 64 * 64);
+        auto frame = sink.retrieve(64, 64, CV_8UC1, oat::PIX_GREY);
+        source.touch(local_addr);
+
+        WHEN ("The sink publishes a frame") {
+
+            REQUIRE(source.connect() == oat::SourceState::CONNECTED);
+
+            sink.wait();
+            frame = sink.retrieve();
+            frame.data[0] = 42;
+            sink.post();
+
+            source.wait();
+            auto view = source.retrieve();
+            source.post();
+
+            THEN ("The source sees the frame's data without a copy") {
+                REQUIRE(view->data == frame.data);
+                REQUIRE(view->data[0] == 42);
+            }
+        }
+    }
+}
+
+SCENARIO ("Local segments are named like shared memory.", "[Segment]") {
+
+    const std::string name = local_addr + "_seg";
+    oat::localNodes().add(local_addr + "_seg");
+
+    GIVEN ("A local segment created with create_only") {
+
+        oat::Segment::remove(name + "_node");
+        oat::Segment seg(bip::create_only, name + "_node", 4096);
+
+        THEN ("It is local") {
+            REQUIRE(seg.local());
+        }
+
+        THEN ("Creating it again throws") {
+            REQUIRE_THROWS(
+                oat::Segment(bip::create_only, name + "_node", 4096));
+        }
+
+        WHEN ("It is opened by name") {
+
+            auto p = seg.find_or_construct<int>("x")(7);
+            oat::Segment other(bip::open_only, name + "_node");
+
+            THEN ("Objects and handles are shared") {
+                REQUIRE(*other.find<int>("x").first == 7);
+                REQUIRE(other.get_address_from_handle(
+                            seg.get_handle_from_address(p)) == p);
+            }
+        }
+
+        WHEN ("It is removed") {
+
+            auto p = seg.find_or_construct<int>("x")(7);
+            REQUIRE(oat::Segment::remove(name + "_node"));
+
+            THEN ("It can no longer be opened, but stays mapped") {
+                REQUIRE_THROWS(oat::Segment(bip::open_only, name + "_node"));
+                REQUIRE(*p == 7);
+            }
+        }
+    }
+}
+
+SCENARIO ("Nodes can be made local by default.", "[Segment]") {
+
+    GIVEN ("Nodes that are local by default and one published node") {
+
+        oat::localNodes().set_local_by_default(true);
+        oat::localNodes().publish("test_published");
+
+        THEN ("Only the published node is in shared memory") {
+            REQUIRE(oat::localNodes().contains("test_unpublished"));
+            REQUIRE_FALSE(oat::localNodes().contains("test_published"));
+        }
+
+        oat::localNodes().set_local_by_default(false);
+    }
+}
@@ -20,11 +20,16 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <csignal>
 #include <string>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "../../lib/datatypes/Color.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
 
 const std::string node_addr = "test";
 
@@ -183,3 +188,85 @@ SCENARIO ("Sink<SharedFrameHeader> must bind() before waiting, posting, or alloc
         }
     }
 }
+
+SCENARIO ("Sinks can pin their shared memory.", "[Sink]") {
+
+    GIVEN ("A Sink<Frame> and pinned node memory") {
+
+        oat::nodeDefaults().pin_memory = true;
+        oat::Sink<oat::Frame> sink;
+
+        WHEN ("The sink binds a node and retrieves a frame") {
+
+            THEN ("The sink shall not throw") {
+                REQUIRE_NOTHROW(
+                    sink.bind(node_addr, 64 * 64 * 3);
+                    sink.retrieve(64, 64, CV_8UC3, oat::PIX_BGR);
+                );
+            }
+        }
+
+        oat::nodeDefaults().pin_memory = false;
+    }
+
+    GIVEN ("A segment size") {
+
+        const size_t bytes = 1024 + 640 * 480 * 3;
+
+        THEN ("Rounding to huge pages gives a larger, whole number of pages") {
+            size_t rounded = oat::hugePageRound(bytes);
+            REQUIRE(rounded >= bytes);
+            REQUIRE(rounded % oat::HUGE_PAGE_BYTES == 0);
+            REQUIRE(oat::hugePageRound(rounded) == rounded);
+        }
+    }
+}
+
+SCENARIO ("Nodes left behind by a SINK that crashed are reclaimed.", "[Sink]") {
+
+    GIVEN ("A source connected to a node whose SINK's process was killed") {
+
+        const std::string addr = "crashed";
+
+        int ready[2];
+        REQUIRE (pipe(ready) == 0);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            oat::Sink<int> sink;
+            sink.bind(addr);
+            char c = 1;
+            if (write(ready[1], &c, 1) == 1)
+                pause();
+            _exit(0);
+        }
+
+        char c;
+        REQUIRE (read(ready[0], &c, 1) == 1);
+        close(ready[0]);
+        close(ready[1]);
+
+        oat::Source<int> source;
+        source.touch(addr);
+        REQUIRE (source.connect() == oat::SourceState::CONNECTED);
+
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+
+        WHEN ("the source waits for the next sample") {
+
+            THEN ("it sees the END of the stream") {
+                REQUIRE (source.wait() == oat::NodeState::END);
+            }
+        }
+
+        WHEN ("a new sink binds the same address") {
+
+            oat::Sink<int> sink;
+
+            THEN ("the stale node is replaced") {
+                REQUIRE_NOTHROW (sink.bind(addr));
+            }
+        }
+    }
+}
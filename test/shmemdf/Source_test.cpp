@@ -20,7 +20,9 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <cstring>
 #include <string>
+#include <thread>
 
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 #include "../../lib/shmemdf/Sink.h"
@@ -31,70 +33,39 @@ namespace oat { volatile sig_atomic_t quit = 0; }
 
 const std::string node_addr = "test";
 
-SCENARIO ("Up to 10 sources can connect a single Node.", "[Source]") {
+// Token with per-node metadata
+struct Scaled { int value {0}; };
+namespace oat { template <> struct Metadata<Scaled> { int scale {1}; }; }
 
-    GIVEN ("11 sources and a bound sink with common node address") {
+SCENARIO ("Up to Node::NUM_SLOTS sources can connect a single Node.", "[Source]") {
+
+    GIVEN ("Node::NUM_SLOTS+1 sources and a bound sink with common node address") {
+
+        const size_t n = oat::Node::NUM_SLOTS;
 
         oat::Sink<int> sink;
 
         INFO ("The sink binds a node");
         sink.bind(node_addr);
-        oat::Source<int> s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10;
+        oat::Source<int> sources[oat::Node::NUM_SLOTS + 1];
 
         WHEN ("sources 0 to Oat::Node:NUM_SLOTS connect a node") {
 
-            THEN ("The first 10 connections will succeed") {
-                REQUIRE_NOTHROW(
-                    s0.touch(node_addr);
-                    s1.touch(node_addr);
-                    s2.touch(node_addr);
-                    s3.touch(node_addr);
-                    s4.touch(node_addr);
-                    s5.touch(node_addr);
-                    s6.touch(node_addr);
-                    s7.touch(node_addr);
-                    s8.touch(node_addr);
-                    s9.touch(node_addr);
-
-                    s0.connect();
-                    s1.connect();
-                    s2.connect();
-                    s3.connect();
-                    s4.connect();
-                    s5.connect();
-                    s6.connect();
-                    s7.connect();
-                    s8.connect();
-                    s9.connect();
-                );
+            THEN ("The first Node::NUM_SLOTS connections will succeed") {
+                for (size_t i = 0; i < n; i++) {
+                    REQUIRE_NOTHROW(sources[i].touch(node_addr));
+                    REQUIRE_NOTHROW(sources[i].connect());
+                }
             }
 
             AND_THEN ("The oat::Node:NUM_SLOTS+1 connection shall throw") {
-                REQUIRE_THROWS(
-                    s0.touch(node_addr);
-                    s1.touch(node_addr);
-                    s2.touch(node_addr);
-                    s3.touch(node_addr);
-                    s4.touch(node_addr);
-                    s5.touch(node_addr);
-                    s6.touch(node_addr);
-                    s7.touch(node_addr);
-                    s8.touch(node_addr);
-                    s9.touch(node_addr);
-                    s10.touch(node_addr);
-
-                    s0.connect();
-                    s1.connect();
-                    s2.connect();
-                    s3.connect();
-                    s4.connect();
-                    s5.connect();
-                    s6.connect();
-                    s7.connect();
-                    s8.connect();
-                    s9.connect();
-                    s10.connect();
-                );
+                for (size_t i = 0; i < n; i++) {
+                    sources[i].touch(node_addr);
+                    sources[i].connect();
+                }
+
+                sources[n].touch(node_addr);
+                REQUIRE_THROWS(sources[n].connect());
             }
         }
     }
@@ -215,4 +186,154 @@ SCENARIO ("Connected sources can retrieve shared objects to mutate them.", "[Sou
 }
 
 
+SCENARIO ("Sources that hold up their SINK past the source timeout are evicted.", "[Source]") {
+
+    GIVEN ("A connected source and a sink with a source timeout") {
+
+        oat::nodeDefaults().source_timeout = std::chrono::milliseconds(200);
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+        oat::nodeDefaults().source_timeout = std::chrono::milliseconds(0);
+
+        oat::Source<int> source;
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("the source holds a sample that the sink needs to overwrite") {
+
+            sink.wait();
+            sink.post();
+            REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+
+            REQUIRE_NOTHROW (sink.wait());
+
+            THEN ("the sink continues and the source is told it was evicted") {
+                REQUIRE_THROWS (source.post());
+            }
+        }
+    }
+}
+
+SCENARIO ("Sources read the samples chosen by their policy.", "[Source]") {
+
+    GIVEN ("A bound sink and a source that reads every other sample by default") {
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        oat::nodeDefaults().source_policy =
+            oat::SourcePolicy(oat::SourcePolicy::EVERY, 2);
+        oat::Source<int> source;
+        source.touch(node_addr);
+        oat::nodeDefaults().source_policy = oat::SourcePolicy();
+        source.connect();
+
+        REQUIRE (source.policy().kind == oat::SourcePolicy::EVERY);
+        REQUIRE (source.policy().n == 2);
+
+        WHEN ("the sink publishes six samples without waiting for the source") {
+
+            int n = 0;
+            for (int i = 0; i < 6; i++) {
+                sink.wait();
+                *sink.retrieve() = i;
+                sink.post();
+
+                if (i % 2 == 0) {
+                    REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+                    REQUIRE (*source.retrieve() == i);
+                    source.post();
+                    n++;
+                }
+            }
+
+            THEN ("the source read every other sample") {
+                REQUIRE (n == 3);
+            }
+        }
+    }
+}
+
+SCENARIO ("Sources can read the metadata that their SINK set.", "[Source]") {
+
+    GIVEN ("A sink with metadata and a source") {
+
+        oat::Metadata<Scaled> m;
+        m.scale = 3;
+
+        oat::Sink<Scaled> sink;
+        sink.set_metadata(m);
+        oat::Source<Scaled> source;
+        source.touch(node_addr);
+
+        WHEN ("the source reads the metadata before it connects") {
+
+            THEN ("the source shall throw") {
+                REQUIRE_THROWS (source.metadata());
+            }
+        }
+
+        WHEN ("the sink binds and the source connects") {
+
+            sink.bind(node_addr);
+            source.connect();
+
+            THEN ("the source reads the sink's metadata") {
+                REQUIRE (source.metadata().scale == 3);
+            }
+
+            THEN ("the sink cannot change its metadata") {
+                REQUIRE_THROWS (sink.set_metadata(m));
+            }
+        }
+    }
+}
+
+SCENARIO ("Samples carry a latency trace through the nodes they pass through.", "[Source]") {
+
+    GIVEN ("Two nodes and a source that reads the first") {
+
+        oat::Sink<int> head;
+        head.bind("trace_head");
+        oat::Source<int> source;
+        source.touch("trace_head");
+        source.connect();
+        oat::Sink<int> tail;
+        tail.bind("trace_tail");
+
+        WHEN ("a sample is published to the first node and passed on to the second") {
+
+            // Each component has its own thread, and so its own tracer
+            std::thread([&] { head.wait(); head.post(); }).join();
+            std::thread([&] {
+                source.wait();
+                source.post();
+                tail.wait();
+                tail.post();
+            }).join();
+
+            THEN ("the second node holds a stage for each component") {
+
+                boost::interprocess::managed_shared_memory shmem(
+                    boost::interprocess::open_read_only,
+                    "trace_tail_node");
+                const oat::Node *node = oat::findNode(shmem);
+                REQUIRE (node != nullptr);
+
+                const oat::Trace &t = node->trace(0);
+                REQUIRE (t.stages == 2);
+                REQUIRE (t.dropped == 0);
+                REQUIRE (t.sample == 0);
+                REQUIRE (std::strcmp(t.stage[0].node, "trace_head") == 0);
+                REQUIRE (std::strcmp(t.stage[1].node, "trace_tail") == 0);
+                REQUIRE (t.acquired_ns == t.stage[0].enter_ns);
+                REQUIRE (t.stage[0].exit_ns >= t.stage[0].enter_ns);
+                REQUIRE (t.stage[1].enter_ns >= t.stage[0].exit_ns);
+                REQUIRE (t.stage[1].exit_ns >= t.stage[1].enter_ns);
+            }
+        }
+    }
+}
+
 // TODO: specialization tests
@@ -525,3 +525,459 @@ SCENARIO ("Sources attaching or detaching during source or sink wait() periods "
         }
     }
 }
+
+SCENARIO ("A Sink bound to a Node with depth N can write N samples ahead "
+          "of its slowest Source.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink with depth 3 and a source") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        sink.set_depth(3);
+        sink.bind(node_addr, 0);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes 3 samples without the source reading") {
+
+            for (int i = 1; i <= 3; i++) {
+                REQUIRE_NOTHROW(sink.wait());
+                *sink.retrieve() = i;
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            THEN ("The sink shall block on the 4th write until the source post()'s") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+
+                // Pause for 5 ms
+                std::this_thread::sleep_for(msec(5));
+
+                // Check to see that the sink has not stopped waiting
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status != std::future_status::ready);
+
+                // The source reads the first sample
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE(*source.retrieve() == 1);
+                REQUIRE_NOTHROW(source.post());
+
+                // Give sufficient time for wait to release
+                std::this_thread::sleep_for(msec(1));
+                status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+            }
+
+            THEN ("The source shall read the samples in the order they were written") {
+
+                for (int i = 1; i <= 3; i++) {
+                    REQUIRE_NOTHROW(source.wait());
+                    REQUIRE(*source.retrieve() == i);
+                    REQUIRE_NOTHROW(source.post());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("A Source<Frame> read lease holds the shared frame until it is "
+          "destroyed.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A Sink<Frame> and a connected Source<Frame>") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(node_addr, 16);
+        auto shared_frame = sink.retrieve(4, 4, CV_8UC1, oat::PIX_GREY);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes a frame and the source leases it") {
+
+            REQUIRE_NOTHROW(sink.wait());
+            shared_frame.data[0] = 42;
+            REQUIRE_NOTHROW(sink.post());
+
+            REQUIRE_NOTHROW(source.wait());
+
+            THEN ("The lease refers to the shared frame without a copy") {
+
+                auto lease = source.lease();
+                REQUIRE(lease->data[0] == 42);
+
+                // Changes to shared memory are visible through the lease
+                shared_frame.data[0] = 43;
+                REQUIRE(lease->data[0] == 43);
+            }
+
+            THEN ("The sink shall block until the lease is destroyed") {
+
+                std::future<void> fut;
+                {
+                    auto lease = source.lease();
+                    fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+
+                    // Pause for 5 ms
+                    std::this_thread::sleep_for(msec(5));
+
+                    // Check to see that the sink has not stopped waiting
+                    auto status = fut.wait_for(msec(0));
+                    REQUIRE(status != std::future_status::ready);
+                }
+
+                // Give sufficient time for wait to release
+                std::this_thread::sleep_for(msec(1));
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+
+                // The lease posted, so the source must wait() again
+                REQUIRE_THROWS(source.post());
+            }
+        }
+    }
+}
+
+SCENARIO ("Raw Bayer frames pass through nodes undemosaiced.",
+          "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A Sink<Frame> publishing RGGB frames and a connected Source<Frame>") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(node_addr, 16);
+        auto shared_frame = sink.retrieve(4, 4, CV_8UC1, oat::PIX_BAYER_RGGB);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes a flat red mosaic") {
+
+            REQUIRE_NOTHROW(sink.wait());
+            shared_frame.setTo(0);
+            for (int r = 0; r < 4; r += 2)
+                for (int c = 0; c < 4; c += 2)
+                    shared_frame.at<uint8_t>(r, c) = 200;
+            REQUIRE_NOTHROW(sink.post());
+
+            REQUIRE_NOTHROW(source.wait());
+            auto frame = source.clone();
+            REQUIRE_NOTHROW(source.post());
+
+            THEN ("The source receives one byte per pixel") {
+                REQUIRE(frame.color() == oat::PIX_BAYER_RGGB);
+                REQUIRE(frame.type() == CV_8UC1);
+                REQUIRE(source.parameters().bytes == 16);
+            }
+
+            THEN ("Demosaicing it on the source side gives red pixels") {
+                cv::Mat bgr;
+                oat::convertColor(frame, bgr, frame.color(), oat::PIX_BGR);
+                REQUIRE(bgr.type() == CV_8UC3);
+                auto px = bgr.at<cv::Vec3b>(1, 1);
+                REQUIRE(px[2] == 200);
+                REQUIRE(px[1] == 0);
+                REQUIRE(px[0] == 0);
+            }
+
+            THEN ("It can be converted to HSV by way of BGR") {
+                cv::Mat hsv;
+                REQUIRE_NOTHROW(oat::convertColor(
+                    frame, hsv, frame.color(), oat::PIX_HSV));
+                REQUIRE(hsv.type() == CV_8UC3);
+            }
+        }
+    }
+}
+
+SCENARIO ("A Sink<Frame> can render into its back buffer while sources read "
+          "the published frame.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A Sink<Frame> and a connected Source<Frame>") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(node_addr, 16);
+        sink.retrieve(4, 4, CV_8UC1, oat::PIX_GREY);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink publishes a frame rendered in its back buffer") {
+
+            auto frame = sink.acquireWriteBuffer();
+            frame.data[0] = 42;
+            frame.incrementSampleCount();
+            REQUIRE_NOTHROW(sink.publish());
+
+            THEN ("The source reads the rendered frame") {
+
+                REQUIRE_NOTHROW(source.wait());
+                auto lease = source.lease();
+                REQUIRE(lease->data[0] == 42);
+                REQUIRE(lease->sample_count() == 1);
+            }
+
+            THEN ("The sink can render the next frame while the source holds "
+                  "a lease on the last one") {
+
+                REQUIRE_NOTHROW(source.wait());
+
+                std::future<void> fut;
+                {
+                    auto lease = source.lease();
+
+                    // Acquiring the back buffer does not wait for the source
+                    auto next = sink.acquireWriteBuffer();
+                    REQUIRE(next.sample_count() == 1);
+                    next.data[0] = 43;
+                    next.incrementSampleCount();
+                    REQUIRE(lease->data[0] == 42);
+
+                    // Publishing does
+                    fut = std::async(std::launch::async, [&sink]{ sink.publish(); });
+
+                    // Pause for 5 ms
+                    std::this_thread::sleep_for(msec(5));
+
+                    // Check to see that the sink has not stopped waiting
+                    auto status = fut.wait_for(msec(0));
+                    REQUIRE(status != std::future_status::ready);
+                }
+
+                // Give sufficient time for publish to finish
+                std::this_thread::sleep_for(msec(1));
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+
+                REQUIRE_NOTHROW(source.wait());
+                auto lease = source.lease();
+                REQUIRE(lease->data[0] == 43);
+                REQUIRE(lease->sample_count() == 2);
+            }
+
+            THEN ("publish() must follow acquireWriteBuffer()") {
+                REQUIRE_THROWS(sink.publish());
+            }
+        }
+    }
+}
+
+SCENARIO ("Shared frames are aligned and can have padded rows.",
+          "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A Sink<Frame> with padded rows and a connected Source<Frame>") {
+
+        const size_t rows = 3, cols = 5;
+        const size_t step = oat::paddedStep(cols, CV_8UC3);
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.set_depth(2);
+        sink.bind(node_addr, rows * step);
+        auto shared_frame = sink.retrieve(rows, cols, CV_8UC3, oat::PIX_BGR, step);
+        source.touch(node_addr);
+        source.connect();
+
+        THEN ("The row step is a multiple of the alignment") {
+            REQUIRE(step % oat::FRAME_ALIGNMENT == 0);
+            REQUIRE(source.parameters().step == step);
+            REQUIRE(source.parameters().bytes == rows * step);
+        }
+
+        WHEN ("The sink writes several frames") {
+
+            for (int i = 0; i < 2; i++) {
+                auto frame = sink.acquireWriteBuffer();
+
+                // Every buffer and every row is aligned
+                for (size_t r = 0; r < rows; r++) {
+                    REQUIRE(reinterpret_cast<uintptr_t>(frame.ptr(r))
+                            % oat::FRAME_ALIGNMENT == 0);
+                    frame.ptr(r)[0] = static_cast<unsigned char>(10 * i + r);
+                }
+
+                REQUIRE_NOTHROW(sink.publish());
+            }
+
+            THEN ("The source sees each frame with the same row step") {
+
+                for (int i = 0; i < 2; i++) {
+                    REQUIRE_NOTHROW(source.wait());
+                    auto lease = source.lease();
+                    REQUIRE(lease->step == step);
+                    for (size_t r = 0; r < rows; r++)
+                        REQUIRE(lease->ptr(r)[0] == 10 * i + r);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("A Source reading the latest sample never holds up its Sink.",
+          "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink and a connected latest-sample source") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        sink.bind(node_addr, 0);
+        source.touch(node_addr, oat::SourceMode::LATEST);
+        source.connect();
+
+        WHEN ("The sink writes 3 samples without the source reading") {
+
+            auto fut = std::async(std::launch::async, [&sink] {
+                for (int i = 1; i <= 3; i++) {
+                    sink.wait();
+                    *sink.retrieve() = i;
+                    sink.post();
+                }
+            });
+
+            THEN ("The sink does not block") {
+                auto status = fut.wait_for(msec(100));
+                REQUIRE(status == std::future_status::ready);
+            }
+
+            THEN ("The source reads only the newest sample") {
+                fut.wait();
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE(source.clone() == 3);
+                REQUIRE_THROWS(source.retrieve());
+                REQUIRE_NOTHROW(source.post());
+            }
+
+            THEN ("The source blocks until there is a sample it has not seen") {
+                fut.wait();
+                source.wait();
+                source.post();
+
+                auto src_fut = std::async(std::launch::async,
+                                          [&source]{ source.wait(); });
+
+                // Pause for 5 ms
+                std::this_thread::sleep_for(msec(5));
+
+                auto status = src_fut.wait_for(msec(0));
+                REQUIRE(status != std::future_status::ready);
+
+                sink.wait();
+                *sink.retrieve() = 4;
+                sink.post();
+
+                status = src_fut.wait_for(msec(100));
+                REQUIRE(status == std::future_status::ready);
+                REQUIRE(source.clone() == 4);
+            }
+        }
+    }
+
+    GIVEN ("A Sink<Frame> and a connected latest-sample Source<Frame>") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(node_addr, 16);
+        sink.retrieve(4, 4, CV_8UC1, oat::PIX_GREY);
+        source.touch(node_addr, oat::SourceMode::LATEST);
+        source.connect();
+
+        WHEN ("The sink publishes several frames") {
+
+            for (int i = 1; i <= 3; i++) {
+                auto frame = sink.acquireWriteBuffer();
+                frame.data[0] = i;
+                frame.incrementSampleCount();
+                REQUIRE_NOTHROW(sink.publish());
+            }
+
+            THEN ("The source copies the newest frame and cannot lease it") {
+                REQUIRE_NOTHROW(source.wait());
+                auto frame = source.clone();
+                REQUIRE(frame.data[0] == 3);
+                REQUIRE(frame.sample_count() == 3);
+                REQUIRE_THROWS(source.lease());
+                REQUIRE_NOTHROW(source.post());
+            }
+        }
+    }
+}
+
+SCENARIO ("A Sink<Frame> can reshape its frames while Sources are connected.",
+          "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A Sink<Frame> with room for large frames and a connected "
+           "Source<Frame>") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.set_depth(2);
+        sink.bind(node_addr, 8 * 8 * 3);
+        sink.retrieve(4, 4, CV_8UC1, oat::PIX_GREY);
+        source.touch(node_addr);
+        source.connect();
+
+        REQUIRE(source.parameters().generation == 0);
+        REQUIRE(source.capacity() >= 8 * 8 * 3);
+
+        WHEN ("The sink publishes a frame before and after reshaping") {
+
+            auto frame = sink.acquireWriteBuffer();
+            frame.data[0] = 1;
+            REQUIRE_NOTHROW(sink.publish());
+
+            frame = sink.acquireWriteBuffer();
+            frame = sink.reshape(8, 8, CV_8UC3, oat::PIX_BGR);
+            REQUIRE(frame.rows == 8);
+            REQUIRE(frame.type() == CV_8UC3);
+            frame.data[0] = 2;
+            REQUIRE_NOTHROW(sink.publish());
+
+            THEN ("The source reads each frame with the geometry it was "
+                  "written with") {
+
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE(source.retrieve()->rows == 4);
+                REQUIRE(source.retrieve()->data[0] == 1);
+                REQUIRE(source.parameters().generation == 0);
+                REQUIRE_NOTHROW(source.post());
+
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE(source.retrieve()->rows == 8);
+                REQUIRE(source.retrieve()->type() == CV_8UC3);
+                REQUIRE(source.retrieve()->data[0] == 2);
+                REQUIRE(source.parameters().generation == 1);
+                REQUIRE(source.parameters().color == oat::PIX_BGR);
+                REQUIRE_NOTHROW(source.post());
+            }
+        }
+
+        WHEN ("The sink reshapes using wait() and post()") {
+
+            sink.wait();
+            auto frame = sink.reshape(2, 3, CV_8UC1, oat::PIX_GREY);
+            frame.data[5] = 7;
+            sink.post();
+
+            THEN ("The source picks up the new geometry") {
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE(source.retrieve()->rows == 2);
+                REQUIRE(source.retrieve()->cols == 3);
+                REQUIRE(source.retrieve()->data[5] == 7);
+                REQUIRE_NOTHROW(source.post());
+            }
+        }
+
+        WHEN ("The sink reshapes beyond the capacity it was bound with") {
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS(sink.reshape(16, 16, CV_8UC3, oat::PIX_BGR));
+            }
+        }
+    }
+}